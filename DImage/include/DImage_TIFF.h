@@ -20,6 +20,18 @@ void LoadTIFF( Image &img, DUT::MemFile &readFile, const char *pFName );
 
 void SaveTIFF( const Image &img, const char *pFName );
 
+//==================================================================
+/// Camera matrices stored with a depth map (Pixar TIFF tags)
+struct TIFFDepthInfo
+{
+    float	mMtxWorldCamera[16];
+    float	mMtxWorldScreen[16];
+};
+
+void LoadTIFFDepth( Image &img, TIFFDepthInfo &out_info, DUT::MemFile &readFile, const char *pFName );
+
+void SaveTIFFDepth( const Image &img, const TIFFDepthInfo &info, const char *pFName, U32 tileDim );
+
 //==================================================================
 }
 
@@ -15,6 +15,7 @@ extern "C"
     #include "tiffiop.h"
 }
 
+#include "DSystem/include/DContainers.h"
 #include "DImage_TIFF.h"
 
 //==================================================================
@@ -273,5 +274,173 @@ void SaveTIFF( const Image &img, const char *pFName )
     TIFFClose( pTiff );
 }
 
+//==================================================================
+void LoadTIFFDepth( Image &img, TIFFDepthInfo &out_info, DUT::MemFile &readFile, const char *pFName )
+{
+    TIFF *pTiff = TIFFClientOpen(
+                            pFName,
+                            "rm",
+                            &readFile,
+                            readProc,
+                            writeProc,
+                            seekProc,
+                            closeProc,
+                            sizeProc,
+                            mapProc,
+                            unmapProc );
+
+    if NOT( pTiff )
+    {
+        DASSTHROW( 0, ("Could not open %s for read", pFName) );
+    }
+
+    U32	w = 0, h = 0;
+    TIFFGetField( pTiff, TIFFTAG_IMAGEWIDTH, &w );
+    TIFFGetField( pTiff, TIFFTAG_IMAGELENGTH, &h );
+
+    U16	bps = 0, spp = 0, sampFmt = SAMPLEFORMAT_UINT;
+    TIFFGetField( pTiff, TIFFTAG_BITSPERSAMPLE, &bps );
+    TIFFGetField( pTiff, TIFFTAG_SAMPLESPERPIXEL, &spp );
+    TIFFGetField( pTiff, TIFFTAG_SAMPLEFORMAT, &sampFmt );
+
+    if ( bps != 32 || spp != 1 || sampFmt != SAMPLEFORMAT_IEEEFP )
+    {
+        TIFFClose( pTiff );
+        DASSTHROW( 0, ("%s is not a depth map (expecting 1 float sample per pixel)", pFName) );
+    }
+
+    float	*pMtx = NULL;
+
+    if ( TIFFGetField( pTiff, TIFFTAG_PIXAR_MATRIX_WORLDTOCAMERA, &pMtx ) && pMtx )
+        memcpy( out_info.mMtxWorldCamera, pMtx, sizeof(out_info.mMtxWorldCamera) );
+    else
+    {
+        TIFFClose( pTiff );
+        DASSTHROW( 0, ("Missing world to camera matrix in %s", pFName) );
+    }
+
+    if ( TIFFGetField( pTiff, TIFFTAG_PIXAR_MATRIX_WORLDTOSCREEN, &pMtx ) && pMtx )
+        memcpy( out_info.mMtxWorldScreen, pMtx, sizeof(out_info.mMtxWorldScreen) );
+    else
+    {
+        TIFFClose( pTiff );
+        DASSTHROW( 0, ("Missing world to screen matrix in %s", pFName) );
+    }
+
+    img.Init( w, h, 1, Image::ST_F32, -1, "z" );
+
+    if ( TIFFIsTiled( pTiff ) )
+    {
+        U32	tileWd = 0, tileHe = 0;
+        TIFFGetField( pTiff, TIFFTAG_TILEWIDTH, &tileWd );
+        TIFFGetField( pTiff, TIFFTAG_TILELENGTH, &tileHe );
+
+        DVec<U8>	tileBuff( (size_t)TIFFTileSize( pTiff ) );
+
+        for (U32 ty=0; ty < h; ty += tileHe)
+        {
+            for (U32 tx=0; tx < w; tx += tileWd)
+            {
+                if ( TIFFReadTile( pTiff, &tileBuff[0], tx, ty, 0, 0 ) < 0 )
+                {
+                    TIFFClose( pTiff );
+                    DASSTHROW( 0, ("Failed reading a tile in %s", pFName) );
+                }
+
+                U32	copyWd = D::Min( tileWd, w - tx );
+                U32	copyHe = D::Min( tileHe, h - ty );
+
+                for (U32 y=0; y < copyHe; ++y)
+                {
+                    memcpy( img.GetPixelPtrRW( tx, ty + y ),
+                            &tileBuff[ y * tileWd * sizeof(float) ],
+                            copyWd * sizeof(float) );
+                }
+            }
+        }
+    }
+    else
+    {
+        for (U32 y=0; y < h; ++y)
+        {
+            if ( TIFFReadScanline( pTiff, img.GetPixelPtrRW( 0, y ), y ) < 0 )
+            {
+                TIFFClose( pTiff );
+                DASSTHROW( 0, ("Failed reading a scanline in %s", pFName) );
+            }
+        }
+    }
+
+    TIFFClose( pTiff );
+}
+
+//==================================================================
+void SaveTIFFDepth( const Image &img, const TIFFDepthInfo &info, const char *pFName, U32 tileDim )
+{
+    DASSTHROW(
+        img.mSampType == Image::ST_F32 && img.mSampPerPix == 1,
+            ("Depth maps must have a single float sample per pixel (%s)", pFName) );
+
+    TIFF *pTiff = TIFFOpen( pFName, "w" );
+
+    if NOT( pTiff )
+    {
+        DASSTHROW( 0, ("Could not open %s for write", pFName) );
+    }
+
+    TIFFSetField( pTiff, TIFFTAG_IMAGEWIDTH, img.mWd );
+    TIFFSetField( pTiff, TIFFTAG_IMAGELENGTH, img.mHe );
+    TIFFSetField( pTiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG );
+    TIFFSetField( pTiff, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT );
+    TIFFSetField( pTiff, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK );
+    TIFFSetField( pTiff, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_IEEEFP );
+    TIFFSetField( pTiff, TIFFTAG_BITSPERSAMPLE, 32 );
+    TIFFSetField( pTiff, TIFFTAG_SAMPLESPERPIXEL, 1 );
+
+    TIFFSetField( pTiff, TIFFTAG_PIXAR_MATRIX_WORLDTOCAMERA, info.mMtxWorldCamera );
+    TIFFSetField( pTiff, TIFFTAG_PIXAR_MATRIX_WORLDTOSCREEN, info.mMtxWorldScreen );
+
+    if ( tileDim )
+    {
+        // TIFF wants tiles with sizes multiple of 16
+        tileDim = (tileDim + 15) & ~15U;
+
+        TIFFSetField( pTiff, TIFFTAG_TILEWIDTH, tileDim );
+        TIFFSetField( pTiff, TIFFTAG_TILELENGTH, tileDim );
+
+        DVec<float>	tileBuff( tileDim * tileDim );
+
+        for (U32 ty=0; ty < img.mHe; ty += tileDim)
+        {
+            for (U32 tx=0; tx < img.mWd; tx += tileDim)
+            {
+                // pad the edge tiles by replicating the last texel
+                for (U32 y=0; y < tileDim; ++y)
+                {
+                    U32	sy = D::Min( ty + y, img.mHe-1 );
+
+                    for (U32 x=0; x < tileDim; ++x)
+                    {
+                        U32	sx = D::Min( tx + x, img.mWd-1 );
+
+                        tileBuff[ y * tileDim + x ] = *(const float *)img.GetPixelPtrR( sx, sy );
+                    }
+                }
+
+                TIFFWriteTile( pTiff, (tdata_t)&tileBuff[0], tx, ty, 0, 0 );
+            }
+        }
+    }
+    else
+    {
+        for (U32 i=0; i < img.mHe; ++i)
+        {
+            TIFFWriteScanline( pTiff, (tdata_t)img.GetPixelPtrR(0,i), i );
+        }
+    }
+
+    TIFFClose( pTiff );
+}
+
 //==================================================================
 }
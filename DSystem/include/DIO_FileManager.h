@@ -9,6 +9,8 @@
 #ifndef DIO_FILEMANAGER_H
 #define DIO_FILEMANAGER_H
 
+#include <sys/types.h>
+#include <sys/stat.h>
 #include "DSystem/include/DUtils_MemFile.h"
 #include "DSystem/include/DUtils_Files.h"
 
@@ -26,12 +28,19 @@ public:
     virtual void GrabFile( const char *pFileName, DVec<U8> &out_vec ) = 0;
     virtual bool FileExists( const char *pFileName ) = 0;
 
-    void GrabFile( const char *pFileName, DUT::MemFile &mf )
+    virtual void GrabFile( const char *pFileName, DUT::MemFile &mf )
     {
         DVec<U8>	vec;
         GrabFile( pFileName, vec );
         mf.InitExclusiveOwenership( vec );
     }
+
+    // size and modification time, to tell when a file has changed.
+    // False if not available
+    virtual bool GetFileStamp( const char *pFileName, U64 &out_size, U64 &out_time )
+    {
+        return false;
+    }
 };
 
 //==================================================================
@@ -46,10 +55,37 @@ public:
                 DEX_RUNTIME_ERROR( "Could not grab the file '%s'", pFileName );
         }
 
+        // mapped, rather than read, from the disk
+        void GrabFile( const char *pFileName, DUT::MemFile &mf )
+        {
+            if NOT( mf.InitMapped( pFileName ) )
+                DEX_RUNTIME_ERROR( "Could not grab the file '%s'", pFileName );
+        }
+
         bool FileExists( const char *pFileName )
         {
             return DUT::FileExists( pFileName );
         }
+
+        bool GetFileStamp( const char *pFileName, U64 &out_size, U64 &out_time )
+        {
+            struct stat	st;
+            if ( stat( pFileName, &st ) != 0 )
+                return false;
+
+            out_size	= (U64)st.st_size;
+
+            // to the nanosecond where possible, files rewritten by the
+            // same run (e.g. shadow maps) can be only a moment apart
+#if defined(__linux__)
+            out_time	= (U64)st.st_mtim.tv_sec * 1000000000 + (U64)st.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+            out_time	= (U64)st.st_mtimespec.tv_sec * 1000000000 + (U64)st.st_mtimespec.tv_nsec;
+#else
+            out_time	= (U64)st.st_mtime;
+#endif
+            return true;
+        }
 };
 
 //==================================================================
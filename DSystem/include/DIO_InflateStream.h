@@ -0,0 +1,65 @@
+//==================================================================
+/// DIO_InflateStream.h
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info.
+//==================================================================
+
+#ifndef DIO_INFLATESTREAM_H
+#define DIO_INFLATESTREAM_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "DContainers.h"
+#include "DStr.h"
+#include "DIO_Stream.h"
+
+//==================================================================
+namespace DIO
+{
+
+//==================================================================
+/// InflateStream
+/// Decompresses gzip (or zlib) data on a thread of its own, into a
+/// bounded ring buffer that Read() drains. Decompression overlaps
+/// with whatever consumes the data, and the whole inflated data is
+/// never in memory at once.
+/// The compressed source must stay valid for the life of the stream
+//==================================================================
+class InflateStream : public InputStream
+{
+    const U8				*mpSrc;
+    size_t					mSrcSize;
+
+    DVec<U8>				mRing;
+    size_t					mReadPos;	// both positions only grow, the ring
+    size_t					mWritePos;	// index is modulo the ring size
+    bool					mIsDone;
+    bool					mQuit;
+    DStr					mErrorMsg;
+
+    std::mutex				mMutex;
+    std::condition_variable	mCanReadCV;
+    std::condition_variable	mCanWriteCV;
+    std::thread				mThread;
+
+public:
+    InflateStream( const void *pSrc, size_t srcSize, size_t ringSize=4*1024*1024 );
+    ~InflateStream();
+
+    size_t Read( void *pDest, size_t maxSize );
+
+    // true for data that starts with the gzip magic number
+    static bool IsGZip( const void *pData, size_t dataSize );
+
+private:
+    void threadMain();
+    void inflateAll();
+};
+
+//==================================================================
+}
+
+#endif
@@ -0,0 +1,34 @@
+//==================================================================
+/// DIO_Stream.h
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info.
+//==================================================================
+
+#ifndef DIO_STREAM_H
+#define DIO_STREAM_H
+
+#include "DTypes.h"
+
+//==================================================================
+namespace DIO
+{
+
+//==================================================================
+/// InputStream
+/// Data that comes a piece at a time, rather than all in memory
+//==================================================================
+class InputStream
+{
+public:
+    virtual ~InputStream() {}
+
+    // blocks until some data is available, 0 at the end of the stream
+    virtual size_t Read( void *pDest, size_t maxSize ) = 0;
+};
+
+//==================================================================
+}
+
+#endif
@@ -14,6 +14,9 @@
 #include <future>
 #include <thread>
 #include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 
 //==================================================================
 namespace DTH
@@ -45,6 +48,48 @@ public:
     }
 };
 
+//==================================================================
+/// TaskQueue
+///
+/// Tasks are queued and return immediately, to be run in the
+/// background by up to maxN threads (created as needed).
+/// Wait() returns when all the tasks queued so far are done.
+/// Tasks shouldn't throw, use AddJob() for a future of the result.
+//==================================================================
+class TaskQueue
+{
+    std::mutex							mMutex;
+    std::condition_variable				mWorkCV;
+    std::condition_variable				mIdleCV;
+    std::deque<std::function<void ()>>	mTasks;
+    DVec<std::thread>					mThreads;
+    size_t								mBusyN;
+    bool								mQuit;
+
+    const size_t  mMaxN;
+
+public:
+    TaskQueue( size_t maxN=std::thread::hardware_concurrency() );
+    ~TaskQueue();
+
+    void AddTask( const std::function<void ()> &fn );
+
+    template <typename _T>
+    std::future<_T> AddJob( const std::function<_T ()> &fn )
+    {
+        auto oTask = std::make_shared<std::packaged_task<_T ()>>( fn );
+
+        AddTask( [oTask]() { (*oTask)(); } );
+
+        return oTask->get_future();
+    }
+
+    void Wait();
+
+private:
+    void threadMain();
+};
+
 #if !defined(_MSC_VER)
 
 //==================================================================
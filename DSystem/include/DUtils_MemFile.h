@@ -400,6 +400,8 @@ class MemFile
     size_t		mDataSize;
     size_t		mReadPos;
     bool		mIsReadOnly;
+    void		*mpMapped;		// set when the data is a mapped file
+    void		*mpMapHandle;
 
 public:
     MemFile();
@@ -408,9 +410,14 @@ public:
     MemFile( MemWriterDynamic &mw );
     ~MemFile();
 
+    // owns the data or the file mapping
+    MemFile( const MemFile &from ) = delete;
+    MemFile &operator=( const MemFile &from ) = delete;
+
     void Init( const void *pDataSrc, size_t dataSize );
     void Init( const char *pFileName, bool prefs = false );
     bool InitNoThrow( const char *pFileName, bool prefs = false );
+    bool InitMapped( const char *pFileName );
     void InitExclusiveOwenership( DVec<U8> &fromData );
     void InitExclusiveOwenership( MemWriterDynamic &mw );
 
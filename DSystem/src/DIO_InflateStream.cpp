@@ -0,0 +1,215 @@
+//==================================================================
+/// DIO_InflateStream.cpp
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info.
+//==================================================================
+
+#if defined(D_HAS_ZLIB)
+#include <zlib.h>
+#endif
+
+#include "DUtils.h"
+#include "DExceptions.h"
+#include "DIO_InflateStream.h"
+
+//==================================================================
+namespace DIO
+{
+
+//==================================================================
+InflateStream::InflateStream( const void *pSrc, size_t srcSize, size_t ringSize ) :
+    mpSrc((const U8 *)pSrc),
+    mSrcSize(srcSize),
+    mReadPos(0),
+    mWritePos(0),
+    mIsDone(false),
+    mQuit(false)
+{
+    mRing.resize( DMAX( ringSize, (size_t)4096 ) );
+
+    mThread = std::thread( [this]() { threadMain(); } );
+}
+
+//==================================================================
+InflateStream::~InflateStream()
+{
+    {
+        std::lock_guard<std::mutex>	lock( mMutex );
+        mQuit = true;
+    }
+    mCanWriteCV.notify_all();
+
+    mThread.join();
+}
+
+//==================================================================
+bool InflateStream::IsGZip( const void *pData, size_t dataSize )
+{
+    const U8	*p = (const U8 *)pData;
+
+    return dataSize >= 2 && p[0] == 0x1f && p[1] == 0x8b;
+}
+
+//==================================================================
+size_t InflateStream::Read( void *pDest, size_t maxSize )
+{
+    size_t	readPos;
+    size_t	availSize;
+    {
+        std::unique_lock<std::mutex>	lock( mMutex );
+
+        mCanReadCV.wait( lock, [this]() { return mIsDone || mWritePos > mReadPos; } );
+
+        readPos		= mReadPos;
+        availSize	= mWritePos - mReadPos;
+
+        if NOT( availSize )
+        {
+            if ( mErrorMsg.size() )
+                DEX_RUNTIME_ERROR( "%s", mErrorMsg.c_str() );
+
+            return 0;
+        }
+    }
+
+    // the filled part of the ring is only touched by the reader,
+    // so the copy happens without the lock
+    size_t	ringSize = mRing.size();
+    size_t	n = DMIN( availSize, maxSize );
+    size_t	idx = readPos % ringSize;
+    size_t	n1 = DMIN( n, ringSize - idx );
+
+    memcpy( pDest, &mRing[idx], n1 );
+
+    if ( n > n1 )
+        memcpy( (U8 *)pDest + n1, &mRing[0], n - n1 );
+
+    {
+        std::lock_guard<std::mutex>	lock( mMutex );
+        mReadPos += n;
+    }
+    mCanWriteCV.notify_one();
+
+    return n;
+}
+
+//==================================================================
+void InflateStream::threadMain()
+{
+    DStr	errMsg;
+
+    try {
+        inflateAll();
+    }
+    catch ( std::exception &e )
+    {
+        errMsg = e.what();
+    }
+
+    {
+        std::lock_guard<std::mutex>	lock( mMutex );
+        if ( errMsg.size() )
+            mErrorMsg = errMsg;
+
+        mIsDone = true;
+    }
+    mCanReadCV.notify_all();
+}
+
+//==================================================================
+void InflateStream::inflateAll()
+{
+#if defined(D_HAS_ZLIB)
+    z_stream	zs;
+    memset( &zs, 0, sizeof(zs) );
+
+    // 15 + 32 for the largest window and for either header, gzip or zlib
+    if ( inflateInit2( &zs, 15 + 32 ) != Z_OK )
+        DEX_RUNTIME_ERROR( "Could not initialize zlib" );
+
+    const U8	*pIn = mpSrc;
+    size_t		inLeft = mSrcSize;
+    size_t		ringSize = mRing.size();
+    DStr		errMsg;
+
+    while ( true )
+    {
+        // wait for free space in the ring
+        size_t	writePos;
+        size_t	freeSize;
+        {
+            std::unique_lock<std::mutex>	lock( mMutex );
+
+            mCanWriteCV.wait( lock, [&]() { return mQuit || (mWritePos - mReadPos) < ringSize; } );
+
+            if ( mQuit )
+                break;
+
+            writePos = mWritePos;
+            freeSize = ringSize - (mWritePos - mReadPos);
+        }
+
+        // feed the input a piece at a time, avail_in is only 32 bit
+        if ( zs.avail_in == 0 && inLeft )
+        {
+            size_t	n = DMIN( inLeft, (size_t)1 << 30 );
+            zs.next_in	= (Bytef *)pIn;
+            zs.avail_in	= (uInt)n;
+            pIn		+= n;
+            inLeft	-= n;
+        }
+
+        size_t	idx = writePos % ringSize;
+        size_t	spanSize = DMIN( freeSize, ringSize - idx );
+
+        zs.next_out		= &mRing[idx];
+        zs.avail_out	= (uInt)spanSize;
+
+        int	ret = inflate( &zs, Z_NO_FLUSH );
+
+        size_t	produced = spanSize - zs.avail_out;
+        if ( produced )
+        {
+            {
+                std::lock_guard<std::mutex>	lock( mMutex );
+                mWritePos += produced;
+            }
+            mCanReadCV.notify_one();
+        }
+
+        if ( ret == Z_STREAM_END )
+        {
+            // gzip files may be made of more members, one after the other
+            if ( zs.avail_in == 0 && inLeft )
+                continue;
+
+            if NOT( zs.avail_in >= 2 && IsGZip( zs.next_in, zs.avail_in ) )
+                break;
+
+            inflateReset( &zs );
+        }
+        else
+        if ( ret != Z_OK )
+        {
+            // more input to come
+            if ( ret == Z_BUF_ERROR && zs.avail_in == 0 && inLeft )
+                continue;
+
+            errMsg = DUT::SSPrintFS( "Bad compressed data (%s)", zs.msg ? zs.msg : "truncated" );
+            break;
+        }
+    }
+
+    inflateEnd( &zs );
+
+    if ( errMsg.size() )
+        DEX_RUNTIME_ERROR( "%s", errMsg.c_str() );
+#else
+    DEX_RUNTIME_ERROR( "Compressed data is not supported in this build" );
+#endif
+}
+
+//==================================================================
+}
@@ -25,12 +25,13 @@ errno_t fopen_s( FILE **out_ppFile, const char *pFName, const char *pMode )
 //==================================================================
 void strtime( char *pDest, size_t maxLen )
 {
-    //struct tm	tmm;
     time_t		t;
+    char		buff[64];
 
     t = time( NULL );
 
-    strcpy_s( pDest, ctime( &t ) );
+    // reentrant version, compilers may run concurrently
+    strcpy_s( pDest, ctime_r( &t, buff ) );
 }
 
 //==================================================================
@@ -109,13 +110,19 @@ int sprintf_s( char *str, size_t destMaxSize, const char *format, ...)
 void numstrdate( char *pDest, size_t maxLen )
 {
     time_t 		t;
-    struct tm	*tm;
+    struct tm	tmm;
 
     t 	= time( NULL );
-    tm	= localtime( &t );
+
+    // reentrant versions, compilers may run concurrently
+#if defined(_MSC_VER)
+    localtime_s( &tmm, &t );
+#else
+    localtime_r( &t, &tmm );
+#endif
 
     sprintf( pDest, "%i/%02i/%02i",
-        tm->tm_year+1900,
-        tm->tm_mon+1,
-        tm->tm_mday );
+        tmm.tm_year+1900,
+        tmm.tm_mon+1,
+        tmm.tm_mday );
 }
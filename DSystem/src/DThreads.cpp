@@ -17,6 +17,81 @@
 namespace DTH
 {
 
+//==================================================================
+/// TaskQueue
+//==================================================================
+TaskQueue::TaskQueue( size_t maxN ) :
+    mBusyN(0),
+    mQuit(false),
+    mMaxN(maxN ? maxN : 1)
+{
+}
+
+//==================================================================
+TaskQueue::~TaskQueue()
+{
+    Wait();
+
+    {
+        std::lock_guard<std::mutex>	lock( mMutex );
+        mQuit = true;
+    }
+    mWorkCV.notify_all();
+
+    for (size_t i=0; i < mThreads.size(); ++i)
+        mThreads[i].join();
+}
+
+//==================================================================
+void TaskQueue::AddTask( const std::function<void ()> &fn )
+{
+    std::lock_guard<std::mutex>	lock( mMutex );
+
+    mTasks.push_back( fn );
+
+    // start a new thread only if all the current ones are taken
+    if ( (mBusyN + mTasks.size()) > mThreads.size() && mThreads.size() < mMaxN )
+        mThreads.push_back( std::thread( [this]() { threadMain(); } ) );
+
+    mWorkCV.notify_one();
+}
+
+//==================================================================
+void TaskQueue::Wait()
+{
+    std::unique_lock<std::mutex>	lock( mMutex );
+
+    mIdleCV.wait( lock, [this]() { return mTasks.empty() && mBusyN == 0; } );
+}
+
+//==================================================================
+void TaskQueue::threadMain()
+{
+    std::unique_lock<std::mutex>	lock( mMutex );
+
+    while ( true )
+    {
+        mWorkCV.wait( lock, [this]() { return mQuit || !mTasks.empty(); } );
+
+        if ( mTasks.empty() )
+            return;
+
+        std::function<void ()>	fn = std::move( mTasks.front() );
+        mTasks.pop_front();
+
+        mBusyN += 1;
+        lock.unlock();
+
+        fn();
+
+        lock.lock();
+        mBusyN -= 1;
+
+        if ( mTasks.empty() && mBusyN == 0 )
+            mIdleCV.notify_all();
+    }
+}
+
 #if !defined(_MSC_VER)
 
 //==================================================================
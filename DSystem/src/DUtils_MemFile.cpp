@@ -6,6 +6,15 @@
 /// copyright info.
 //==================================================================
 
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "DUtils_Files.h"
 #include "DUtils_MemFile.h"
 #include "DExceptions.h"
@@ -21,7 +30,9 @@ MemFile::MemFile() :
     mpData(NULL),
     mDataSize(0),
     mReadPos(0),
-    mIsReadOnly(true)
+    mIsReadOnly(true),
+    mpMapped(NULL),
+    mpMapHandle(NULL)
 {
 }
 
@@ -30,7 +41,9 @@ MemFile::MemFile( const void *pDataSrc, size_t dataSize ) :
     mpData((const U8 *)pDataSrc),
     mDataSize(dataSize),
     mReadPos(0),
-    mIsReadOnly(true)
+    mIsReadOnly(true),
+    mpMapped(NULL),
+    mpMapHandle(NULL)
 {
 }
 
@@ -39,13 +52,17 @@ MemFile::MemFile( const char *pFileName, bool prefs ) :
     mpData(NULL),
     mDataSize(0),
     mReadPos(0),
-    mIsReadOnly(true)
+    mIsReadOnly(true),
+    mpMapped(NULL),
+    mpMapHandle(NULL)
 {
     Init( pFileName, prefs );
 }
 
 //==================================================================
-MemFile::MemFile( MemWriterDynamic &mw )
+MemFile::MemFile( MemWriterDynamic &mw ) :
+    mpMapped(NULL),
+    mpMapHandle(NULL)
 {
     InitExclusiveOwenership( mw );
 }
@@ -53,6 +70,15 @@ MemFile::MemFile( MemWriterDynamic &mw )
 //==================================================================
 MemFile::~MemFile()
 {
+    if NOT( mpMapped )
+        return;
+
+#if defined(WIN32)
+    UnmapViewOfFile( mpMapped );
+    CloseHandle( (HANDLE)mpMapHandle );
+#else
+    munmap( mpMapped, mDataSize );
+#endif
 }
 
 //==================================================================
@@ -97,6 +123,95 @@ bool MemFile::InitNoThrow( const char *pFileName, bool prefs )
     return true;
 }
 
+//==================================================================
+/// Map the file in memory rather than reading it, the pages are only
+/// loaded as the data is accessed. Returns false if the file can't be
+/// opened
+bool MemFile::InitMapped( const char *pFileName )
+{
+    DASSERT( mpData == NULL && mDataSize == 0 && mReadPos == 0 );
+
+#if defined(WIN32)
+    HANDLE	hFile = CreateFileA(
+                        pFileName,
+                        GENERIC_READ,
+                        FILE_SHARE_READ,
+                        NULL,
+                        OPEN_EXISTING,
+                        FILE_FLAG_SEQUENTIAL_SCAN,
+                        NULL );
+
+    if ( hFile == INVALID_HANDLE_VALUE )
+        return false;
+
+    LARGE_INTEGER	fileSize;
+    if NOT( GetFileSizeEx( hFile, &fileSize ) )
+    {
+        CloseHandle( hFile );
+        return false;
+    }
+
+    // empty files can't be mapped
+    if ( fileSize.QuadPart == 0 )
+    {
+        CloseHandle( hFile );
+        return true;
+    }
+
+    HANDLE	hMap = CreateFileMappingA( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+    CloseHandle( hFile );
+
+    if NOT( hMap )
+        return false;
+
+    void	*pMapped = MapViewOfFile( hMap, FILE_MAP_READ, 0, 0, 0 );
+    if NOT( pMapped )
+    {
+        CloseHandle( hMap );
+        return false;
+    }
+
+    mpMapHandle	= (void *)hMap;
+    mDataSize	= (size_t)fileSize.QuadPart;
+
+#else
+    int	fd = open( pFileName, O_RDONLY );
+    if ( fd == -1 )
+        return false;
+
+    struct stat	st;
+    if ( fstat( fd, &st ) != 0 )
+    {
+        close( fd );
+        return false;
+    }
+
+    // empty files can't be mapped
+    if ( st.st_size == 0 )
+    {
+        close( fd );
+        return true;
+    }
+
+    void	*pMapped = mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+
+    if ( pMapped == MAP_FAILED )
+        return false;
+
+    madvise( pMapped, (size_t)st.st_size, MADV_SEQUENTIAL );
+
+    mDataSize	= (size_t)st.st_size;
+#endif
+
+    mpMapped	= pMapped;
+    mpData		= (const U8 *)pMapped;
+    mReadPos	= 0;
+    mIsReadOnly	= true;
+
+    return true;
+}
+
 //==================================================================
 void MemFile::InitExclusiveOwenership( DVec<U8> &fromData )
 {
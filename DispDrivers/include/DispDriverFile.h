@@ -18,6 +18,7 @@ class DispDriverFile
 {
 public:
     DispDriverFile( const char *pFileName, const DIMG::Image &srcImg );	
+
     ~DispDriverFile();
 };
 
@@ -23,6 +23,8 @@ namespace RI
 //==================================================================
 class State;
 class Texture;
+class ShadowMap;
+class EnvMap;
 
 //==================================================================
 /// Attributes
@@ -43,17 +45,23 @@ public:
     //==================================================================
     Bound				mBound;				// DoBound()
     Bound				mDetail;			// Detail()
+    float				mDetailSize;		// raster area of mDetail, < 0 if unknown
                 
     float				mMinVisible;		// DetailRange()
     float				mLowerTransition;	//
     float				mUpperTransition;	//
     float				mMaxVisible;		//
+
+    // range of the samples dissolve value where this level of detail
+    // is visible. [0, 1) when fully visible, empty when not visible
+    float				mLODDissolve[2];
                     
     const Symbol		*mpTypeApproximation;	// GeometricApproximation()
     float				mValueApproximation;
 
     bool				mOrientationFlipped;// Orientation()
     int					mSides;				// Sides()
+    float				mShadingRate;		// ShadingRate()
 
     const Symbol		*mpUBasis;			// Basis()
     const Symbol		*mpVBasis;
@@ -93,12 +101,19 @@ public:
     // get a light source given the index in the active lights list
     const LightSourceT *GetLight( size_t actLightIdx ) const;
 
+    // same primitives, when simplified with these attributes
+    bool IsSameShaping( const Attributes &other ) const;
+
+    bool IsLODVisible() const		{ return mLODDissolve[0] < mLODDissolve[1];	}
+    bool IsLODDissolving() const	{ return mLODDissolve[0] > 0 || mLODDissolve[1] < 1; }
+
 private:
     void copyFrom(const Attributes& rhs);
+    void updateLOD();
 
 public:
     void cmdBound( const Bound &bound );
-    void cmdDetail( const Bound &detail );
+    void cmdDetail( const Bound &detail, float detailSize );
     void cmdDetailRange(float	minVisible,
                         float	lowerTransition,
                         float	upperTransition,
@@ -108,6 +123,7 @@ public:
     
     void cmdOrientation( RtToken orientation );
     void cmdSides( int sides );
+    void cmdShadingRate( float size );
     void cmdBasis(RtToken ubasis, const float *pCustomUBasis, int ustep,
                   RtToken vbasis, const float *pCustomVBasis, int vstep );
                   
@@ -121,6 +137,8 @@ public:
     void cmdDisplacement( ParamList &params );
 
     Texture *GetTexture( const char *pTextureName ) const;
+    ShadowMap *GetShadowMap( const char *pMapName ) const;
+    EnvMap *GetEnvMap( const char *pMapName ) const;
 
 private:
     void getShaderParams( ParamList &params, size_t fromIdx, SVM::ShaderInst &shaderInst, const Matrix44 &mtxLocalCam );
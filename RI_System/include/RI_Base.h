@@ -41,6 +41,7 @@ enum Mode
     MD_SOLID,
     MD_OBJECT,
     MD_MOTION,
+    MD_PROCEDURAL,
 };
 
 //==================================================================
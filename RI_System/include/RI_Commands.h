@@ -0,0 +1,110 @@
+//==================================================================
+/// RI_Commands.h
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info.
+//==================================================================
+
+#ifndef RI_COMMANDS_H
+#define RI_COMMANDS_H
+
+#include "DSystem/include/DTypes.h"
+
+//==================================================================
+/// All the RIB commands known to the translator. The names are
+/// exactly as they appear in the RIB files
+//==================================================================
+#define RI_COMMANDS_LIST				\
+    RI_CMD( version )					\
+    RI_CMD( Begin )						\
+    RI_CMD( End )						\
+    RI_CMD( FrameBegin )				\
+    RI_CMD( FrameEnd )					\
+    RI_CMD( WorldBegin )				\
+    RI_CMD( WorldEnd )					\
+    RI_CMD( AttributeBegin )			\
+    RI_CMD( AttributeEnd )				\
+    RI_CMD( Attribute )					\
+    RI_CMD( TransformBegin )			\
+    RI_CMD( TransformEnd )				\
+    RI_CMD( SolidBegin )				\
+    RI_CMD( SolidEnd )					\
+    RI_CMD( ObjectBegin )				\
+    RI_CMD( ObjectEnd )					\
+    RI_CMD( ObjectInstance )			\
+    RI_CMD( MotionBegin )				\
+    RI_CMD( MotionEnd )					\
+    RI_CMD( Bound )						\
+    RI_CMD( Detail )					\
+    RI_CMD( DetailRange )				\
+    RI_CMD( GeometricApproximation )	\
+    RI_CMD( Orientation )				\
+    RI_CMD( Sides )						\
+    RI_CMD( ShadingRate )				\
+    RI_CMD( Basis )						\
+    RI_CMD( AreaLightSource )			\
+    RI_CMD( LightSource )				\
+    RI_CMD( Declare )					\
+    RI_CMD( Surface )					\
+    RI_CMD( Displacement )				\
+    RI_CMD( ReadArchive )				\
+    RI_CMD( Procedural )				\
+    RI_CMD( Cone )						\
+    RI_CMD( Cylinder )					\
+    RI_CMD( Sphere )					\
+    RI_CMD( Hyperboloid )				\
+    RI_CMD( Paraboloid )				\
+    RI_CMD( Torus )						\
+    RI_CMD( Patch )						\
+    RI_CMD( PatchMesh )					\
+    RI_CMD( NuPatch )					\
+    RI_CMD( Polygon )					\
+    RI_CMD( PointsPolygons )			\
+    RI_CMD( PointsGeneralPolygons )		\
+    RI_CMD( Identity )					\
+    RI_CMD( ConcatTransform )			\
+    RI_CMD( Transform )					\
+    RI_CMD( Scale )						\
+    RI_CMD( Rotate )					\
+    RI_CMD( Translate )					\
+    RI_CMD( Option )					\
+    RI_CMD( Format )					\
+    RI_CMD( FrameAspectRatio )			\
+    RI_CMD( ScreenWindow )				\
+    RI_CMD( CropWindow )				\
+    RI_CMD( Projection )				\
+    RI_CMD( Clipping )					\
+    RI_CMD( DepthOfField )				\
+    RI_CMD( Shutter )					\
+    RI_CMD( Color )						\
+    RI_CMD( Opacity )					\
+    RI_CMD( Display )					\
+    RI_CMD( PixelSamples )
+
+//==================================================================
+namespace RI
+{
+
+//==================================================================
+enum CmdID
+{
+#define RI_CMD(_NAME_)	CMDID_##_NAME_,
+    RI_COMMANDS_LIST
+#undef RI_CMD
+
+    CMDID_N,
+    CMDID_UNKNOWN = CMDID_N
+};
+
+//==================================================================
+/// Command from its name, through a perfect hash built by the
+/// compiler. CMDID_UNKNOWN if not found
+CmdID FindCommand( const char *pName, size_t nameLen );
+
+const char *GetCommandName( CmdID cmdID );
+
+//==================================================================
+}
+
+#endif
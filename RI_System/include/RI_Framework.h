@@ -9,6 +9,9 @@
 #ifndef RI_FRAMEWORK_H
 #define RI_FRAMEWORK_H
 
+#include <mutex>
+#include <exception>
+#include "DSystem/include/DThreads.h"
 #include "RI_Base.h"
 #include "RI_Options.h"
 #include "RI_HiderST.h"
@@ -19,6 +22,10 @@ namespace RI
 
 class Attributes;
 class Transform;
+class ObjectDef;
+class ObjectInstance;
+class ComplexPrimitiveBase;
+class DelayedArchive;
 
 //==================================================================
 class RenderBucketsBase
@@ -34,6 +41,22 @@ private:
 */
 };
 
+//==================================================================
+/// Reads a delayed archive into the state, starting from the given
+/// attributes and transformation. Called while rendering, from the
+/// bucket that first sees the archive, one archive at a time
+//==================================================================
+class DelayedArchiveLoaderBase
+{
+public:
+    virtual ~DelayedArchiveLoaderBase() {}
+
+    virtual void LoadDelayedArchive(
+                        const char			*pPathFName,
+                        const Attributes	&attr,
+                        const Transform		&xform ) = 0;
+};
+
 //==================================================================
 /// Framework
 //==================================================================
@@ -77,6 +100,23 @@ private:
     RevisionChecker		mAttrsRev;
     RevisionChecker		mTransRev;
 
+    DVec<ObjectInstance*>	mpInstances;	// set aside at WorldEnd, before splitting
+    DVec<DelayedArchive*>	mpDelayed;		// set aside at WorldEnd, placed in the buckets
+
+    DelayedArchiveLoaderBase	*mpDelayedLoader;
+    bool						mHasDelayed;	// some bucket has a delayed archive
+
+    // buckets share primitives (references aren't thread-safe) and
+    // take the ones from the archives expanded while rendering
+    std::mutex					mBucketsMutex;
+
+    // primitives are split in the background while the world block is
+    // still being read. One thread, so they get to the buckets in order
+    DTH::TaskQueue				mSplitTasks;
+    DVec<PrimitiveBase*>		mpSplitBatch;	// collected by Insert(), next to go
+    bool						mIsSplitting;	// from WorldBegin to WorldEnd
+    std::exception_ptr			mpSplitError;
+
 public:
     Framework( const Params &params );
 
@@ -87,6 +127,11 @@ public:
         mHider.mpGlobalSyms = pGlobalSyms;
     }
 
+    void SetDelayedArchiveLoader( DelayedArchiveLoaderBase *pLoader )
+    {
+        mpDelayedLoader = pLoader;
+    }
+
     void WorldBegin(
                 const Options &opt,
                 const Matrix44 &mtxWorldCamera );
@@ -95,6 +140,12 @@ public:
                     const Attributes	&attr,
                     const Transform		&xform );
 
+    // before changing anything that splitting reads, like the global symbols
+    void WaitSplitting()
+    {
+        mSplitTasks.Wait();
+    }
+
 #if defined(DEBUG) || defined(_DEBUG)
     void Dbg_MarkLastPrim( const char *pSrcFileName, int srcLine );
 #endif
@@ -104,9 +155,35 @@ public:
     static void RenderBucket_s( Hider &hider, HiderBucket &bucket );
 
 private:
-    void	worldEnd_simplify();
+    static void	renderPrims_s(
+                    Hider						&hider,
+                    HiderBucket					&bucket,
+                    DVec<SimplePrimitiveBase *>	&pPrimList,
+                    WorkGrid					&workGrid,
+                    DVec<HiderPixel>			&pixels );
+
+    void	sendSplitBatch( bool isLast );
+    void	splitBatch( const DVec<PrimitiveBase*> &pBatch );
+
+    void	worldEnd_finishSplitting();
+    void	worldEnd_splitInstances();
     void	worldEnd_splitAndAddToBuckets();
     void	worldEnd_setupDisplays();
+
+    void	simplifyPrims();
+    void	splitInstances();
+    void	splitAndAddToBuckets();
+    void	placeDelayed();
+
+    void	expandVisibleDelayed( HiderBucket &bucket, float opaqueDepth );
+    void	expandDelayed( DelayedArchive *pDelayed );
+
+    void	simplifyPrim( ComplexPrimitiveBase *pPrim );
+    void	simplifyObjectDef( ObjectDef &objDef );
+
+    void	splitToLeaves(
+                    DVec<SimplePrimitiveBase *>	&pWorkPrims,
+                    DVec<SimplePrimitiveBase *>	&out_pLeaves );
 };
 
 //==================================================================
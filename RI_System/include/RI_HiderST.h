@@ -21,6 +21,7 @@ namespace RI
 class Attributes;
 class Transform;
 class PrimitiveBase;
+class Framework;
 
 //==================================================================
 /// Hider
@@ -35,6 +36,17 @@ private:
     Matrix44			mMtxWorldProj;
     float				mHalfXRes;
     float				mHalfYRes;
+    bool				mDepthOnly;
+    bool				mIsPerspective;
+
+    // pixels to render, from the CropWindow (x1, y1, x2, y2 exclusive)
+    int					mCrop[4];
+
+    // depth of field: the circle of confusion in pixels is
+    // mCoCScale * (1/mFocalDistance - 1/depth)
+    bool				mHasDOF;
+    float				mFocalDistance;
+    Float2				mCoCScale;
 
 public:
     //==================================================================
@@ -65,6 +77,8 @@ private:
     HiderSampleCoordsBuffer	mSampCoordBuffs[4];
     Params					mParams;
     DVec<PrimitiveBase *>	mpPrims;
+    Framework				*mpFramework;
+    bool					mIsRendering;	// buckets being rendered take late primitives
 
 public:
     Hider( const Params &params );
@@ -89,13 +103,34 @@ public:
     void InsertForDicing( SimplePrimitiveBase *pPrim, const int bound2d[4] );
 
     void WorldEnd();
+
+    bool IsInCrop( const int bound2d[4] ) const
+    {
+        return
+            bound2d[0] < mCrop[2] && bound2d[2] >= mCrop[0] &&
+            bound2d[1] < mCrop[3] && bound2d[3] >= mCrop[1];
+    }
     
     float RasterEstimate( const Bound &b, const Matrix44 &mtxLocalWorld, int out_box2D[4]  ) const;
+    float RasterDetail( const Bound &b, const Matrix44 &mtxLocalWorld ) const;
+    bool IsAcrossEyePlane( const Bound &b, const Matrix44 &mtxLocalWorld ) const;
+    float CameraNearDepth( const Bound &b, const Matrix44 &mtxLocalWorld ) const;
     Float_ RasterLengthSqr( const Float3_ &ptA, const Float3_ &ptB, const Matrix44 &mtxLocalWorld ) const;
 
+    bool RasterProject(
+                const Float3 *pPoints,
+                size_t ptsN,
+                const Matrix44 &mtxLocalWorld,
+                Float2 *out_pWinPoints ) const;
+
+    bool CullGrid(	const HiderBucket	&bucket,
+                    WorkGrid			&workGrid,
+                    const Attributes	&attribs ) const;
+
     void Bust(	const HiderBucket	&bucket,
                 ShadedGrid			&shadGrid,
                 const WorkGrid		&workGrid,
+                const Attributes	&attribs,
                 DVec<HiderPixel>	&pixels,
                 u_int				screenWd,
                 u_int				screenHe ) const;
@@ -104,6 +139,10 @@ public:
                     DVec<HiderPixel>	&pixels,
                     HiderBucket			&buck );
 
+    float GetOpaqueDepth(
+                    const DVec<HiderPixel>	&pixels,
+                    const HiderBucket		&buck ) const;
+
     u_int		GetOutputDataStride() const	{ return mFinalBuff.GetWd() * NOUTCOLS;	}
     u_int		GetOutputDataWd() const		{ return mFinalBuff.GetWd();			}
     u_int		GetOutputDataHe() const		{ return mFinalBuff.GetHe();			}
@@ -120,6 +159,9 @@ public:
 
     const DVec<HiderBucket *>	&GetBuckets() {	return mpBuckets; }
 
+    // only rendering depth maps, no shading
+    bool		IsDepthOnly() const			{ return mDepthOnly;	}
+
     size_t	GetOutputBucketMemSize( size_t buckIdx ) const;
     void	CopyOutputBucket( size_t buckIdx, float *pDest, size_t destMaxSize ) const;
 
@@ -133,6 +175,8 @@ private:
 
     HiderSampleCoordsBuffer *findOrAddSampCoordBuff( u_int wd, u_int he, u_int subPixelDimLog2 );
 
+    void	setupDOF( const Options &opt );
+
     //void pointsTo2D( Point2 *pDes, const Point3 *pSrc, u_int n );
 };
 
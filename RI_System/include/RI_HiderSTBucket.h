@@ -33,21 +33,43 @@ public:
     DVec<SimplePrimitiveBase *>	mpPrims;
     HiderSampleCoordsBuffer		*mpSampCoordsBuff;
 
+    // delayed archives touching the bucket, and the primitives that
+    // come from those expanded while rendering
+    DVec<ComplexPrimitiveBase *>	mpDelayed;
+    DVec<SimplePrimitiveBase *>	mpLatePrims;
+    bool						mIsDone;	// rendered, takes no more primitives
+
 public:
     HiderBucket( int x1, int y1, int x2, int y2, HiderSampleCoordsBuffer *pSampCoordsBuff ) :
         mX1(x1),
         mY1(y1),
         mX2(x2),
         mY2(y2),
-        mpSampCoordsBuff(pSampCoordsBuff)
+        mpSampCoordsBuff(pSampCoordsBuff),
+        mIsDone(false)
     {
     }
 
     ~HiderBucket()
+    {
+        ReleasePrims();
+    }
+
+    void ReleasePrims()
     {
         for (size_t i=0; i < mpPrims.size(); ++i)
             if ( mpPrims[i] )
                 mpPrims[i]->Release();
+
+        for (size_t i=0; i < mpDelayed.size(); ++i)
+            mpDelayed[i]->Release();
+
+        for (size_t i=0; i < mpLatePrims.size(); ++i)
+            mpLatePrims[i]->Release();
+
+        mpPrims.clear();
+        mpDelayed.clear();
+        mpLatePrims.clear();
     }
 
 /*
@@ -36,6 +36,7 @@ public:
     float		mTime;
     float		mLensX;
     float		mLensY;
+    float		mDissolve;	// for level of detail transitions
 };
 
 //==================================================================
@@ -89,7 +90,10 @@ private:
                 HiderSampleCoords		*pSampCoods,
                 HiderBaseSampleCoords	*pBaseSampleCoords,
                 u_int					subPixelDimLog2,
-                DUT::RandMT				&randGen );
+                DUT::RandMT				&randGen,
+                DUT::RandMT				&randTimeGen,
+                DUT::RandMT				&randLensGen,
+                DUT::RandMT				&randDissolveGen );
 
     void setupPixel(
                 HiderSampleCoords		*pSampCoods,
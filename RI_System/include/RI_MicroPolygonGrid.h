@@ -38,6 +38,14 @@ public:
     u_int			mYDim;
     u_int			mPointsN;
     Float3_			*mpPointsCS;
+    Float3_			*mpMotionCS;	// shutter close minus shutter open positions
+    bool			mIsMoving;
+    U8				*mpMPCulled;	// per micro-polygon, set by Hider::CullGrid()
+    U8				*mpMPHoles;		// per micro-polygon, not part of the surface
+    bool			mHasHoles;		// set by the primitive when dicing, if mpMPHoles is used
+    u_int			mXSegs;			// micro-polygons along x and y, the columns past
+    u_int			mYSegs;			// ..mXSegs are holes if the width was padded
+    u_int			mEdgeSegs[4];	// set when dicing for stitching, see Stitch()
     float			mURange[2];
     float			mVRange[2];
     SymbolIList		mSymbolIs;
@@ -47,6 +55,7 @@ public:
     Matrix44		mMtxLocalCamera;
     Matrix44		mMtxLocalCameraNorm;
     Matrix44		mMtxCameraLocal;
+    Matrix44		mMtxLocalCameraClose;
 
     WorkGrid( const SymbolList &globalSymbols );
     ~WorkGrid();
@@ -61,6 +70,7 @@ public:
     u_int GetPointsN() const { return mPointsN; }
     
     void Displace( const Attributes &attribs );
+    void Stitch();
     void Shade( const Attributes &attribs );
 
 private:
@@ -80,13 +90,15 @@ public:
     Float3_			*mpPointsCS;
     Float3_			*mpPointsCloseCS;
     Float2_			*mpPosWin;
+    Float2_			*mpPosWinClose;
     SlColor			*mpCi;
     SlColor			*mpOi;
+    bool			mIsMoving;
 
     ShadedGrid();
     ~ShadedGrid();
 
-    void Init( u_int pointsN );
+    void Init( u_int pointsN, bool isMoving );
 };
 
 //==================================================================
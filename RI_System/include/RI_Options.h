@@ -9,6 +9,7 @@
 #ifndef RI_OPTIONS_H
 #define RI_OPTIONS_H
 
+#include <memory>
 #include "RI_Base.h"
 #include "RI_Param.h"
 #include "DMath/include/DMath.h"
@@ -39,6 +40,9 @@ public:
         int				mValOne;
         int				mValMin;
         int				mValMax;
+        // for depth maps (zfile)
+        Matrix44		mMtxWorldCamera;
+        Matrix44		mMtxWorldProj;
 
         Display() :
             mValZero(0),
@@ -52,8 +56,11 @@ public:
 
         bool IsFile()		const { return 0 == strcmp( mType.c_str(), RI_FILE ); }
         bool IsFrameBuff()	const { return 0 == strcmp( mType.c_str(), RI_FRAMEBUFFER ); }
+        bool IsZFile()		const { return 0 == strcmp( mType.c_str(), RI_ZFILE ); }
     };
 
+    typedef std::shared_ptr<Display>	DisplayPtr;
+
 public:
     Options();
     void Init( const SymbolList *pGlobalSyms, RevisionTracker *pRevision );
@@ -84,7 +91,7 @@ public:
     
     // Display
     u_int			mPixSamples[2];
-    DVec<Display *>	mpDisplays;
+    DVec<DisplayPtr>	moDisplays;	// shared with the copies of the options
 
     enum SearchPathh
     {
@@ -117,7 +124,9 @@ public:
             bool fallbackFbuffDisp );
 
     //==================================================================
-    const DVec<Display *> &GetDisplays() const	{	return mpDisplays;	}
+    const DVec<DisplayPtr> &GetDisplays() const	{	return moDisplays;	}
+
+    bool IsDepthOnly() const;
 
     void FreeDisplays();
 };
@@ -9,8 +9,10 @@
 #ifndef RI_PARAM_H
 #define RI_PARAM_H
 
+#include <memory>
 #include "DSystem/include/DTypes.h"
 #include "DSystem/include/DContainers.h"
+#include "RI_Base.h"
 
 //==================================================================
 namespace RI
@@ -18,7 +20,28 @@ namespace RI
 
 //==================================================================
 typedef DVec<float>	FltVec;
-    
+
+//==================================================================
+/// FltView
+/// Floats that live somewhere else, to read them like a vector
+//==================================================================
+class FltView
+{
+    const float	*mpData;
+    size_t		mSize;
+
+public:
+    FltView( const float *pData, size_t size ) : mpData(pData), mSize(size) {}
+
+    size_t		size() const						{ return mSize;		}
+    const float	*data() const						{ return mpData;	}
+    const float	&operator[]( size_t i ) const		{ DASSERT( i < mSize ); return mpData[i];	}
+};
+
+//==================================================================
+/// Param
+/// A value of a command. Strings and arrays are views into the
+/// values block of the ParamList that the Param is in
 //==================================================================
 struct Param
 {
@@ -35,44 +58,60 @@ struct Param
     
     u_int	type;
     
-    struct Values {
+    union Values {
         int			intVal;
         float		floatVal;
-        DStr		stringVal;
-        DVec<int>	intArrayVal;
-        FltVec		floatArrayVal;
-        DVec<DStr>	stringArrayVal;
     }u;
 
-    Param() : type(UNKNOWN) {}
-    ~Param() {}
+    const void	*mpValues;	// STR and the arrays, in the ParamList
+    size_t		mValuesN;	// length of the string, or items in the array
+
+private:
+    // an INT_ARR read as floats, built on first request
+    mutable FltVec	*mpIntArrAsFlt;
+
+public:
+    Param() : type(UNKNOWN), mpValues(NULL), mValuesN(0), mpIntArrAsFlt(NULL) {}
+
+    Param( const Param &from ) : type(UNKNOWN), mpIntArrAsFlt(NULL)	{ copyFrom( from ); }
+    Param( Param &&from ) noexcept : type(UNKNOWN), mpIntArrAsFlt(NULL)	{ moveFrom( from ); }
+
+    ~Param() { Clear(); }
 
-    /*
     Param &operator=( const Param &rhs )
     {
-        type = rhs.type;
-        switch ( type )
+        if ( this != &rhs )
+        {
+            Clear();
+            copyFrom( rhs );
+        }
+        return *this;
+    }
+
+    Param &operator=( Param &&rhs ) noexcept
+    {
+        if ( this != &rhs )
         {
-        case INT:		u.intVal = rhs.u.intVal;	break;
-        case FLT:		u.floatVal = rhs.u.floatVal;	break;
-        case INT_ARR: 	u.stringVal = rhs.u.stringVal;	break;
-        case FLT_ARR: 	u.intArrayVal = rhs.u.intArrayVal;	break;
-        case STR:		u.floatArrayVal = rhs.u.floatArrayVal;	break;
-
-        case UNKNOWN:
-        default:
-                DASSERT( 0 );
-                break;
+            Clear();
+            moveFrom( rhs );
         }
-        
         return *this;
     }
-    */
+
+    void Clear();
+
+    // memory held outside of the Param and of its ParamList
+    size_t GetHeapMemSize() const;
+
+    void SetInt( int val );
+    void SetFlt( float val );
+
+    bool HasValues() const	{ return type >= STR; }
 
     inline int			Int() const
     {
         if ( type == INT )		return u.intVal;	else
-        if ( type == INT_ARR )	return u.intArrayVal[0];	else
+        if ( type == INT_ARR )	return PInt()[0];	else
                                 { badType(); return 0; }
     }
 
@@ -80,17 +119,17 @@ struct Param
     {
         if ( type == FLT )		return u.floatVal;	else
         if ( type == INT )		return (float)u.intVal;	else
-        if ( type == FLT_ARR )	return u.floatArrayVal[0];	else
-        if ( type == INT_ARR )	return (float)u.intArrayVal[0];	else
+        if ( type == FLT_ARR )	return PFlt()[0];	else
+        if ( type == INT_ARR )	return (float)PInt()[0];	else
                                 { badType(); return 0; }
     }
     
-    const FltVec	&NumVec( size_t n=DNPOS );	// may need to convert from int array
+    FltView			NumVec( size_t n=DNPOS ) const;	// may need to convert from int array
 
-    const int		*PInt( size_t n=DNPOS ) const	{ ensIntArr( n );		return &u.intArrayVal[0];		}
-    size_t			IntArrSize() const				{ ensIntArr( DNPOS );	return u.intArrayVal.size();	}
-    const float		*PFlt( size_t n=DNPOS )			{ return &NumVec( n )[0];						}
-    size_t			FltArrSize()					{ return NumVec().size();						}
+    const int		*PInt( size_t n=DNPOS ) const	{ ensIntArr( n );		return (const int *)mpValues;	}
+    size_t			IntArrSize() const				{ ensIntArr( DNPOS );	return mValuesN;				}
+    const float		*PFlt( size_t n=DNPOS ) const	{ return NumVec( n ).data();					}
+    size_t			FltArrSize() const				{ return NumVec().size();						}
 
     const char		*PChar()				const;
 
@@ -102,6 +141,9 @@ struct Param
     operator int			() const	{	return Int();	}
 
 private:
+    void copyFrom( const Param &from );
+    void moveFrom( Param &from );
+
     void ensType( u_int type_ ) const
     {
         if ( type != type_ )
@@ -109,12 +151,12 @@ private:
     }		
     void ensIntArr( size_t n ) const
     {
-        if ( type != INT_ARR && (n==DNPOS || u.intArrayVal.size() == n) )
+        if ( type != INT_ARR )
             badType();
     }		
     void ensFltArr( size_t n ) const
     {
-        if ( type != FLT_ARR && (n==DNPOS || u.floatArrayVal.size() == n) )
+        if ( type != FLT_ARR )
             badType();
     }
     void badType() const
@@ -123,14 +165,62 @@ private:
     }	
 };
 
+//==================================================================
+/// ParamList
+/// The params of a command, with all of their strings and arrays in
+/// one block of values. The block is shared by the copies of the list,
+/// and it's copied only if a shared list gets more params
 //==================================================================
 class ParamList : public DVec<Param>
 {
+    typedef DVec<U8>	Values;
+
+    std::shared_ptr<Values>	moValues;
 
 public:
+    void clear();
+
     void Add( const char *pStr );
     void Add( float val );
     void Add( int val );
+
+    // for the parser, to fill the values in place. Only the last
+    // param can be an array that is still growing
+    void	AddStr( const char *pStr, size_t len );
+    void	AddUnknown();
+    void	AddArr( u_int arrType );	// INT_ARR, FLT_ARR or STR_ARR
+    void	AppendInt( int val );
+    void	AppendFlt( float val );
+    float	*AppendFlts( size_t n );
+    void	AppendStr( const char *pStr, size_t len );
+    void	ChangeIntArrToFltArr();
+
+    // done adding, trims the block of values
+    void ShrinkValues();
+
+    size_t GetValuesMemSize() const	{	return moValues ? moValues->capacity() : 0;	}
+
+private:
+    U8 *allocValues( size_t size, size_t align );
+    void rebase( const U8 *pOldBase, const U8 *pNewBase );
+};
+
+//==================================================================
+/// ParamListRC
+/// The parameters of a primitive, taken once from the command and
+/// then read-only. Shared by the primitive and by all the primitives
+/// that it's simplified or split into. The values aren't copied, the
+/// block is shared with the command
+//==================================================================
+class ParamListRC : public RCBase
+{
+public:
+    const ParamList	mList;
+
+    ParamListRC( const ParamList &list ) :
+        mList(list)
+    {
+    }
 };
 
 //==================================================================
@@ -139,13 +229,13 @@ int FindParam(
             u_int expectedType,
             u_int altExpectedType,
             int fromIdx,
-            ParamList &params );
+            const ParamList &params );
 
 inline int FindParam(
             const char *pFindName,
             u_int expectedType,
             int fromIdx,
-            ParamList &params )
+            const ParamList &params )
 {
     return FindParam( pFindName, expectedType, expectedType, fromIdx, params );
 }
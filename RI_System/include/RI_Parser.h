@@ -11,45 +11,45 @@
 
 #include "DSystem/include/DTypes.h"
 #include "RI_Param.h"
+#include "RI_Commands.h"
+#include "DSystem/include/DIO_Stream.h"
 
 //==================================================================
 namespace RI
 {
 
 //==================================================================
-/// 
+/// Parser
+/// Splits the data of a RIB file into commands and their parameters.
+/// The data is either all in memory or streamed
 //==================================================================
 class Parser
 {
     class Tokenizer	*mpTokenizer;
 
-public:
-
-    DStr		mNextCommand;
+    CmdID		mNextCmdID;
     int			mNextCommandLine;
-    DStr		mCurCommand;
-    int			mCurCommandLine;
-    ParamList	mCurParams;
+    bool		mHasNextCommand;
+    DStr		mNextUnknownName;	// only for the unknown commands
+
+    CmdID		mCurCmdID;
+    DStr		mCurUnknownName;
 
 public:
-    Parser();
+    Parser( const char *pData, size_t dataSize );
+    Parser( DIO::InputStream &stream );
     ~Parser();
 
-    void AddChar( char ch );
-
-    bool HasNewCommand() const
-    {
-        return	( mCurCommand.length() != 0 );
-    }
-    
-    void FlushNewCommand( DStr		*out_pCmdName,
-                          ParamList	*out_pParams,
-                          int		*out_pCmdLine );
-    
+    // false when there are no more commands
+    bool NextCommand(
+                CmdID		&out_cmdID,
+                ParamList	&out_params,
+                int			&out_cmdLine );
+
+    // name of the last command returned, also when unknown
+    const char *GetCommandName() const;
+
     int GetCurLineNumber() const;
-    
-private:
-    bool	mReachedEOF;
 };
 
 //==================================================================
@@ -58,23 +58,39 @@ public:
         POLYGON,
 
         POINTSGENERALPOLYGONS,
+        POLYCLUSTER,
+
+        OBJECTINSTANCE,
+        DELAYEDARCHIVE,
     };
 
     Type				mType;
     Attributes			*mpAttribs;
     Transform			*mpTransform;
 
+    // deforming primitives: the shape at the last MotionBegin/End key,
+    // and how much of it is blended in at shutter open and close
+    PrimitiveBase		*mpMotionClose;
+    float				mMotionBlend[2];
+
 public:
-/*
     // a copy constructor 
     PrimitiveBase( const PrimitiveBase &from ) :
-        mRefCnt(0),
+#if defined(DEBUG) || defined(_DEBUG)
+        mpDbg_SrcArchive(from.mpDbg_SrcArchive),
+        mDbg_SrcLine(from.mDbg_SrcLine),
+#endif
         mType(from.mType),
         mpAttribs(from.mpAttribs),
-        mpTransform(from.mpTransform)
+        mpTransform(from.mpTransform),
+        mpMotionClose(from.mpMotionClose)
     {
+        if ( mpMotionClose )
+            mpMotionClose->Borrow();
+
+        mMotionBlend[0] = from.mMotionBlend[0];
+        mMotionBlend[1] = from.mMotionBlend[1];
     }
-*/
 
     PrimitiveBase( Type type ) :
 #if defined(DEBUG) || defined(_DEBUG)
@@ -83,12 +99,17 @@ public:
 #endif
         mType(type),
         mpAttribs(NULL),
-        mpTransform(NULL)
+        mpTransform(NULL),
+        mpMotionClose(NULL)
     {
+        mMotionBlend[0] = 0;
+        mMotionBlend[1] = 0;
     }
 
     virtual ~PrimitiveBase()
     {
+        if ( mpMotionClose )
+            mpMotionClose->Release();
     }
 
     PrimitiveBase *Borrow()
@@ -125,6 +146,21 @@ public:
     {
         return mRefCnt.GetCount() != 0;
     }
+
+    void SetMotionClose( PrimitiveBase *pClosePrim, const float blend[2] )
+    {
+        pClosePrim->Borrow();
+
+        if ( mpMotionClose )
+            mpMotionClose->Release();
+
+        mpMotionClose	= pClosePrim;
+        mMotionBlend[0]	= blend[0];
+        mMotionBlend[1]	= blend[1];
+    }
+
+private:
+    void operator =( const PrimitiveBase &from ) {}
 };
 
 //==================================================================
@@ -132,10 +168,15 @@ public:
 //==================================================================
 class ComplexPrimitiveBase : public PrimitiveBase
 {
+public:
+    // one of the keys of a deforming primitive: the keys must simplify
+    // into matching primitives
+    bool	mIsMotionKey;
 
 public:
     ComplexPrimitiveBase( PrimitiveBase::Type type ) :
-        PrimitiveBase(type)
+        PrimitiveBase(type),
+        mIsMotionKey(false)
     {
     }
 
@@ -158,6 +199,11 @@ public:
     u_int	mSplitCnt;
     int		mDiceGridWd;
     int		mDiceGridHe;
+    // displaced primitives are diced at power-of-two rates along the
+    // borders (v=0, u=1, v=1, u=0), so that the neighbours can be
+    // stitched. Micro-polygons along u, v and the borders, 0 if not
+    u_int	mDiceSegs[2];
+    u_int	mDiceEdgeSegs[4];
 
 public:
     SimplePrimitiveBase( PrimitiveBase::Type type ) :
@@ -166,6 +212,8 @@ public:
         mDiceGridWd(-1),
         mDiceGridHe(-1)
     {
+        clearDiceSegs();
+
         mURange[0] = 0;
         mURange[1] = 1;
         mVRange[0] = 0;
@@ -183,6 +231,8 @@ public:
         mDiceGridWd(-1),
         mDiceGridHe(-1)
     {
+        clearDiceSegs();
+
         mURange[0] = umin;
         mURange[1] = umax;
         mVRange[0] = vmin;
@@ -203,13 +253,26 @@ public:
         CHECKSPLITRES_SPLIT,
     };
 
-    CheckSplitRes CheckForSplit(
+    virtual CheckSplitRes CheckForSplit(
                             const Hider &hider,
                             int			out_bound2d[4],
                             bool		&out_uSplit,
                             bool		&out_vSplit );
 
-    void	Split( Hider &hider, bool uSplit, bool vSplit );
+    virtual CheckSplitRes CheckDiceOrSplit(
+                            const Hider &hider,
+                            float		pixelArea,
+                            bool		&out_uSplit,
+                            bool		&out_vSplit );
+
+    virtual void	Split( Hider &hider, bool uSplit, bool vSplit );
+
+    // moving transformation or deforming shape ?
+    bool	IsMoving() const;
+
+    // screen bound over the whole shutter interval, returns the
+    // larger of the areas at shutter open and close
+    float	RasterEstimate( const Hider &hider, int out_bound2d[4] ) const;
 
     // WARNING: we assume dicing no larger than 3^2 !!!
     // ..make sure about this everywhere MakeBound() uses MakeBoundFromUVRangeN
@@ -280,6 +343,8 @@ public:
                         WorkGrid &g,
                         bool doColorCoded ) const;
 
+    void	DiceMotion( WorkGrid &g ) const;
+
 /*
     inline Float2 CalcLocalUV( const Float2 &gridUV ) const
     {
@@ -304,6 +369,13 @@ public:
         return DMix( mURange[0], mURange[1], t );
     }
 
+protected:
+    void setupDice(
+                WorkGrid &g,
+                bool doColorCoded,
+                SlColor &out_useColor,
+                SlColor &out_useOpa ) const;
+
 private:
     void fillUVsArray(
                 Float2_ locUV[],
@@ -319,15 +391,32 @@ private:
                 float dv,
                 u_int xDim,
                 u_int yDim ) const;
+
+    void matchMotionCloseRange();
+
+    bool estimateRasterLenUV(
+                const Hider &hider,
+                const Matrix44 &mtxLocalWorld,
+                float &out_lenU,
+                float &out_lenV,
+                float out_edgeLens[4] ) const;
+
+    bool setDiceSegs( float lenU, float lenV, const float edgeLens[4], float mpSide );
+
+    void clearDiceSegs()
+    {
+        mDiceSegs[0] = mDiceSegs[1] = 0;
+        mDiceEdgeSegs[0] = mDiceEdgeSegs[1] = mDiceEdgeSegs[2] = mDiceEdgeSegs[3] = 0;
+    }
 };
 
 //==================================================================
-bool ParamsFindP(	ParamList &params,
+bool ParamsFindP(	const ParamList &params,
                     const SymbolList &globalSymbols,
                     DVec<Float3> &out_vectorP,
                     int fromIdx=1 );
 
-bool ParamsFindP(	ParamList &params,
+bool ParamsFindP(	const ParamList &params,
                     const SymbolList &globalSymbols,
                     Float3	*pOut_vectorP,
                     int		expectedN,
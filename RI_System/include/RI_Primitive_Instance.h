@@ -0,0 +1,87 @@
+//==================================================================
+/// RI_Primitive_Instance.h
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info. 
+//==================================================================
+
+#ifndef RI_PRIMITIVE_INSTANCE_H
+#define RI_PRIMITIVE_INSTANCE_H
+
+#include "RI_Primitive_Base.h"
+
+//==================================================================
+namespace RI
+{
+
+//==================================================================
+/// ObjectDef
+///
+/// A retained object, as defined by ObjectBegin/ObjectEnd.
+/// The primitives are stored once, in the space of the object, and
+/// are shared by all the ObjectInstance that reference the object.
+//==================================================================
+class ObjectDef
+{
+public:
+    DVec<PrimitiveBase *>		mpPrims;
+    DVec<Attributes *>			mpUniqueAttribs;
+    DVec<Transform *>			mpUniqueTransform;	// relative to the object
+
+    // made from mpPrims the first time that the object is rendered
+    bool						mIsSimplified;
+    DVec<SimplePrimitiveBase *>	mpSimplePrims;
+    DVec<u_int>					mSimplePrimXFormIdx;	// index in mpUniqueTransform
+    Bound						mBound;				// of mpSimplePrims, in object space
+
+    // split results, shared by the instances at a similar size on
+    // screen, also in the frames that follow
+    struct SplitCache
+    {
+        int							mSizeKey;
+        float						mShadingRate;
+        DVec<SimplePrimitiveBase *>	mpLeaves;
+        DVec<u_int>					mLeafXFormIdx;	// index in mpUniqueTransform
+    };
+
+    DVec<SplitCache>			mSplitCaches;
+
+private:
+    RevisionChecker				mAttrsRev;
+    RevisionChecker				mTransRev;
+
+public:
+    ObjectDef();
+    ~ObjectDef();
+
+    void Insert(	PrimitiveBase		*pPrim,
+                    const Attributes	&attr,
+                    const Transform		&xform );
+
+    void AddSimplified( SimplePrimitiveBase *pPrim );
+};
+
+//==================================================================
+/// ObjectInstance
+//==================================================================
+class ObjectInstance : public ComplexPrimitiveBase
+{
+public:
+    ObjectDef	*mpObjectDef;
+
+public:
+    ObjectInstance( ObjectDef *pObjectDef ) :
+        ComplexPrimitiveBase(OBJECTINSTANCE),
+        mpObjectDef(pObjectDef)
+    {
+    }
+
+        // instances are expanded by the Framework
+        void Simplify( Hider &hider )	{	DASSERT( 0 );	}
+};
+
+//==================================================================
+}
+
+#endif
@@ -27,8 +27,9 @@ private:
     //Float3_		mHullPos[4];
 
 public:
-    PatchBilinear( ParamList &params, const SymbolList &globalSymbols );
-    PatchBilinear( ParamList &params, const Float3 hull[4] );
+    PatchBilinear( const ParamList &params, const SymbolList &globalSymbols );
+    PatchBilinear( const ParamList &params, const Float3 hull[4] );
+    PatchBilinear( const Float3 hull[4] );
 
     ~PatchBilinear()
     {
@@ -96,7 +97,7 @@ public:
 class PatchBicubic : public SimplePrimitiveBase
 {
 private:
-    ParamList				mParams;
+    RCSha<ParamListRC>		moParams;	// shared with the split pieces
     const RtBasis			*mpUBasis;
     const RtBasis			*mpVBasis;
     Float3					mHullPos[16];
@@ -108,7 +109,7 @@ private:
 
 public:
     PatchBicubic( ParamList &params, const Attributes &attr, const SymbolList &globalSymbols );
-    PatchBicubic( ParamList &params,
+    PatchBicubic( const ParamListRC *pParams,
                             const Float3 hull[16],
                             const Attributes &attr,
                             const SymbolList &globalSymbols );
@@ -136,8 +137,8 @@ private:
 class PatchMesh : public ComplexPrimitiveBase
 {
 public:
-    const Symbol*	mpPatchType;
-    ParamList		mParams;
+    const Symbol*		mpPatchType;
+    RCSha<ParamListRC>	moParams;
 
 public:
     PatchMesh(RtToken type,
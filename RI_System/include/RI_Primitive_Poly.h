@@ -23,7 +23,7 @@ class Hider;
 class Polygon : public ComplexPrimitiveBase
 {
 public:
-    ParamList		mParams;
+    RCSha<ParamListRC>	moParams;
 
 public:
     Polygon( ParamList &params, const SymbolList &globalSymbols );
@@ -37,7 +37,7 @@ public:
 class PointsPolygons : public ComplexPrimitiveBase
 {
 public:
-    ParamList		mParams;
+    RCSha<ParamListRC>	moParams;
 
 public:
     PointsPolygons( ParamList &params, const SymbolList &globalSymbols );
@@ -51,7 +51,7 @@ public:
 class PointsGeneralPolygons : public ComplexPrimitiveBase
 {
 public:
-    ParamList		mParams;
+    RCSha<ParamListRC>	moParams;
 
 public:
     PointsGeneralPolygons( ParamList &params, const SymbolList &globalSymbols );
@@ -59,6 +59,77 @@ public:
         void Simplify( Hider &hider );
 };
 
+//==================================================================
+/// PolyCluster
+/// A range of the bilinear quads that a polygon mesh is made of.
+/// The quads are diced together in a single grid, a block of vertices
+/// each, and the micro-polygons between the blocks are holes.
+/// A cluster too large for a grid is split into the two halves of its
+/// range, the quads are sorted so that every half is spatially compact
+//==================================================================
+class PolyCluster : public SimplePrimitiveBase
+{
+public:
+    class MeshDef : public RCBase
+    {
+    public:
+        DVec<Float3>	mVerts;
+        DVec<U32>		mQuads;	// 4 vertices each, in the order of a PatchBilinear hull
+
+    public:
+        u_int GetQuadsN() const	{ return (u_int)(mQuads.size() / 4); }
+
+        void GetQuadHull( u_int quadIdx, Float3 out_hull[4] ) const
+        {
+            const U32	*pIdx = &mQuads[ quadIdx * 4 ];
+
+            for (size_t i=0; i < 4; ++i)
+                out_hull[i] = mVerts[ pIdx[i] ];
+        }
+
+        void SortSpatially();
+    };
+
+private:
+    RCSha<MeshDef>	moMesh;
+    u_int			mQuadsRange[2];
+    Bound			mBound;
+    u_int			mBlockDim[2];	// vertices along u and v of each quad
+    u_int			mBlocksPerRow;
+
+public:
+    PolyCluster( const MeshDef *pMesh, u_int quadsBegin, u_int quadsEnd );
+
+        PolyCluster *Clone() const {	return DNEW PolyCluster( *this ); }
+
+        void MakeBound( Bound &out_bound, Float3_ *out_pPo ) const;
+
+        void Eval_dPdu_dPdv(
+                        const Float2_ &uv,
+                        Float3_ &out_pt,
+                        Float3_ *out_dPdu,
+                        Float3_ *out_dPdv ) const;
+
+        CheckSplitRes CheckForSplit(
+                        const Hider &hider,
+                        int			out_bound2d[4],
+                        bool		&out_uSplit,
+                        bool		&out_vSplit );
+
+        CheckSplitRes CheckDiceOrSplit(
+                        const Hider &hider,
+                        float		pixelArea,
+                        bool		&out_uSplit,
+                        bool		&out_vSplit );
+
+        void Split( Hider &hider, bool uSplit, bool vSplit );
+
+        void Dice( WorkGrid &g, bool doColorCoded ) const;
+
+private:
+    void updateBound();
+};
+
 //==================================================================
 }
 
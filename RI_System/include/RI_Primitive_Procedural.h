@@ -0,0 +1,50 @@
+//==================================================================
+/// RI_Primitive_Procedural.h
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info. 
+//==================================================================
+
+#ifndef RI_PRIMITIVE_PROCEDURAL_H
+#define RI_PRIMITIVE_PROCEDURAL_H
+
+#include "RI_Primitive_Base.h"
+
+//==================================================================
+namespace RI
+{
+
+//==================================================================
+/// DelayedArchive
+///
+/// Procedural "DelayedReadArchive". Stands in the buckets touched by
+/// its bound, and the archive is only read when one of them finds it
+/// visible, while rendering.
+//==================================================================
+class DelayedArchive : public ComplexPrimitiveBase
+{
+public:
+    DStr	mPathFName;
+    Bound	mBound;			// in object space, as declared
+    float	mNearDepth;		// in camera space, set when placed in the buckets
+    bool	mIsExpanded;
+
+public:
+    DelayedArchive( const char *pPathFName, const Bound &bound ) :
+        ComplexPrimitiveBase(DELAYEDARCHIVE),
+        mPathFName(pPathFName),
+        mBound(bound),
+        mNearDepth(0),
+        mIsExpanded(false)
+    {
+    }
+
+        // expanded by the Framework
+        void Simplify( Hider &hider )	{	DASSERT( 0 );	}
+};
+
+//==================================================================
+}
+
+#endif
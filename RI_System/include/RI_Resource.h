@@ -10,6 +10,7 @@
 #define RI_RESOURCE_H
 
 #include <mutex>
+#include "DSystem/include/DIO_FileManager.h"
 #include "RI_Base.h"
 
 //==================================================================
@@ -24,18 +25,27 @@ public:
     {
         TYPE_SHADER,
         TYPE_TEXTURE,
+        TYPE_SHADOWMAP,
+        TYPE_ENVMAP,
     };
 
 private:
     std::string	mName;
     Type		mType;
+
+    // the file it comes from, to tell when it changes
+    DStr		mPathFName;
+    U64			mFileSize;
+    U64			mFileTime;
     
     friend class ResourceManager;
 
 public:
     ResourceBase( const char *pName, Type type ) :
         mName(pName),
-        mType(type)
+        mType(type),
+        mFileSize(0),
+        mFileTime(0)
     {
     }
     
@@ -51,6 +61,7 @@ class ResourceManager
 {
     std::mutex              mMutex;
     DVec<ResourceBase *>	mpList;
+    DVec<ResourceBase *>	mpDropped;	// out of date, deleted once unused
 public:
     ResourceManager()
     {
@@ -63,9 +74,19 @@ public:
     
     ResourceBase *AddResource( ResourceBase *pRes );
 
+    ResourceBase *AddResource(
+                        ResourceBase			*pRes,
+                        DIO::FileManagerBase	&fileManager,
+                        const char				*pPathFName );
+
     ResourceBase *FindResource( const char *pName, ResourceBase::Type type );
 
+    void DropChanged( DIO::FileManagerBase &fileManager );
+
     void Collect();
+
+private:
+    static void deleteUnused( DVec<ResourceBase *> &pList );
 };
 
 
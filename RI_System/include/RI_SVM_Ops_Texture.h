@@ -165,6 +165,10 @@ void Inst_Texture( Context &ctx, u_int blocksN )
     ctx.NextInstruction();
 }
 
+//==================================================================
+void Inst_Shadow_SXVS( Context &ctx, u_int blocksN );
+void Inst_Environment_SXV( Context &ctx, u_int blocksN );
+void Inst_Environment_VXV( Context &ctx, u_int blocksN );
 
 //==================================================================
 }
@@ -180,17 +180,27 @@ public:
         const char	*pSource;
         const char	*pSourceFileName;
         const char	*pBaseIncDir;
+        const char	*pCacheDir;		// for compiled .sl, NULL is next to the source
 
         CtorParams() :
             pName(NULL),
             pSource(NULL),
             pSourceFileName(NULL),
-            pBaseIncDir(NULL)
+            pBaseIncDir(NULL),
+            pCacheDir(NULL)
         {
         }
     };
 
     Shader( const CtorParams &params, DIO::FileManagerBase &fileManager );
+
+    // empty, to be filled by RRASM::Parser, ReadShaderObj() or Load()
+    Shader( const char *pName );
+
+    void Load( const CtorParams &params, DIO::FileManagerBase &fileManager );
+
+    // back to empty (runs as a no-op)
+    void Clear();
 };
 
 //==================================================================
@@ -211,6 +221,8 @@ public:
     ShaderInst( Shader *pShader, size_t maxPointsN=MP_GRID_MAX_SIZE );
     ~ShaderInst();
 
+    const Shader *GetShader() const	{	return moShader.get();	}
+
     ShaderInst( const ShaderInst &right )
     {
         DASSERT( right.moShader.get() != NULL );
@@ -0,0 +1,51 @@
+//==================================================================
+/// RI_SVM_ShaderObj.h
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info.
+//==================================================================
+
+#ifndef RI_SVM_SHADEROBJ_H
+#define RI_SVM_SHADEROBJ_H
+
+#include "RI_SVM_Shader.h"
+#include "DSystem/include/DUtils_MemFile.h"
+
+//==================================================================
+namespace RI
+{
+//==================================================================
+namespace SVM
+{
+
+//==================================================================
+/// Precompiled shader object (.rrobj)
+///
+/// A flat image of what RRASM::Parser builds in a Shader: header,
+/// string table, constant table, symbol table and the CPU words of
+/// the code. Loading is a straight walk over the data, without any
+/// tokenizing.
+/// Objects built against a different version of the format or of
+/// the opcodes table are rejected (and should be recompiled).
+/// Objects made from .sl also carry a key of the source they were
+/// compiled from (see MakeShaderObjKey()), used for caching.
+//==================================================================
+static const U32	SHADEROBJ_VERSION = 2;
+
+bool IsShaderObj( const void *pData, size_t dataSize );
+
+U64 MakeShaderObjKey( U64 sourceHash );
+U64 GetShaderObjKey( const void *pData, size_t dataSize );
+
+void WriteShaderObj( const Shader &shader, DUT::MemWriterDynamic &mw, U64 sourceKey=0 );
+void SaveShaderObj( const Shader &shader, const char *pFName, U64 sourceKey=0 );
+
+bool ReadShaderObj( Shader &shader, const void *pData, size_t dataSize );
+
+//==================================================================
+}
+//==================================================================
+}
+
+#endif
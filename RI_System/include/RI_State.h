@@ -12,11 +12,13 @@
 #include "RI_Base.h"
 #include "DSystem/include/DContainers.h"
 #include "DSystem/include/DIO_FileManager.h"
+#include "DSystem/include/DThreads.h"
 #include "RI_Options.h"
 #include "RI_Attributes.h"
 #include "RI_Transform.h"
 #include "RI_Framework.h"
 #include "RI_LightSource.h"
+#include "RI_Primitive_Instance.h"
 
 //==================================================================
 namespace RI
@@ -52,6 +54,7 @@ public:
     CopyStack()          { mVec.resize(1); }
     void push()          { mVec.push_back( top() ); }
     void pop()           { mVec.pop_back(); }
+    size_t size() const  { return mVec.size(); }
     const T &top() const { return mVec.back(); }
           T &top()       { return mVec.back(); }
     void clear()         { mVec.clear(); }
@@ -69,6 +72,7 @@ public:
         DIO::FileManagerBase	*mpFileManager		;
         DStr					mBaseDir			;
         DStr					mDefaultShadersDir	;
+        DStr					mShaderCacheDir		;	// empty to cache next to the sources
         DStr					mForcedSurfaceShader;
 
         Params() :
@@ -83,23 +87,52 @@ private:
     DVec<Mode>	            mModeStack;
     CopyStack<Options	>	mOptionsStack;
     CopyStack<Attributes>	mAttributesStack;
-    CopyStack<Transform	>	mTransformOpenStack;
-    CopyStack<Transform	>	mTransformCloseStack;
+    CopyStack<Transform	>	mTransformStack;
     
     RevisionTracker			mOptionsRevTrack;
     RevisionTracker			mAttribsRevTrack;
-    RevisionTracker			mTransOpenRevTrack;
-    RevisionTracker			mTransCloseRevTrack;
+    RevisionTracker			mTransRevTrack;
 
     DVec<LightSourceT *>	mpLightSources;
 
     Matrix44				mMtxWorldCamera;
 
+    DVec<ObjectDef *>		mpObjectDefs;
+    ObjectDef				*mpCurObjectDef;	// between ObjectBegin/End
+
+    // between MotionBegin/End
+    DVec<float>				mMotionTimes;
+    u_int					mMotionKeyIdx;
+    Matrix44				mMotionFirstMtx;
+    PrimitiveBase			*mpMotionFirstPrim;
+
+    // between DelayedBegin/End, the depths to go back to
+    struct DelayedMark
+    {
+        size_t	mModesN;
+        size_t	mAttribsN;
+        size_t	mTransN;
+    };
+
+    DVec<DelayedMark>		mDelayedMarks;
+
 public:
     Params					mParams;
 private:
     ResourceManager			mResManager;
 
+    // shaders are loaded in the background, and waited for at WorldEnd
+    struct PendingShader
+    {
+        RCSha<SVM::Shader>	moShader;
+        DStr				mFullPathName;
+        DStr				mAlternateName;		// in case of failure
+        std::future<void>	mFuture;
+    };
+
+    DVec<PendingShader>		mPendingShaders;
+    DTH::TaskQueue			mShaderLoadTasks;	// after mResManager, to be destroyed first
+
     enum OpType
     {
         OPTYPE_OPTS,
@@ -136,9 +169,22 @@ public:
     void	SolidEnd();
     ObjectHandle ObjectBegin();
     void	ObjectEnd();
+    void	ObjectInstance( ObjectHandle handle );
     void	MotionBegin( int n, const float times[] );
     void	MotionEnd();
 
+    // reading of a delayed archive, from the attributes and
+    // transformation where it was declared
+    void	DelayedBegin( const Attributes &attr, const Transform &xform );
+    bool	DelayedEnd();
+
+    // false, with an error, in a delayed archive
+    bool	VerifyOutsideProcedural( const char *pCmdName );
+
+    // for archives of only geometry, kept as objects across frames
+    bool	CanInstanceArchive() const;
+    bool	IsObjectShapeCurrent( ObjectHandle handle ) const;
+
     // attributes
     void DoBound( const Bound &bound );
 
@@ -154,6 +200,7 @@ public:
 
     void Orientation( RtToken orientation );
     void Sides( int sides );
+    void ShadingRate( float size );
     void Basis( RtToken ubasis, const float *pCustomUBasis, int ustep,
                 RtToken vbasis, const float *pCustomVBasis, int vstep );
                 
@@ -216,6 +263,8 @@ public:
     void PointsPolygons( ParamList &params );
     void PointsGeneralPolygons( ParamList &params );
 
+    void DelayedReadArchive( const char *pPathFName, const Bound &bound );
+
     // --- Non RI commands
 
     void ErrHandler( Error errCode );
@@ -224,14 +273,21 @@ public:
     size_t AddLightSource( LightSourceT *pLSource );
     const DVec<LightSourceT *>	&GetLightSources()	{	return mpLightSources;	}
 
-    const Matrix44 &GetCurTransformOpenMtx() const	{	return mTransformOpenStack.top().GetMatrix();	}
-    const Matrix44 &GetCurTransformCloseMtx() const	{	return mTransformCloseStack.top().GetMatrix();	}
+    const Matrix44 &GetCurTransformOpenMtx() const	{	return mTransformStack.top().GetMatrix();		}
+    const Matrix44 &GetCurTransformCloseMtx() const	{	return mTransformStack.top().GetMatrixClose();	}
 
     const Matrix44 &GetWorldCameraMtx() const		{	return mMtxWorldCamera;	}
 
     SVM::Shader *GetShader( const char *pShaderName, const char *pAlternateName );
 
+    void ResolveShaders();
+
 private:
+    void waitPendingShaders();
+
+    DStr findShaderFile( const char *pShaderName );
+    void loadAlternateShader( SVM::Shader *pShader, const char *pAlternateName );
+
     bool checkPopMode( Mode expectedMode );
     bool verifyOpType( OpType optype );
     bool verifyBasis( RtToken basis, int steps );
@@ -257,6 +313,11 @@ private:
     inline void popStacks( const u_int flags );
     
     inline void insertPrimitive( PrimitiveBase *pPrim );
+
+    bool isInMotion() const	{	return mModeStack.back() == MD_MOTION;	}
+    void getMotionBlend( float out_blend[2] ) const;
+    void concatTransform( const Matrix44 &mtx );
+    void motionTransform( const Matrix44 &mtx, bool isConcat );
     
     void makeDefaultShaders( const char *pBasePath );
     void addDefShader( const char *pBasePath, const char *pSName );
@@ -48,6 +48,99 @@ public:
 */
 };
 
+//==================================================================
+/// TiledMap
+//==================================================================
+// Float texels stored in square tiles, so that filtered lookups
+// that touch neighboring rows stay in the same few cache lines
+class TiledMap
+{
+public:
+    static const u_int	TILE_DIM_LOG2	= 4;
+    static const u_int	TILE_DIM		= 1 << TILE_DIM_LOG2;
+
+private:
+    u_int		mWd;
+    u_int		mHe;
+    u_int		mChansN;
+    u_int		mTilesX;
+    DVec<float>	mTexels;
+
+public:
+    TiledMap() :
+        mWd(0),
+        mHe(0),
+        mChansN(0),
+        mTilesX(0)
+    {
+    }
+
+    void Init( const DIMG::Image &img, u_int chansN );
+
+    u_int GetWd() const	{ return mWd;	}
+    u_int GetHe() const	{ return mHe;	}
+
+    const float *GetTexel( u_int x, u_int y ) const
+    {
+        DASSERT( x < mWd && y < mHe );
+
+        u_int	tileIdx	= (y >> TILE_DIM_LOG2) * mTilesX + (x >> TILE_DIM_LOG2);
+        u_int	inIdx	= ((y & (TILE_DIM-1)) << TILE_DIM_LOG2) + (x & (TILE_DIM-1));
+
+        return &mTexels[ ((tileIdx << (TILE_DIM_LOG2*2)) + inIdx) * mChansN ];
+    }
+
+    void SampleBilinear(
+                float *out_pVal,
+                float x,
+                float y,
+                int minX,
+                int maxX,
+                bool wrapX ) const;
+};
+
+//==================================================================
+/// ShadowMap
+//==================================================================
+class ShadowMap : public ResourceBase
+{
+    TiledMap	mMap;
+    Matrix44	mMtxWorldCamera;
+    Matrix44	mMtxWorldProj;
+
+public:
+    ShadowMap( const char *pName, DUT::MemFile &file );
+
+    // returns the occluded fraction for points in the space
+    // described by mtxCurWorld
+    void Sample_PCF(
+                Float_			&dest,
+                const Float3_	&pos,
+                const Matrix44	&mtxCurWorld,
+                const Float_	&bias ) const;
+};
+
+//==================================================================
+/// EnvMap
+//==================================================================
+class EnvMap : public ResourceBase
+{
+public:
+    enum Layout
+    {
+        LAYOUT_LATLONG,
+        LAYOUT_CUBESTRIP,	// +x -x +y -y +z -z, left to right
+    };
+
+private:
+    TiledMap	mMap;
+    Layout		mLayout;
+
+public:
+    EnvMap( const char *pName, DUT::MemFile &file );
+
+    void Sample( Float3_ &dest, const Float3_ &dir ) const;
+};
 
 //==================================================================
 }
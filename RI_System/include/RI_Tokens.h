@@ -17,7 +17,7 @@
 #include "RI_Base.h"
 
 //==================================================================
-extern RtToken	RI_FRAMEBUFFER, RI_FILE;
+extern RtToken	RI_FRAMEBUFFER, RI_FILE, RI_ZFILE;
 extern RtToken	RI_RGB, RI_RGBA, RI_RGBZ, RI_RGBAZ, RI_A, RI_Z, RI_AZ;
 extern RtToken	RI_PERSPECTIVE, RI_ORTHOGRAPHIC;
 extern RtToken	RI_HIDDEN, RI_PAINT;
@@ -23,7 +23,14 @@ namespace RI
 class Transform
 {
 public:
-    Transform() : mMatrix(true)	{ }
+    Transform() : mMatrix(true), mMatrixClose(true), mIsMoving(false)	{ }
+
+    // a fixed transformation, not tracked by the State
+    Transform( const Matrix44 &mtx ) :
+        mpRevision(NULL), mMatrix(mtx), mMatrixClose(mtx), mIsMoving(false)	{ }
+
+    Transform( const Matrix44 &mtx, const Matrix44 &mtxClose ) :
+        mpRevision(NULL), mMatrix(mtx), mMatrixClose(mtxClose), mIsMoving(mtx != mtxClose)	{ }
 
     // avoid initialization of default values and just copy..
     Transform( const Transform &fromObj ) {	*this = fromObj; }
@@ -35,12 +42,18 @@ public:
         mpRevision = pRevision;
     }
 
-    const Matrix44 &GetMatrix() const	{	return mMatrix;		}
+    // at shutter open and close
+    const Matrix44 &GetMatrix() const		{	return mMatrix;			}
+    const Matrix44 &GetMatrixClose() const	{	return mMatrixClose;	}
+
+    bool IsMoving() const	{	return mIsMoving;	}
 
     void SetIdentity()
     {
         mpRevision->BumpRevision();
         mMatrix.Identity();
+        mMatrixClose.Identity();
+        mIsMoving = false;
     }
 
     void ConcatTransform( const Matrix44 &m )
@@ -49,12 +62,35 @@ public:
 
         // check if not identity ?
         mMatrix = m * mMatrix;
+        mMatrixClose = m * mMatrixClose;
     }
 
     void CopyRowMajor( const float *pSrcMtx )
     {
         mpRevision->BumpRevision();
         mMatrix.CopyRowMajor( pSrcMtx );
+        mMatrixClose = mMatrix;
+        mIsMoving = false;
+    }
+
+    // from a MotionBegin/End block, with the keys already
+    // brought to shutter open and close
+    void ConcatTransform( const Matrix44 &mOpen, const Matrix44 &mClose )
+    {
+        mpRevision->BumpRevision();
+
+        mMatrix = mOpen * mMatrix;
+        mMatrixClose = mClose * mMatrixClose;
+        mIsMoving = (mMatrix != mMatrixClose);
+    }
+
+    void SetMatrix( const Matrix44 &mOpen, const Matrix44 &mClose )
+    {
+        mpRevision->BumpRevision();
+
+        mMatrix = mOpen;
+        mMatrixClose = mClose;
+        mIsMoving = (mMatrix != mMatrixClose);
     }
 
 public:
@@ -62,6 +98,8 @@ public:
 
 private:
     Matrix44	mMatrix;
+    Matrix44	mMatrixClose;
+    bool		mIsMoving;
 };
 
 //==================================================================
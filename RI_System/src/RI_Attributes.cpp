@@ -55,14 +55,18 @@ void Attributes::copyFrom(const Attributes& rhs)
     mpRevision			= rhs.mpRevision			;
     mBound				= rhs.mBound				;
     mDetail				= rhs.mDetail				;
+    mDetailSize			= rhs.mDetailSize			;
     mMinVisible			= rhs.mMinVisible			;
     mLowerTransition	= rhs.mLowerTransition		;
     mUpperTransition	= rhs.mUpperTransition		;
     mMaxVisible			= rhs.mMaxVisible			;
+    mLODDissolve[0]		= rhs.mLODDissolve[0]		;
+    mLODDissolve[1]		= rhs.mLODDissolve[1]		;
     mpTypeApproximation	= rhs.mpTypeApproximation	;
     mValueApproximation	= rhs.mValueApproximation	;
     mOrientationFlipped	= rhs.mOrientationFlipped	;
     mSides				= rhs.mSides				;
+    mShadingRate		= rhs.mShadingRate			;
     mpUBasis			= rhs.mpUBasis				;
     mpVBasis			= rhs.mpVBasis				;
 
@@ -105,15 +109,19 @@ void Attributes::Init(
 
     mBound		= RI_INFINITY;
     mDetail		= RI_INFINITY;
+    mDetailSize	= -1;
 
     mMinVisible			= 0;
     mLowerTransition	= 0;
     mUpperTransition	= RI_INFINITY;
     mMaxVisible			= RI_INFINITY;
 
+    updateLOD();
+
     cmdGeometricApproximation( RI_EMPTY_TOKEN, 0 );
     cmdOrientation( RI_OUTSIDE );
     cmdSides( 2 );
+    cmdShadingRate( 1 );
     cmdBasis( RI_BEZIERBASIS, NULL, 3, RI_BEZIERBASIS, NULL, 3 );
 
     mpCustomUBasis = NULL;
@@ -132,6 +140,19 @@ void Attributes::Init(
     moSurfaceSHI = DNEW SVM::ShaderInst( pShader );
 }
 
+//==================================================================
+/// The patch basis and steps, and clustering being off for displaced
+/// meshes. The rest is only needed from dicing on
+bool Attributes::IsSameShaping( const Attributes &other ) const
+{
+    return
+        mUSteps == other.mUSteps &&
+        mVSteps == other.mVSteps &&
+        0 == memcmp( &GetUBasis(), &other.GetUBasis(), sizeof(RtBasis) ) &&
+        0 == memcmp( &GetVBasis(), &other.GetVBasis(), sizeof(RtBasis) ) &&
+        NOT( moDisplaceSHI.get() ) == NOT( other.moDisplaceSHI.get() );
+}
+
 //==================================================================
 const LightSourceT * Attributes::GetLight( size_t actLightIdx ) const
 {
@@ -148,9 +169,11 @@ void Attributes::cmdBound( const Bound &bound )
 }
 
 //==================================================================
-void Attributes::cmdDetail( const Bound &detail )
+void Attributes::cmdDetail( const Bound &detail, float detailSize )
 {
-    mDetail = detail;
+    mDetail		= detail;
+    mDetailSize	= detailSize;
+    updateLOD();
     mpRevision->BumpRevision();
 }
 
@@ -164,9 +187,40 @@ void Attributes::cmdDetailRange(float	minVisible,
     mLowerTransition	= lowerTransition;
     mUpperTransition	= upperTransition;
     mMaxVisible			= maxVisible;
+    updateLOD();
     mpRevision->BumpRevision();
 }
 
+//==================================================================
+/// Visibility of this level of detail, given the size of the Detail
+/// bound. In the transitions the levels are dissolved into each other
+/// by giving them complementary ranges of the samples dissolve value
+void Attributes::updateLOD()
+{
+    mLODDissolve[0] = 0;
+    mLODDissolve[1] = 1;
+
+    // no Detail, always visible
+    if ( mDetailSize < 0 )
+        return;
+
+    float	size = mDetailSize;
+
+    if ( size < mMinVisible || size > mMaxVisible )
+    {
+        mLODDissolve[1] = 0;
+        return;
+    }
+
+    // fading in
+    if ( size < mLowerTransition )
+        mLODDissolve[1] = (size - mMinVisible) / (mLowerTransition - mMinVisible);
+
+    // fading out
+    if ( size > mUpperTransition )
+        mLODDissolve[0] = (size - mUpperTransition) / (mMaxVisible - mUpperTransition);
+}
+
 //==================================================================
 void Attributes::cmdGeometricApproximation(RtToken typeApproximation,
                                            float valueApproximation )
@@ -209,6 +263,14 @@ void Attributes::cmdSides( int sides )
     mpRevision->BumpRevision();
 }
 
+//==================================================================
+void Attributes::cmdShadingRate( float size )
+{
+    // area in pixels covered by a micropolygon
+    mShadingRate	= DMAX( size, RI_EPSILON );
+    mpRevision->BumpRevision();
+}
+
 //==================================================================
 void Attributes::cmdBasis(
                 RtToken ubasis, const float *pCustomUBasis, int ustep,
@@ -341,7 +403,7 @@ void Attributes::cmdLightSource( ParamList &params )
 
     pLight->mID = params[1].Int();
 
-    pLight->mIsAmbient = !pShader->mHasDirPosInstructions;
+    // mIsAmbient is known only once the shader is loaded (see State::ResolveShaders())
 
     Matrix44 mtxLocalCam = mpState->GetCurTransformOpenMtx() * mpState->GetWorldCameraMtx();
     getShaderParams( params, 2, *pLight->moShaderInst.get(), mtxLocalCam );
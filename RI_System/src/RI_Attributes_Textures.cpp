@@ -50,11 +50,63 @@ Texture *Attributes::GetTexture( const char *pTextureName ) const
         }
 */
 
-        mpResManager->AddResource( pTexture );
+        mpResManager->AddResource(
+                        pTexture,
+                        mpState->GetFileManager(),
+                        shaderFullPathName.c_str() );
     }
 
     return pTexture;
 }
 
+//==================================================================
+template <class _T>
+static _T *getMapResource(
+                    State				&state,
+                    ResourceManager		&resManager,
+                    const char			*pMapName,
+                    ResourceBase::Type	type )
+{
+    // try see if we have it loaded already
+    _T	*pMap = (_T *)resManager.FindResource( pMapName, type );
+
+    if ( pMap )
+        return pMap;
+
+    DStr	mapFullPathName = state.FindResFile( pMapName, Options::SEARCHPATH_TEXTURE );
+
+    if ( mapFullPathName.length() )
+    {
+        DUT::MemFile	file;
+        state.GetFileManager().GrabFile( mapFullPathName.c_str(), file );
+
+        pMap = DNEW _T( pMapName, file );
+
+        resManager.AddResource( pMap, state.GetFileManager(), mapFullPathName.c_str() );
+    }
+
+    return pMap;
+}
+
+//==================================================================
+ShadowMap *Attributes::GetShadowMap( const char *pMapName ) const
+{
+    return getMapResource<ShadowMap>(
+                    *mpState,
+                    *mpResManager,
+                    pMapName,
+                    ResourceBase::TYPE_SHADOWMAP );
+}
+
+//==================================================================
+EnvMap *Attributes::GetEnvMap( const char *pMapName ) const
+{
+    return getMapResource<EnvMap>(
+                    *mpState,
+                    *mpResManager,
+                    pMapName,
+                    ResourceBase::TYPE_ENVMAP );
+}
+
 //==================================================================
 }
@@ -0,0 +1,137 @@
+//==================================================================
+/// RI_Commands.cpp
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info.
+//==================================================================
+
+#include "stdafx.h"
+#include "RI_Commands.h"
+
+//==================================================================
+namespace RI
+{
+
+//==================================================================
+static constexpr const char	*_sCmdNames[] =
+{
+#define RI_CMD(_NAME_)	#_NAME_,
+    RI_COMMANDS_LIST
+#undef RI_CMD
+};
+
+static constexpr size_t	_sCmdNameLens[] =
+{
+#define RI_CMD(_NAME_)	sizeof(#_NAME_) - 1,
+    RI_COMMANDS_LIST
+#undef RI_CMD
+};
+
+//==================================================================
+static const u_int	HASH_SLOTS_N = 512;
+
+//==================================================================
+static constexpr U32 hashName( const char *pName, size_t len, U32 seed )
+{
+    // FNV-1a, with the length in the mix
+    U32	h = seed ^ (U32)len;
+
+    for (size_t i=0; i < len; ++i)
+    {
+        h ^= (U8)pName[i];
+        h *= 16777619u;
+    }
+
+    return h ^ (h >> 15);
+}
+
+//==================================================================
+/// Slots hold the command index + 1, 0 is empty
+struct HashTable
+{
+    U32	mSeed;
+    U8	mSlots[HASH_SLOTS_N];
+};
+
+//==================================================================
+/// Tries seeds until no two commands fall in the same slot.
+/// Runs in the compiler, so that the table is just data
+static constexpr HashTable makeHashTable()
+{
+    HashTable	t {};
+
+    for (U32 seed=2166136261u; ; seed += 0x9e3779b9u)
+    {
+        for (u_int i=0; i < HASH_SLOTS_N; ++i)
+            t.mSlots[i] = 0;
+
+        bool	collided = false;
+
+        for (u_int i=0; i < CMDID_N; ++i)
+        {
+            U32 slot = hashName( _sCmdNames[i], _sCmdNameLens[i], seed ) & (HASH_SLOTS_N-1);
+
+            if ( t.mSlots[slot] )
+            {
+                collided = true;
+                break;
+            }
+
+            t.mSlots[slot] = (U8)(i + 1);
+        }
+
+        if NOT( collided )
+        {
+            t.mSeed = seed;
+            return t;
+        }
+    }
+}
+
+static_assert( CMDID_N < 255, "Too many commands for the hash table" );
+
+static constexpr HashTable	_sHashTable = makeHashTable();
+
+//==================================================================
+/// Transformations have always been accepted in any case
+static CmdID findTransformNoCase( const char *pName, size_t nameLen )
+{
+    for (int i=CMDID_Identity; i <= CMDID_Translate; ++i)
+    {
+        if ( _sCmdNameLens[i] == nameLen &&
+             0 == strncasecmp( pName, _sCmdNames[i], nameLen ) )
+            return (CmdID)i;
+    }
+
+    return CMDID_UNKNOWN;
+}
+
+//==================================================================
+CmdID FindCommand( const char *pName, size_t nameLen )
+{
+    U32	slot = hashName( pName, nameLen, _sHashTable.mSeed ) & (HASH_SLOTS_N-1);
+    u_int	idx = _sHashTable.mSlots[ slot ];
+
+    if ( idx )
+    {
+        --idx;
+        if ( _sCmdNameLens[idx] == nameLen &&
+             0 == memcmp( pName, _sCmdNames[idx], nameLen ) )
+            return (CmdID)idx;
+    }
+
+    return findTransformNoCase( pName, nameLen );
+}
+
+//==================================================================
+const char *GetCommandName( CmdID cmdID )
+{
+    if ( cmdID < 0 || cmdID >= CMDID_N )
+        return "UNKNOWN";
+
+    return _sCmdNames[ cmdID ];
+}
+
+//==================================================================
+}
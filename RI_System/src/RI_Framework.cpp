@@ -11,20 +11,30 @@
 #include "RI_Base.h"
 #include "RI_State.h"
 #include "RI_Framework.h"
+#include "RI_Primitive_Instance.h"
+#include "RI_Primitive_Procedural.h"
 //#include <omp.h>
 
 //==================================================================
 namespace RI
 {
 
+// primitives sent to the splitting thread at a time
+static const size_t	SPLIT_BATCH_PRIMS_N = 64;
+
 //==================================================================
 /// Framework
 //==================================================================
 Framework::Framework( const Params &params ) :
     mParams(params),
     mpGlobalSyms(NULL),
-    mHider(*params.mpHiderParams)
+    mHider(*params.mpHiderParams),
+    mpDelayedLoader(NULL),
+    mHasDelayed(false),
+    mSplitTasks(1),
+    mIsSplitting(false)
 {
+    mHider.mpFramework = this;
 }
 
 //==================================================================
@@ -32,8 +42,14 @@ void Framework::WorldBegin(
                         const Options &opt,
                         const Matrix44 &mtxWorldCamera )
 {
+    // anything still splitting from a world block that never ended
+    mSplitTasks.Wait();
+    mpSplitError = nullptr;
+
     mOptions = opt;
     mHider.WorldBegin( opt, mtxWorldCamera );
+
+    mIsSplitting = true;
 }
 
 //==================================================================
@@ -56,7 +72,66 @@ void Framework::Insert(
     //printf( "Prim xform rev %i\n",
     //		mpUniqueTransform.back()->mpRevision->mRTrackRevisionCount );
 
-    mHider.Insert( pPrim );
+    // from a delayed archive, while rendering
+    if NOT( mIsSplitting )
+    {
+        mHider.Insert( pPrim );
+        return;
+    }
+
+    mpSplitBatch.push_back( pPrim->Borrow() );
+
+    if ( mpSplitBatch.size() > SPLIT_BATCH_PRIMS_N )
+        sendSplitBatch( false );
+}
+
+//==================================================================
+/// Send the primitives collected so far to be split in the background.
+/// Unless it's the last batch, the last primitive stays behind, as it
+/// may still get the close key of its MotionBegin/End block
+void Framework::sendSplitBatch( bool isLast )
+{
+    DVec<PrimitiveBase*>	pBatch;
+
+    pBatch.swap( mpSplitBatch );
+
+    if ( !isLast && pBatch.size() )
+    {
+        mpSplitBatch.push_back( pBatch.back() );
+        pBatch.pop_back();
+    }
+
+    if NOT( pBatch.size() )
+        return;
+
+    mSplitTasks.AddTask( [this, pBatch]() { splitBatch( pBatch ); } );
+}
+
+//==================================================================
+/// Simplify and split the batch into the buckets, on the splitting
+/// thread. Instances and delayed archives are set aside for WorldEnd
+void Framework::splitBatch( const DVec<PrimitiveBase*> &pBatch )
+{
+    // failed already ? Then only let go of the rest
+    if ( mpSplitError )
+    {
+        for (size_t i=0; i < pBatch.size(); ++i)
+            pBatch[i]->Release();
+
+        return;
+    }
+
+    try {
+        mHider.mpPrims.insert( mHider.mpPrims.end(), pBatch.begin(), pBatch.end() );
+
+        simplifyPrims();
+        splitAndAddToBuckets();
+    }
+    catch ( ... )
+    {
+        // passed on at WorldEnd
+        mpSplitError = std::current_exception();
+    }
 }
 
 //==================================================================
@@ -92,20 +167,15 @@ static void initAllocPixels(
 }
 
 //==================================================================
-void Framework::RenderBucket_s( Hider &hider, HiderBucket &bucket )
+void Framework::renderPrims_s(
+                    Hider						&hider,
+                    HiderBucket					&bucket,
+                    DVec<SimplePrimitiveBase *>	&pPrimList,
+                    WorkGrid					&workGrid,
+                    DVec<HiderPixel>			&pixels )
 {
-    DVec<SimplePrimitiveBase *>	&pPrimList = bucket.GetPrimList();
-
-    bucket.BeginRender();
-
-    WorkGrid	workGrid( *hider.mpGlobalSyms );
-
     DVec<ShadedGrid>	shadedGrids;
 
-    DVec<HiderPixel>				pixels;
-    DVec<DVec<HiderSampleData> >	sampDataLists;
-    initAllocPixels( pixels, sampDataLists, bucket );
-
     size_t	primsN	= pPrimList.size();
 
     shadedGrids.resize( primsN );
@@ -123,32 +193,226 @@ void Framework::RenderBucket_s( Hider &hider, HiderBucket &bucket )
 
         pPrim->Dice( workGrid, hider.mParams.mDbgColorCodedGrids );
 
-        // should check backface and trim
+        if ( pPrim->IsMoving() )
+            pPrim->DiceMotion( workGrid );
+
         workGrid.Displace( *pPrim->mpAttribs );
+        workGrid.Stitch();
+
+        // nothing left to see ? Then don't even shade it
+        if NOT( hider.CullGrid( bucket, workGrid, *pPrim->mpAttribs ) )
+            continue;
 
-        workGrid.Shade( *pPrim->mpAttribs );
+        // depth maps only need the visible surface, not its color
+        if NOT( hider.IsDepthOnly() )
+            workGrid.Shade( *pPrim->mpAttribs );
 
-        shadedGrids[ i ].Init( workGrid.mPointsN );
+        shadedGrids[ i ].Init( workGrid.mPointsN, workGrid.mIsMoving );
 
         hider.Bust(
                 bucket,
                 shadedGrids[ i ],
                 workGrid,
+                *pPrim->mpAttribs,
                 pixels,
                 hider.mFinalBuff.mWd,
                 hider.mFinalBuff.mHe );
     }
+}
+
+//==================================================================
+void Framework::RenderBucket_s( Hider &hider, HiderBucket &bucket )
+{
+    Framework	&fw = *hider.mpFramework;
+
+    bucket.BeginRender();
+
+    WorkGrid	workGrid( *hider.mpGlobalSyms );
+
+    DVec<HiderPixel>				pixels;
+    DVec<DVec<HiderSampleData> >	sampDataLists;
+    initAllocPixels( pixels, sampDataLists, bucket );
+
+    renderPrims_s( hider, bucket, bucket.GetPrimList(), workGrid, pixels );
+
+    // expand the delayed archives that aren't hidden by what's been
+    // rendered so far, and render what they bring into the bucket
+    DVec<SimplePrimitiveBase *>	pLatePrims;
+
+    while ( fw.mHasDelayed )
+    {
+        float	opaqueDepth = hider.GetOpaqueDepth( pixels, bucket );
+
+        {
+            std::lock_guard<std::mutex>	lock( fw.mBucketsMutex );
+
+            fw.expandVisibleDelayed( bucket, opaqueDepth );
+
+            // released with the others, below
+            bucket.mpPrims.insert( bucket.mpPrims.end(), pLatePrims.begin(), pLatePrims.end() );
+            pLatePrims.clear();
+
+            if NOT( bucket.mpLatePrims.size() )
+            {
+                bucket.mIsDone = true;
+                break;
+            }
+
+            pLatePrims.swap( bucket.mpLatePrims );
+        }
+
+        renderPrims_s( hider, bucket, pLatePrims, workGrid, pixels );
+    }
 
     hider.Hide( pixels, bucket );
 
+    // the last use of the primitives only in this bucket
+    {
+        std::lock_guard<std::mutex>	lock( fw.mBucketsMutex );
+
+        bucket.ReleasePrims();
+    }
+
     bucket.EndRender( hider.mFinalBuff );
 }
 
 //==================================================================
-void Framework::worldEnd_simplify()
+/// Expand the delayed archives of the bucket that are in front of
+/// the opaque depth. Those behind will stay hidden here, as more
+/// geometry can only bring the opaque depth closer
+void Framework::expandVisibleDelayed( HiderBucket &bucket, float opaqueDepth )
+{
+    // more may come, from archives inside the expanded ones
+    for (size_t i=0; i < bucket.mpDelayed.size(); ++i)
+    {
+        DelayedArchive	*pDelayed = (DelayedArchive *)bucket.mpDelayed[i];
+
+        if ( !pDelayed->mIsExpanded && pDelayed->mNearDepth <= opaqueDepth )
+            expandDelayed( pDelayed );
+    }
+
+    for (size_t i=0; i < bucket.mpDelayed.size(); ++i)
+        bucket.mpDelayed[i]->Release();
+
+    bucket.mpDelayed.clear();
+}
+
+//==================================================================
+/// Read the archive and send its primitives to the buckets not yet
+/// done, the same way as at WorldEnd
+void Framework::expandDelayed( DelayedArchive *pDelayed )
+{
+    pDelayed->mIsExpanded = true;
+
+    if NOT( mpDelayedLoader )
+        return;
+
+    mpDelayedLoader->LoadDelayedArchive(
+                        pDelayed->mPathFName.c_str(),
+                        *pDelayed->mpAttribs,
+                        *pDelayed->mpTransform );
+
+    simplifyPrims();
+    splitInstances();
+    splitAndAddToBuckets();
+    placeDelayed();
+}
+
+//==================================================================
+/// Place the delayed archives in the buckets touched by their bound.
+/// Those out of view are simply dropped
+void Framework::placeDelayed()
+{
+    for (size_t di=0; di < mpDelayed.size(); ++di)
+    {
+        DelayedArchive	*pDelayed = mpDelayed[di];
+
+        const Bound		&bound = pDelayed->mBound;
+        const Transform	&xform = *pDelayed->mpTransform;
+
+        int		bound2d[4];
+        float	area = mHider.RasterEstimate( bound, xform.GetMatrix(), bound2d );
+        float	nearDepth = mHider.CameraNearDepth( bound, xform.GetMatrix() );
+        bool	isAcrossEye = mHider.IsAcrossEyePlane( bound, xform.GetMatrix() );
+
+        if ( xform.IsMoving() )
+        {
+            int		boundClose2d[4];
+            float	areaClose = mHider.RasterEstimate( bound, xform.GetMatrixClose(), boundClose2d );
+
+            if ( area < RI_EPSILON )
+            {
+                for (size_t i=0; i < 4; ++i)
+                    bound2d[i] = boundClose2d[i];
+            }
+            else
+            if ( areaClose >= RI_EPSILON )
+            {
+                bound2d[0] = DMIN( bound2d[0], boundClose2d[0] );
+                bound2d[1] = DMIN( bound2d[1], boundClose2d[1] );
+                bound2d[2] = DMAX( bound2d[2], boundClose2d[2] );
+                bound2d[3] = DMAX( bound2d[3], boundClose2d[3] );
+            }
+
+            area		= DMAX( area, areaClose );
+            nearDepth	= DMIN( nearDepth, mHider.CameraNearDepth( bound, xform.GetMatrixClose() ) );
+            isAcrossEye	= isAcrossEye || mHider.IsAcrossEyePlane( bound, xform.GetMatrixClose() );
+        }
+
+        // reaching behind the eye, it could land anywhere
+        if ( isAcrossEye )
+        {
+            bound2d[0] = 0;
+            bound2d[1] = 0;
+            bound2d[2] = (int)mOptions.mXRes;
+            bound2d[3] = (int)mOptions.mYRes;
+            area = 1;
+        }
+
+        if ( area >= RI_EPSILON && mHider.IsInCrop( bound2d ) )
+        {
+            pDelayed->mNearDepth = nearDepth;
+
+            for (size_t bi=0; bi < mHider.mpBuckets.size(); ++bi)
+            {
+                HiderBucket	&buck = *mHider.mpBuckets[bi];
+
+                if ( !buck.mIsDone &&
+                     buck.Intersects( bound2d[0], bound2d[1], bound2d[2], bound2d[3] ) )
+                    buck.mpDelayed.push_back( (ComplexPrimitiveBase *)pDelayed->Borrow() );
+            }
+        }
+
+        pDelayed->Release();
+    }
+
+    mpDelayed.clear();
+}
+
+//==================================================================
+/// Split what's left of the world block, and wait for it
+void Framework::worldEnd_finishSplitting()
 {
     DUT::QuickProf	prof( __FUNCTION__ );
 
+    sendSplitBatch( true );
+
+    mSplitTasks.Wait();
+
+    mIsSplitting = false;
+
+    if ( mpSplitError )
+    {
+        std::exception_ptr	pError = mpSplitError;
+        mpSplitError = nullptr;
+
+        std::rethrow_exception( pError );
+    }
+}
+
+//==================================================================
+void Framework::simplifyPrims()
+{
     // --- convert complex primitives into simple ones
     for (size_t i=0; i < mHider.mpPrims.size(); ++i)
     {
@@ -156,7 +420,23 @@ void Framework::worldEnd_simplify()
 
         if ( pPrim->IsComplex() )
         {
-            ((ComplexPrimitiveBase *)pPrim)->Simplify( mHider );
+            // instances are expanded in worldEnd_splitInstances()
+            if ( pPrim->mType == PrimitiveBase::OBJECTINSTANCE )
+            {
+                mpInstances.push_back( (ObjectInstance *)pPrim );
+                mHider.mpPrims[i] = NULL;
+                continue;
+            }
+
+            // delayed archives are placed in placeDelayed()
+            if ( pPrim->mType == PrimitiveBase::DELAYEDARCHIVE )
+            {
+                mpDelayed.push_back( (DelayedArchive *)pPrim );
+                mHider.mpPrims[i] = NULL;
+                continue;
+            }
+
+            simplifyPrim( (ComplexPrimitiveBase *)pPrim );
             pPrim->Release();
             mHider.mpPrims[i] = NULL;
             // could compact mHider.mpPrims as it goes..
@@ -164,11 +444,252 @@ void Framework::worldEnd_simplify()
     }
 }
 
+//==================================================================
+/// Simplify into the hider. A deforming primitive also simplifies its
+/// last motion key, and each of the resulting primitives is paired with
+/// its counterpart
+void Framework::simplifyPrim( ComplexPrimitiveBase *pPrim )
+{
+    size_t	prevN = mHider.mpPrims.size();
+
+    ComplexPrimitiveBase	*pClose = (ComplexPrimitiveBase *)pPrim->mpMotionClose;
+
+    if ( pClose )
+    {
+        pPrim->mIsMotionKey = true;
+        pClose->mIsMotionKey = true;
+    }
+
+    pPrim->Simplify( mHider );
+
+    if NOT( pClose )
+        return;
+
+    size_t	openN = mHider.mpPrims.size();
+
+    pClose->CopyStates( *pPrim );
+    pClose->Simplify( mHider );
+
+    size_t	closeN = mHider.mpPrims.size() - openN;
+
+    // keys that don't match simply won't deform
+    bool	isMatch = (closeN == (openN - prevN));
+
+    for (size_t j=0; j < closeN; ++j)
+    {
+        PrimitiveBase	*pClosePrim	= mHider.mpPrims[ openN + j ];
+
+        if ( isMatch && mHider.mpPrims[ prevN + j ]->mType == pClosePrim->mType )
+            mHider.mpPrims[ prevN + j ]->SetMotionClose( pClosePrim, pPrim->mMotionBlend );
+
+        pClosePrim->Release();
+    }
+
+    mHider.mpPrims.resize( openN );
+}
+
+//==================================================================
+/// Simplify the primitives of an object definition, once and in the
+/// object's space
+void Framework::simplifyObjectDef( ObjectDef &objDef )
+{
+    if ( objDef.mIsSimplified )
+        return;
+
+    objDef.mIsSimplified = true;
+
+    for (size_t i=0; i < objDef.mpPrims.size(); ++i)
+    {
+        PrimitiveBase	*pPrim = objDef.mpPrims[i];
+
+        if NOT( pPrim->IsComplex() )
+        {
+            objDef.AddSimplified( (SimplePrimitiveBase *)pPrim->Borrow() );
+            continue;
+        }
+
+        // take back what the primitive adds to the hider
+        size_t	prevN = mHider.mpPrims.size();
+
+        simplifyPrim( (ComplexPrimitiveBase *)pPrim );
+
+        for (size_t j=prevN; j < mHider.mpPrims.size(); ++j)
+            objDef.AddSimplified( (SimplePrimitiveBase *)mHider.mpPrims[j] );
+
+        mHider.mpPrims.resize( prevN );
+    }
+}
+
+//==================================================================
+/// Split the primitives down to the dicing size, without culling.
+/// Takes the references in pWorkPrims, and gives back the leaves
+void Framework::splitToLeaves(
+                    DVec<SimplePrimitiveBase *>	&pWorkPrims,
+                    DVec<SimplePrimitiveBase *>	&out_pLeaves )
+{
+    // same order as worldEnd_splitAndAddToBuckets()
+    for (size_t i=0; i < pWorkPrims.size(); ++i)
+    {
+        SimplePrimitiveBase	*pPrim = pWorkPrims[i];
+
+        int		bound2d[4];
+        float	pixelArea = pPrim->RasterEstimate( mHider, bound2d );
+
+        bool	uSplit;
+        bool	vSplit;
+        if ( pPrim->CheckDiceOrSplit( mHider, pixelArea, uSplit, vSplit )
+                == SimplePrimitiveBase::CHECKSPLITRES_DICE )
+        {
+            out_pLeaves.push_back( pPrim );
+            continue;
+        }
+
+        size_t	prevN = mHider.mpPrims.size();
+
+        pPrim->Split( mHider, uSplit, vSplit );
+
+        for (size_t j=prevN; j < mHider.mpPrims.size(); ++j)
+            pWorkPrims.push_back( (SimplePrimitiveBase *)mHider.mpPrims[j] );
+
+        mHider.mpPrims.resize( prevN );
+
+        pPrim->Release();
+    }
+
+    pWorkPrims.clear();
+}
+
+//==================================================================
+void Framework::worldEnd_splitInstances()
+{
+    DUT::QuickProf	prof( __FUNCTION__ );
+
+    splitInstances();
+}
+
+//==================================================================
+/// Place the objects' primitives for every instance.
+/// Instances of the same object at a similar size on screen share
+/// the split results, and only go through bounding and bucketing.
+/// The split results are kept with the object, for the next frames
+void Framework::splitInstances()
+{
+    DVec<Transform *>	pXForms;
+
+    for (size_t ii=0; ii < mpInstances.size(); ++ii)
+    {
+        ObjectInstance	*pInst = mpInstances[ii];
+        ObjectDef		&objDef = *pInst->mpObjectDef;
+
+        simplifyObjectDef( objDef );
+
+        // the object's transformations, placed by the instance
+        const Matrix44 &mtxInst = pInst->mpTransform->GetMatrix();
+        const Matrix44 &mtxInstClose = pInst->mpTransform->GetMatrixClose();
+
+        pXForms.resize( objDef.mpUniqueTransform.size() );
+        for (size_t k=0; k < pXForms.size(); ++k)
+        {
+            pXForms[k] = DNEW Transform(
+                            objDef.mpUniqueTransform[k]->GetMatrix() * mtxInst,
+                            objDef.mpUniqueTransform[k]->GetMatrixClose() * mtxInstClose );
+            mpUniqueTransform.push_back( pXForms[k] );
+        }
+
+        int		bound2d[4];
+        float	objArea = 0;
+        if ( objDef.mBound.IsValid() )
+            objArea = mHider.RasterEstimate( objDef.mBound, mtxInst, bound2d );
+
+        // unknown size on screen (or not visible).. go through the
+        // normal splitting
+        if ( objArea < RI_EPSILON )
+        {
+            for (size_t i=0; i < objDef.mpSimplePrims.size(); ++i)
+            {
+                SimplePrimitiveBase	*pPrim = objDef.mpSimplePrims[i]->Clone();
+                pPrim->SetStates( pInst->mpAttribs, pXForms[ objDef.mSimplePrimXFormIdx[i] ] );
+                mHider.mpPrims.push_back( pPrim->Borrow() );
+            }
+
+            pInst->Release();
+            continue;
+        }
+
+        // half octave steps of screen area
+        int		sizeKey		= (int)floorf( 2 * logf( objArea ) / logf( 2.f ) );
+        float	shadingRate	= pInst->mpAttribs->mShadingRate;
+
+        DVec<ObjectDef::SplitCache>	&caches = objDef.mSplitCaches;
+
+        size_t	ci = 0;
+        for (; ci < caches.size(); ++ci)
+        {
+            if ( caches[ci].mSizeKey	== sizeKey &&
+                 caches[ci].mShadingRate	== shadingRate )
+                break;
+        }
+
+        // first at this size ? Then split it for real
+        if ( ci == caches.size() )
+        {
+            ObjectDef::SplitCache	&cache = Dgrow( caches );
+            cache.mSizeKey		= sizeKey;
+            cache.mShadingRate	= shadingRate;
+
+            DVec<SimplePrimitiveBase *>	pWorkPrims;
+            for (size_t i=0; i < objDef.mpSimplePrims.size(); ++i)
+            {
+                SimplePrimitiveBase	*pPrim = objDef.mpSimplePrims[i]->Clone();
+                pPrim->SetStates( pInst->mpAttribs, pXForms[ objDef.mSimplePrimXFormIdx[i] ] );
+                pWorkPrims.push_back( (SimplePrimitiveBase *)pPrim->Borrow() );
+            }
+
+            splitToLeaves( pWorkPrims, cache.mpLeaves );
+
+            for (size_t j=0; j < cache.mpLeaves.size(); ++j)
+            {
+                u_int	xformIdx = 0;
+                while ( pXForms[ xformIdx ] != cache.mpLeaves[j]->mpTransform )
+                    xformIdx += 1;
+
+                cache.mLeafXFormIdx.push_back( xformIdx );
+            }
+        }
+
+        const ObjectDef::SplitCache	&cache = caches[ci];
+
+        for (size_t j=0; j < cache.mpLeaves.size(); ++j)
+        {
+            SimplePrimitiveBase	*pPrim = cache.mpLeaves[j]->Clone();
+            pPrim->SetStates( pInst->mpAttribs, pXForms[ cache.mLeafXFormIdx[j] ] );
+            pPrim->Borrow();
+
+            float	pixelArea = pPrim->RasterEstimate( mHider, bound2d );
+
+            if ( pixelArea >= RI_EPSILON )
+                mHider.InsertForDicing( pPrim, bound2d );
+
+            pPrim->Release();
+        }
+
+        pInst->Release();
+    }
+
+    mpInstances.clear();
+}
+
 //==================================================================
 void Framework::worldEnd_splitAndAddToBuckets()
 {
     DUT::QuickProf	prof( __FUNCTION__ );
 
+    splitAndAddToBuckets();
+}
+
+//==================================================================
+void Framework::splitAndAddToBuckets()
+{
     // --- split primitives and assign to buckets for dicing
     for (size_t i=0; i < mHider.mpPrims.size(); ++i)
     {
@@ -187,6 +708,13 @@ void Framework::worldEnd_splitAndAddToBuckets()
                                             uSplit,
                                             vSplit );
 
+        // out of the crop window ? No need to split it
+        if ( dosRes != SimplePrimitiveBase::CHECKSPLITRES_CULL &&
+             NOT( mHider.IsInCrop( bound2d ) ) )
+        {
+            dosRes = SimplePrimitiveBase::CHECKSPLITRES_CULL;
+        }
+
         if ( dosRes == SimplePrimitiveBase::CHECKSPLITRES_DICE )
         {
             mHider.InsertForDicing( (SimplePrimitiveBase *)pPrim, bound2d );
@@ -208,9 +736,21 @@ void Framework::worldEnd_splitAndAddToBuckets()
 void Framework::worldEnd_setupDisplays()
 {
     //--- setup the displays by assigning or creating display drivers
-    for (size_t i=0; i < mOptions.mpDisplays.size(); ++i)
+    for (size_t i=0; i < mOptions.moDisplays.size(); ++i)
     {
-        Options::Display	&disp = *mOptions.mpDisplays[i];
+        Options::Display	&disp = *mOptions.moDisplays[i];
+
+        // depth maps also carry the camera used to render them
+        if ( disp.IsZFile() )
+        {
+            if NOT( mHider.IsDepthOnly() )
+                DEX_RUNTIME_ERROR(
+                    "The zfile display '%s' can't be mixed with color displays",
+                    disp.mName.c_str() );
+
+            disp.mMtxWorldCamera	= mHider.mMtxWorldCamera;
+            disp.mMtxWorldProj		= mHider.mMtxWorldProj;
+        }
 
         const char *pDispMode = disp.mMode.c_str();
 
@@ -290,14 +830,25 @@ void Framework::WorldEnd()
 
 #endif
 
-    worldEnd_simplify();
+    worldEnd_finishSplitting();
+
+    worldEnd_splitInstances();
 
     worldEnd_splitAndAddToBuckets();
 
+    placeDelayed();
+
+    // buckets will need to check for delayed archives
+    for (size_t bi=0; bi < mHider.mpBuckets.size(); ++bi)
+        if ( mHider.mpBuckets[ bi ]->mpDelayed.size() )
+            mHasDelayed = true;
+
     try {
 
         worldEnd_setupDisplays();
 
+        mHider.mIsRendering = true;
+
         // render the buckets..
         if ( mParams.mpRenderBuckets )
         {
@@ -310,19 +861,12 @@ void Framework::WorldEnd()
             rendBuck.Render( mHider );
         }
 
-        // --- release the primitives in all the buckets
+        mHider.mIsRendering = false;
+        mHasDelayed = false;
+
+        // --- release the primitives left in buckets not rendered here
         for (size_t bi=0; bi < mHider.mpBuckets.size(); ++bi)
-        {
-            DVec<SimplePrimitiveBase *>	&pPrimList = mHider.mpBuckets[ bi ]->GetPrimList();
-            for (size_t i=0; i < pPrimList.size(); ++i)
-            {
-                if ( pPrimList[i] )
-                {
-                    pPrimList[i]->Release();
-                    pPrimList[i] = NULL;
-                }
-            }
-        }
+            mHider.mpBuckets[ bi ]->ReleasePrims();
 
         for (size_t i=0; i < mpUniqueAttribs.size(); ++i)	DDELETE( mpUniqueAttribs[i] );
         for (size_t i=0; i < mpUniqueTransform.size(); ++i)	DDELETE( mpUniqueTransform[i] );
@@ -338,9 +882,9 @@ void Framework::WorldEnd()
                     "rgba",	// depends on NOUTCOLS too !
                     (const U8 *)mHider.GetOutputData(0,0) );
 
-        for (size_t i=0; i < mOptions.mpDisplays.size(); ++i)
+        for (size_t i=0; i < mOptions.moDisplays.size(); ++i)
         {
-            Options::Display	&disp = *mOptions.mpDisplays[i];
+            Options::Display	&disp = *mOptions.moDisplays[i];
 
             DIMG::ConvertImages( disp.mImage, hiderImg );
         }
@@ -349,6 +893,9 @@ void Framework::WorldEnd()
     }
     catch ( ... )
     {
+        mHider.mIsRendering = false;
+        mHasDelayed = false;
+
         // free the displays anyway !
         mOptions.FreeDisplays();
         throw;
@@ -359,20 +906,29 @@ void Framework::WorldEnd()
 #if defined(DEBUG) || defined(_DEBUG)
 void Framework::Dbg_MarkLastPrim( const char *pSrcFileName, int srcLine )
 {
-    mHider.mpPrims.back()->mDbg_SrcLine = srcLine;
+    // the hider's primitives belong to the splitting thread
+    DVec<PrimitiveBase*>	&pPrims = mIsSplitting ? mpSplitBatch : mHider.mpPrims;
+
+    // went into an object definition ?
+    if NOT( pPrims.size() )
+        return;
+
+    PrimitiveBase	*pLastPrim = pPrims.back();
+
+    pLastPrim->mDbg_SrcLine = srcLine;
 
     for (size_t i=0; i < mDbg_SrcFileNames.size(); ++i)
     {
         const char *pStr = mDbg_SrcFileNames[i].c_str();
         if ( 0 == strcasecmp( pStr, pSrcFileName ) )
         {
-            mHider.mpPrims.back()->mpDbg_SrcArchive = pStr;
+            pLastPrim->mpDbg_SrcArchive = pStr;
             return;
         }
     }
 
     mDbg_SrcFileNames.push_back( pSrcFileName );
-    mHider.mpPrims.back()->mpDbg_SrcArchive = mDbg_SrcFileNames.back().c_str();
+    pLastPrim->mpDbg_SrcArchive = mDbg_SrcFileNames.back().c_str();
 }
 #endif
 
@@ -35,8 +35,16 @@ static void MakeCube( const Bound &b, Float3 out_box[8] )
 //==================================================================
 Hider::Hider( const Params &params ) :
     mParams(params),
-    mpGlobalSyms(NULL)
+    mpGlobalSyms(NULL),
+    mDepthOnly(false),
+    mIsPerspective(false),
+    mHasDOF(false),
+    mFocalDistance(0),
+    mCoCScale(0,0),
+    mpFramework(NULL),
+    mIsRendering(false)
 {
+    mCrop[0] = mCrop[1] = mCrop[2] = mCrop[3] = 0;
 }
 
 //==================================================================
@@ -60,7 +68,8 @@ HiderSampleCoordsBuffer *Hider::findOrAddSampCoordBuff( u_int wd, u_int he, u_in
         if NOT( mSampCoordBuffs[i].IsInitialized() )
         {
             mSampCoordBuffs[i].Init( wd, he, subPixelDimLog2 );
-            mSampCoordBuffs[i].Setup( 0, 0 );
+            // times go from shutter open to close
+            mSampCoordBuffs[i].Setup( 0, 1 );
             return &mSampCoordBuffs[i];
         }
 
@@ -97,6 +106,37 @@ static u_int findClosestSquareAreaLog2Dim( int dimX, int dimY )
     return subPixDimLog2;
 }
 
+//==================================================================
+/// Thin lens model. A point at depth z seen from the lens position L
+/// lands on screen where the pinhole sees it, plus L * (1/D - 1/z)
+/// (D being the focal distance), scaled by the projection
+void Hider::setupDOF( const Options &opt )
+{
+    mHasDOF = false;
+
+    if ( opt.mFStop >= RI_INFINITY ||
+         opt.mFStop <= 0 ||
+         opt.mFocalLength <= 0 ||
+         opt.mFocalDistance <= 0 ||
+         NOT( mIsPerspective ) )
+        return;
+
+    float	lensRadius = opt.mFocalLength / (2 * opt.mFStop);
+
+    mHasDOF			= true;
+    mFocalDistance	= opt.mFocalDistance;
+    mCoCScale[0]	=  lensRadius * opt.mMtxCamProj.mij(0,0) * (float)opt.mXRes * 0.5f;
+    mCoCScale[1]	= -lensRadius * opt.mMtxCamProj.mij(1,1) * (float)opt.mYRes * 0.5f;
+}
+
+//==================================================================
+/// Pixels range of the crop window, as in the RI spec
+static void makeCropRange( int res, float minF, float maxF, int &out_x1, int &out_x2 )
+{
+    out_x1 = DClamp( (int)ceilf( res * minF ), 0, res - 1 );
+    out_x2 = DClamp( (int)ceilf( res * maxF - 1 ), 0, res - 1 ) + 1;
+}
+
 //==================================================================
 void Hider::WorldBegin(
                     const Options &opt,
@@ -106,10 +146,20 @@ void Hider::WorldBegin(
 
     mMtxWorldCamera	= mtxWorldCamera;
     mMtxWorldProj	= mMtxWorldCamera * opt.mMtxCamProj;
+
+    mDepthOnly		= opt.IsDepthOnly();
+
+    mIsPerspective	= opt.mpyProjection && opt.mpyProjection->IsName( RI_PERSPECTIVE );
+
+    setupDOF( opt );
     
+    // the output stays full size, with only the crop window rendered
     mFinalBuff.Setup( opt.mXRes, opt.mYRes );
     mFinalBuff.Clear();
 
+    makeCropRange( opt.mXRes, opt.mXMin, opt.mXMax, mCrop[0], mCrop[2] );
+    makeCropRange( opt.mYRes, opt.mYMin, opt.mYMax, mCrop[1], mCrop[3] );
+
     u_int subPixDimLog2 =
             findClosestSquareAreaLog2Dim(
                     opt.mPixSamples[0],
@@ -120,15 +170,16 @@ void Hider::WorldBegin(
     mpBuckets.push_back(
             DNEW Bucket( 0, 0, opt.mXRes, opt.mYRes ) );
 #else
-    for (int y=0; y < opt.mYRes; y += BUCKET_SIZE)
+    // pixels are box filtered, no need for a guard band around the crop
+    for (int y=mCrop[1]; y < mCrop[3]; y += BUCKET_SIZE)
     {
         int	y2 = y + BUCKET_SIZE;
-        y2 = DMIN( y2, opt.mYRes );
+        y2 = DMIN( y2, mCrop[3] );
 
-        for (int x=0; x < opt.mXRes; x += BUCKET_SIZE)
+        for (int x=mCrop[0]; x < mCrop[2]; x += BUCKET_SIZE)
         {
             int	x2 = x + BUCKET_SIZE;
-            x2 = DMIN( x2, opt.mXRes );
+            x2 = DMIN( x2, mCrop[2] );
 
             if ( mParams.mDbgOnlyBucketAtX == -1 ||
                  (mParams.mDbgOnlyBucketAtX >= x &&
@@ -182,10 +233,19 @@ void Hider::InsertForDicing( SimplePrimitiveBase *pPrim, const int bound2d[2] )
 {
     for (size_t i=0; i < mpBuckets.size(); ++i)
     {
-        if ( mpBuckets[i]->Intersects( bound2d[0], bound2d[1], bound2d[2], bound2d[3] ) )
+        HiderBucket	&buck = *mpBuckets[i];
+
+        if NOT( buck.Intersects( bound2d[0], bound2d[1], bound2d[2], bound2d[3] ) )
+            continue;
+
+        // from a delayed archive, expanded while rendering
+        if ( mIsRendering )
         {
-            mpBuckets[i]->mpPrims.push_back( (SimplePrimitiveBase *)pPrim->Borrow() );
+            if NOT( buck.mIsDone )
+                buck.mpLatePrims.push_back( (SimplePrimitiveBase *)pPrim->Borrow() );
         }
+        else
+            buck.mpPrims.push_back( (SimplePrimitiveBase *)pPrim->Borrow() );
     }
 }
 
@@ -286,6 +346,31 @@ bool Hider::makeRasterBound(
     if ( andCode )
         return false;
 
+    // out of focus points may land anywhere in their circle of confusion
+    if ( mHasDOF )
+    {
+        Matrix44	mtxLocalCamera = mtxLocalWorld * mMtxWorldCamera;
+
+        float	maxCoC = 0;
+        for (size_t i=0; i < 8; ++i)
+        {
+            float	z = V3__V3W1_Mul_M44<float>( boxVerts[i], mtxLocalCamera ).z();
+
+            // points in front of the near plane would blow up the reciprocal
+            z = DMAX( z, mOptions.mNearClip );
+
+            maxCoC = DMAX( maxCoC, DAbs( 1.0f / mFocalDistance - 1.0f / z ) );
+        }
+
+        float	cocX = maxCoC * DAbs( mCoCScale[0] );
+        float	cocY = maxCoC * DAbs( mCoCScale[1] );
+
+        minX -= cocX;
+        maxX += cocX;
+        minY -= cocY;
+        maxY += cocY;
+    }
+
     out_bound2d[0] = minX;
     out_bound2d[1] = minY;
     out_bound2d[2] = maxX;
@@ -299,6 +384,12 @@ float Hider::RasterEstimate( const Bound &b, const Matrix44 &mtxLocalWorld, int
 {
     if NOT( b.IsValid() )
     {
+        // could be anywhere
+        out_box2D[0] = 0;
+        out_box2D[1] = 0;
+        out_box2D[2] = (int)mOptions.mXRes;
+        out_box2D[3] = (int)mOptions.mYRes;
+
         return MP_GRID_MAX_SIZE / 4;
     }
 
@@ -320,6 +411,127 @@ float Hider::RasterEstimate( const Bound &b, const Matrix44 &mtxLocalWorld, int
         return 0.0f;	// invalid or zero area...
 }
 
+//==================================================================
+/// Area in pixels of the raster bound, not clipped to the screen. A
+/// bound reaching behind the eye is infinitely large
+float Hider::RasterDetail( const Bound &b, const Matrix44 &mtxLocalWorld ) const
+{
+    if NOT( b.IsValid() )
+        return RI_INFINITY;
+
+    Float3	boxVerts[8];
+    MakeCube( b, boxVerts );
+
+    Matrix44	mtxLocalProj = mtxLocalWorld * mMtxWorldProj;
+
+    float	destHalfWd	= (float)mOptions.mXRes * 0.5f;
+    float	destHalfHe	= (float)mOptions.mYRes * 0.5f;
+
+    float	minX =  FLT_MAX;
+    float	minY =  FLT_MAX;
+    float	maxX = -FLT_MAX;
+    float	maxY = -FLT_MAX;
+
+    for (size_t i=0; i < 8; ++i)
+    {
+        Float4	Pproj = V4__V3W1_Mul_M44<float>( boxVerts[i], mtxLocalProj );
+
+        if ( Pproj.w() <= 0 )
+            return RI_INFINITY;
+
+        float	oow = 1.0f / Pproj.w();
+
+        float	winX = destHalfWd * Pproj.x() * oow;
+        float	winY = destHalfHe * Pproj.y() * oow;
+
+        minX = DMIN( minX, winX );
+        minY = DMIN( minY, winY );
+        maxX = DMAX( maxX, winX );
+        maxY = DMAX( maxY, winY );
+    }
+
+    return (maxX - minX) * (maxY - minY);
+}
+
+//==================================================================
+/// Nearest depth of the bound in camera space, as the samples' depth
+float Hider::CameraNearDepth( const Bound &b, const Matrix44 &mtxLocalWorld ) const
+{
+    if NOT( b.IsValid() )
+        return -FLT_MAX;
+
+    Float3	boxVerts[8];
+    MakeCube( b, boxVerts );
+
+    Matrix44	mtxLocalCamera = mtxLocalWorld * mMtxWorldCamera;
+
+    float	nearDepth = FLT_MAX;
+    for (size_t i=0; i < 8; ++i)
+    {
+        float	z = V3__V3W1_Mul_M44<float>( boxVerts[i], mtxLocalCamera ).z();
+
+        nearDepth = DMIN( nearDepth, z );
+    }
+
+    return nearDepth;
+}
+
+//==================================================================
+/// Partly in front and partly behind the eye plane. RasterEstimate()
+/// can't tell where such a bound lands on screen
+bool Hider::IsAcrossEyePlane( const Bound &b, const Matrix44 &mtxLocalWorld ) const
+{
+    if NOT( b.IsValid() )
+        return false;
+
+    Float3	boxVerts[8];
+    MakeCube( b, boxVerts );
+
+    Matrix44	mtxLocalProj = mtxLocalWorld * mMtxWorldProj;
+
+    size_t	frontN = 0;
+    for (size_t i=0; i < 8; ++i)
+    {
+        if ( V4__V3W1_Mul_M44<float>( boxVerts[i], mtxLocalProj ).w() > 0 )
+            ++frontN;
+    }
+
+    return frontN != 0 && frontN != 8;
+}
+
+//==================================================================
+/// project local space points to window coordinates. Returns false
+/// if any of the points is on or behind the eye plane
+bool Hider::RasterProject(
+                const Float3 *pPoints,
+                size_t ptsN,
+                const Matrix44 &mtxLocalWorld,
+                Float2 *out_pWinPoints ) const
+{
+    float destHalfWd	= (float)mOptions.mXRes * 0.5f;
+    float destHalfHe	= (float)mOptions.mYRes * 0.5f;
+
+    Matrix44	mtxLocalProj = mtxLocalWorld * mMtxWorldProj;
+
+    for (size_t i=0; i < ptsN; ++i)
+    {
+        Float4	Pproj = V4__V3W1_Mul_M44<float>( pPoints[i], mtxLocalProj );
+
+        float	w = Pproj.w();
+
+        if ( w <= 0 )
+            return false;
+
+        float	oow = 1.0f / w;
+
+        out_pWinPoints[i] = Float2(
+                        destHalfWd + destHalfWd * Pproj.x() * oow,
+                        destHalfHe - destHalfHe * Pproj.y() * oow );
+    }
+
+    return true;
+}
+
 /*
 //==================================================================
 SlScalar Hider::RasterLengthSqr(
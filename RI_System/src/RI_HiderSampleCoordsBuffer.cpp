@@ -44,6 +44,9 @@ void HiderSampleCoordsBuffer::Init( u_int wd, u_int he, u_int subPixelDimLog2 )
     mpBaseSampCoords = DNEW HiderBaseSampleCoords [ sampArrSize ];
 
     DUT::RandMT	randGen( (U32)0x11112222 );
+    DUT::RandMT	randTimeGen( (U32)0x33334444 );
+    DUT::RandMT	randLensGen( (U32)0x55556666 );
+    DUT::RandMT	randDissolveGen( (U32)0x77778888 );
 
     size_t sampsCnt = 0;
     for (u_int y=0; y < mHe; ++y)
@@ -54,7 +57,10 @@ void HiderSampleCoordsBuffer::Init( u_int wd, u_int he, u_int subPixelDimLog2 )
                 mpSampCoords + sampsCnt,
                 mpBaseSampCoords + sampsCnt,
                 subPixelDimLog2,
-                randGen );
+                randGen,
+                randTimeGen,
+                randLensGen,
+                randDissolveGen );
         }
     }
 }
@@ -85,7 +91,10 @@ void HiderSampleCoordsBuffer::initPixel(
                 HiderSampleCoords		*pSampCoods,
                 HiderBaseSampleCoords	*pBaseSampleCoords,
                 u_int					subPixelDimLog2,
-                DUT::RandMT				&randGen )
+                DUT::RandMT				&randGen,
+                DUT::RandMT				&randTimeGen,
+                DUT::RandMT				&randLensGen,
+                DUT::RandMT				&randDissolveGen )
 {
     u_int subPixelDim = 1 << subPixelDimLog2;
     u_int randPosMask = (1 << subPixelDimLog2) - 1;
@@ -136,7 +145,7 @@ void HiderSampleCoordsBuffer::initPixel(
         {
             u_int idx = (y << subPixelDimLog2) + x;
 
-            float t = timeRun + randGen.randomMT() / (float)((U32)-1);
+            float t = timeRun + dtime * (randGen.randomMT() / (float)((U32)-1));
             
             pSampCoods[ idx ].mTime			= 0;
             pBaseSampleCoords[ idx ].mTime	= t;
@@ -145,15 +154,77 @@ void HiderSampleCoordsBuffer::initPixel(
         }
     }
 
+    // shuffle the time strata, or they'd follow the sub-pixel rows
+    for (u_int i=subPixelDim2-1; i > 0; --i)
+    {
+        u_int	k = randTimeGen.randomMT() % (i+1);
+
+        float	t = pBaseSampleCoords[ i ].mTime;
+        pBaseSampleCoords[ i ].mTime = pBaseSampleCoords[ k ].mTime;
+        pBaseSampleCoords[ k ].mTime = t;
+    }
+
+    // lens, jittered in strata of the unit square..
     for (u_int y=0; y < subPixelDim; ++y)
     {
         for (u_int x=0; x < subPixelDim; ++x)
         {
             u_int idx = (y << subPixelDimLog2) + x;
 
-            pSampCoods[ idx ].mLensX	= 0;
-            pSampCoods[ idx ].mLensY	= 0;
+            pSampCoods[ idx ].mLensX = (x + randLensGen.randomMT() / (float)((U32)-1)) * coe;
+            pSampCoods[ idx ].mLensY = (y + randLensGen.randomMT() / (float)((U32)-1)) * coe;
+        }
+    }
+
+    // ..not related to the sub-pixel position
+    for (u_int i=subPixelDim2-1; i > 0; --i)
+    {
+        u_int	k = randLensGen.randomMT() % (i+1);
+
+        float	lx = pSampCoods[ i ].mLensX;
+        float	ly = pSampCoods[ i ].mLensY;
+        pSampCoods[ i ].mLensX = pSampCoods[ k ].mLensX;
+        pSampCoods[ i ].mLensY = pSampCoods[ k ].mLensY;
+        pSampCoods[ k ].mLensX = lx;
+        pSampCoods[ k ].mLensY = ly;
+    }
+
+    // ..and mapped to the unit disk (concentric mapping)
+    for (u_int i=0; i < subPixelDim2; ++i)
+    {
+        float	a = 2 * pSampCoods[i].mLensX - 1;
+        float	b = 2 * pSampCoods[i].mLensY - 1;
+
+        float	r	= 0;
+        float	phi	= 0;
+
+        if ( a*a > b*b )
+        {
+            r	= a;
+            phi	= (FM_PI / 4) * (b / a);
         }
+        else
+        if ( b != 0 )
+        {
+            r	= b;
+            phi	= (FM_PI / 2) - (FM_PI / 4) * (a / b);
+        }
+
+        pSampCoods[i].mLensX = r * cosf( phi );
+        pSampCoods[i].mLensY = r * sinf( phi );
+    }
+
+    // dissolve values, stratified and shuffled like the times
+    for (u_int i=0; i < subPixelDim2; ++i)
+        pSampCoods[i].mDissolve = (i + randDissolveGen.randomMT() / (float)((U32)-1)) / subPixelDim2;
+
+    for (u_int i=subPixelDim2-1; i > 0; --i)
+    {
+        u_int	k = randDissolveGen.randomMT() % (i+1);
+
+        float	d = pSampCoods[ i ].mDissolve;
+        pSampCoods[ i ].mDissolve = pSampCoods[ k ].mDissolve;
+        pSampCoods[ k ].mDissolve = d;
     }
 }
 
@@ -106,6 +106,26 @@ inline void filterPixelBox(
     pixCol = pixCol * ooSampsPerPixel;
 }
 
+//==================================================================
+// nearest depth among the pixel samples, a la "min" depth filter
+inline float filterPixelDepthMin(
+                const HiderPixel	&pixel,
+                u_int				sampsPerPixel )
+{
+    float	minDepth = FLT_MAX;
+
+    for (u_int si=0; si < sampsPerPixel; ++si)
+    {
+        const DVec<HiderSampleData> &sampDataList = pixel.mpSampDataLists[si];
+
+        // only the nearest one is stored when rendering depth
+        if ( sampDataList.size() && sampDataList[0].mDepth < minDepth )
+            minDepth = sampDataList[0].mDepth;
+    }
+
+    return minDepth;
+}
+
 //==================================================================
 void Hider::Hide(
                 DVec<HiderPixel>	&pixels,
@@ -129,6 +149,22 @@ void Hider::Hide(
     u_int	buckHe = buck.GetHe();
 
     size_t	pixIdx = 0;
+
+    if ( mDepthOnly )
+    {
+        for (u_int y=0; y < buckHe; ++y)
+        {
+            for (u_int x=0; x < buckWd; ++x, ++pixIdx)
+            {
+                Float4	pixDepth( filterPixelDepthMin( pixels[pixIdx], sampsPerPixel ), 0.f, 0.f, 1.f );
+
+                buck.mCBuff.SetSample( x, y, &pixDepth.x() );
+            }
+        }
+
+        return;
+    }
+
     for (u_int y=0; y < buckHe; ++y)
     {
         for (u_int x=0; x < buckWd; ++x, ++pixIdx)
@@ -142,45 +178,47 @@ void Hider::Hide(
     }
 }
 
-/*
 //==================================================================
-#define CCODE_X1	1
-#define CCODE_X2	2
-#define CCODE_Y1	4
-#define CCODE_Y2	8
-#define CCODE_Z1	16
-#define CCODE_Z2	32
-
-U8	ccodes[ MP_GRID_MAX_SIZE ];
-U8	gridORCCodes = 0;
-// would be nice to simdfy this one too
-for (size_t i=0; i < DMT_SIMD_FLEN; ++i)
+/// The farthest of the nearest opaque depths among the samples of
+/// the bucket. Anything beyond it is hidden in the whole bucket
+float Hider::GetOpaqueDepth(
+                const DVec<HiderPixel>	&pixels,
+                const HiderBucket		&buck ) const
 {
-    float	x = homoP.x()[i];
-    float	y = homoP.y()[i];
-    float	z = homoP.z()[i];
-    float	w = homoP.w()[i];
-
-    U8	ccode = 0;
-    if ( x < -w )	ccode |= CCODE_X1;
-    if ( x >  w )	ccode |= CCODE_X2;
-    if ( y < -w )	ccode |= CCODE_Y1;
-    if ( y >  w )	ccode |= CCODE_Y2;
-    if ( z < -w )	ccode |= CCODE_Z1;
-    if ( z >  w )	ccode |= CCODE_Z2;
-    ccodes[i] = ccode;
-    gridORCCodes |= ccode;
-}
+    u_int	sampsPerPixel = buck.mpSampCoordsBuff->GetSampsPerPixel();
+
+    float	maxDepth = 0;
+
+    for (size_t pixIdx=0; pixIdx < pixels.size(); ++pixIdx)
+    {
+        for (u_int si=0; si < sampsPerPixel; ++si)
+        {
+            const DVec<HiderSampleData> &sampDataList = pixels[pixIdx].mpSampDataLists[si];
+
+            float	nearDepth = FLT_MAX;
+
+            for (size_t i=0; i < sampDataList.size(); ++i)
+            {
+                const HiderSampleData	&data = sampDataList[i];
+
+                // depth maps don't keep the opacity
+                if ( mDepthOnly ||
+                     (data.mOi[0] >= 1 && data.mOi[1] >= 1 && data.mOi[2] >= 1) )
+                {
+                    nearDepth = DMIN( nearDepth, data.mDepth );
+                }
+            }
 
-U8	andCode = 0xff;
-andCode &= ccodes[ srcVertIdx+0 ];
-andCode &= ccodes[ srcVertIdx+1 ];
-andCode &= ccodes[ srcVertIdx+xDim ];
-andCode &= ccodes[ srcVertIdx+xDim+1 ];
-// all out ? Skip this
-if ( andCode )
-    continue;
-*/
+            // something could still show through
+            if ( nearDepth == FLT_MAX )
+                return FLT_MAX;
+
+            maxDepth = DMAX( maxDepth, nearDepth );
+        }
+    }
+
+    return maxDepth;
+}
 
 //==================================================================
 }
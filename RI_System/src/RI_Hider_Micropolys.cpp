@@ -7,6 +7,7 @@
 //==================================================================
 
 #include "stdafx.h"
+#include "RI_Attributes.h"
 #include "RI_HiderST.h"
 
 //==================================================================
@@ -36,7 +37,8 @@ inline void addMPSamples(
                 int					buckHe,
                 const Float3			microquad[4],
                 const float			*valOi,
-                const float			*valCi
+                const float			*valCi,
+                bool				depthOnly
             )
 {
     int	minX = (int)floor( minPos[0] );
@@ -96,6 +98,176 @@ inline void addMPSamples(
                     (crs0 >= 0 && crs1 >= 0 && crs2 >= 0 && crs3 >= 0)
                     )
                 {
+                    // depth maps only keep the nearest sample
+                    if ( depthOnly )
+                    {
+                        DVec<HiderSampleData> &sampDataList = pixel.mpSampDataLists[i];
+
+                        if NOT( sampDataList.size() )
+                            Dgrow( sampDataList ).mDepth = microquad[0][2];
+                        else
+                        if ( microquad[0][2] < sampDataList[0].mDepth )
+                            sampDataList[0].mDepth = microquad[0][2];
+
+                        continue;
+                    }
+
+                    HiderSampleData &sampData = Dgrow( pixel.mpSampDataLists[i] );
+
+                    sampData.mOi[0] = valOi[0];
+                    sampData.mOi[1] = valOi[1];
+                    sampData.mOi[2] = valOi[2];
+
+                    sampData.mCi[0] = valCi[0];
+                    sampData.mCi[1] = valCi[1];
+                    sampData.mCi[2] = valCi[2];
+
+                    sampData.mDepth = microquad[0][2];
+                }
+            }
+        }
+
+        pPixelsRow += buckWd;
+    }
+}
+
+//==================================================================
+// NOTE: all coords here are in bucket space
+// A moving and/or out of focus micro-polygon. The quad is placed at
+// the time and lens position of each sample before testing it.
+// coc are the circles of confusion at the vertices, to be scaled by
+// the lens position.
+// The bounds at shutter open and close, grown by the circles of
+// confusion, are blended first to reject most samples cheaply.
+// Samples with a dissolve value out of the given range are skipped
+// (level of detail transitions)
+inline void addMPSamplesBlurred(
+                const HiderSampleCoordsBuffer	&sampCoordsBuff,
+                HiderPixel			*pPixels,
+                const Float3			&minPos,
+                const Float3			&maxPos,
+                int					buckWd,
+                int					buckHe,
+                const Float3			microquadOpen[4],
+                const Float3			microquadClose[4],
+                const Float2			cocOpen[4],
+                const Float2			cocClose[4],
+                const float			dissolve[2],
+                const float			*valOi,
+                const float			*valCi,
+                bool				depthOnly
+            )
+{
+    int	minX = (int)floor( minPos[0] );
+    int	maxX = (int) ceil( maxPos[0] );
+
+    int	minY = (int)floor( minPos[1] );
+    int	maxY = (int) ceil( maxPos[1] );
+
+    // completely out ?
+    if ( maxX < 0 || maxY < 0 || minX >= buckWd || minY >= buckHe )
+        return;
+
+    // clip
+    if ( minX < 0 )	minX = 0;
+    if ( minY < 0 )	minY = 0;
+    if ( maxX >= buckWd )	maxX = buckWd-1;
+    if ( maxY >= buckHe )	maxY = buckHe-1;
+
+    Float3	microquadD[4];
+    Float2	cocD[4];
+    for (size_t k=0; k < 4; ++k)
+    {
+        microquadD[k] = microquadClose[k] - microquadOpen[k];
+        cocD[k] = cocClose[k] - cocOpen[k];
+    }
+
+    Float3	minOpen(  FLT_MAX,  FLT_MAX,  FLT_MAX );
+    Float3	maxOpen( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+    Float3	minClose(  FLT_MAX,  FLT_MAX,  FLT_MAX );
+    Float3	maxClose( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+    float	cocMax = 0;
+    for (size_t k=0; k < 4; ++k)
+    {
+        updateMinMax( minOpen, maxOpen, microquadOpen[k] );
+        updateMinMax( minClose, maxClose, microquadClose[k] );
+
+        cocMax = DMAX( cocMax, DMAX( DAbs( cocOpen[k][0] ), DAbs( cocOpen[k][1] ) ) );
+        cocMax = DMAX( cocMax, DMAX( DAbs( cocClose[k][0] ), DAbs( cocClose[k][1] ) ) );
+    }
+
+    Float3	minD = minClose - minOpen;
+    Float3	maxD = maxClose - maxOpen;
+
+    u_int sampsPerPixel = sampCoordsBuff.GetSampsPerPixel();
+
+    HiderPixel	*pPixelsRow = pPixels + minY * buckWd;
+
+    for (int y=minY; y <= maxY; ++y)
+    {
+        for (int x=minX; x <= maxX; ++x)
+        {
+            HiderPixel	&pixel = pPixelsRow[ x ];
+
+            for (u_int i=0; i < sampsPerPixel; ++i)
+            {
+                const HiderSampleCoords &sampCoords = pixel.mpSampCoords[i];
+
+                if ( sampCoords.mDissolve <  dissolve[0] ||
+                     sampCoords.mDissolve >= dissolve[1] )
+                    continue;
+
+                float sampX = (float)x + sampCoords.mX;
+                float sampY = (float)y + sampCoords.mY;
+
+                float	t = sampCoords.mTime;
+
+                // outside of the bound at this time ?
+                if ( sampX < minOpen[0] + minD[0] * t - cocMax ||
+                     sampX > maxOpen[0] + maxD[0] * t + cocMax ||
+                     sampY < minOpen[1] + minD[1] * t - cocMax ||
+                     sampY > maxOpen[1] + maxD[1] * t + cocMax )
+                    continue;
+
+                Float3	microquad[4];
+                for (size_t k=0; k < 4; ++k)
+                {
+                    microquad[k] = microquadOpen[k] + microquadD[k] * t;
+
+                    Float2	coc = cocOpen[k] + cocD[k] * t;
+                    microquad[k][0] += coc[0] * sampCoords.mLensX;
+                    microquad[k][1] += coc[1] * sampCoords.mLensY;
+                }
+
+                Float3 d10 = microquad[1] - microquad[0];
+                Float3 d31 = microquad[3] - microquad[1];
+                Float3 d23 = microquad[2] - microquad[3];
+                Float3 d02 = microquad[0] - microquad[2];
+
+                float crs0 = ((sampY-microquad[0][1]) * d10[0] - (sampX-microquad[0][0]) * d10[1]);
+                float crs1 = ((sampY-microquad[1][1]) * d31[0] - (sampX-microquad[1][0]) * d31[1]);
+                float crs2 = ((sampY-microquad[3][1]) * d23[0] - (sampX-microquad[3][0]) * d23[1]);
+                float crs3 = ((sampY-microquad[2][1]) * d02[0] - (sampX-microquad[2][0]) * d02[1]);
+
+                if (
+                    (crs0 <= 0 && crs1 <= 0 && crs2 <= 0 && crs3 <= 0) ||
+                    (crs0 >= 0 && crs1 >= 0 && crs2 >= 0 && crs3 >= 0)
+                    )
+                {
+                    // depth maps only keep the nearest sample
+                    if ( depthOnly )
+                    {
+                        DVec<HiderSampleData> &sampDataList = pixel.mpSampDataLists[i];
+
+                        if NOT( sampDataList.size() )
+                            Dgrow( sampDataList ).mDepth = microquad[0][2];
+                        else
+                        if ( microquad[0][2] < sampDataList[0].mDepth )
+                            sampDataList[0].mDepth = microquad[0][2];
+
+                        continue;
+                    }
+
                     HiderSampleData &sampData = Dgrow( pixel.mpSampDataLists[i] );
 
                     sampData.mOi[0] = valOi[0];
@@ -115,11 +287,228 @@ inline void addMPSamples(
     }
 }
 
+//==================================================================
+static const U8	CCODE_X1 = 1;
+static const U8	CCODE_X2 = 2;
+static const U8	CCODE_Y1 = 4;
+static const U8	CCODE_Y2 = 8;
+static const U8	CCODE_Z1 = 16;
+static const U8	CCODE_Z2 = 32;
+
+//==================================================================
+/// Clip codes for a block of camera space points against the bucket
+/// limits in window space. The limits are grown by the circle of
+/// confusion of each point when there is depth of field
+inline void makeClipCodes(
+                U8				*pOutCodes,
+                const Float3_	&posCS,
+                const Matrix44	&mtxCamProj,
+                const float		screenHalfSize[2],
+                const float		buckLims[4],
+                float			ooFocalDist,
+                float			cocScale )
+{
+    Float4_	homoP = V4__V3W1_Mul_M44<Float_>( posCS, mtxCamProj );
+
+    for (size_t sub=0; sub < DMT_SIMD_FLEN; ++sub)
+    {
+        float	x = homoP.x()[ sub ];
+        float	y = homoP.y()[ sub ];
+        float	z = homoP.z()[ sub ];
+        float	w = homoP.w()[ sub ];
+
+        U8	code = 0;
+        if ( z < -w )	code |= CCODE_Z1;
+        if ( z >  w )	code |= CCODE_Z2;
+
+        // behind the eye, window space is meaningless
+        if ( w > 0 )
+        {
+            float	oow = 1.0f / w;
+
+            float	winX = screenHalfSize[0] + screenHalfSize[0] * x * oow;
+            float	winY = screenHalfSize[1] - screenHalfSize[1] * y * oow;
+
+            float	margin = 0;
+            if ( cocScale )
+                margin = DAbs( ooFocalDist - 1.0f / posCS[2][ sub ] ) * cocScale;
+
+            if ( winX < buckLims[0] - margin )	code |= CCODE_X1;
+            if ( winX > buckLims[2] + margin )	code |= CCODE_X2;
+            if ( winY < buckLims[1] - margin )	code |= CCODE_Y1;
+            if ( winY > buckLims[3] + margin )	code |= CCODE_Y2;
+        }
+
+        pOutCodes[ sub ] = code;
+    }
+}
+
+//==================================================================
+static inline Float3 getGridPos( const Float3_ *pPos, size_t idx )
+{
+    size_t	blk = idx / DMT_SIMD_FLEN;
+    size_t	sub = idx & (DMT_SIMD_FLEN-1);
+
+    return Float3( pPos[blk][0][sub], pPos[blk][1][sub], pPos[blk][2][sub] );
+}
+
+//==================================================================
+static float det33( const Matrix44 &m )
+{
+    return
+        m.mij(0,0) * (m.mij(1,1) * m.mij(2,2) - m.mij(1,2) * m.mij(2,1)) -
+        m.mij(0,1) * (m.mij(1,0) * m.mij(2,2) - m.mij(1,2) * m.mij(2,0)) +
+        m.mij(0,2) * (m.mij(1,0) * m.mij(2,1) - m.mij(1,1) * m.mij(2,0));
+}
+
+//==================================================================
+/// Marks the micro-polygons that can't be seen from this bucket, either
+/// because they are out of it (or of the screen) or because they face
+/// away from the camera with "Sides 1".
+/// Works on the displaced positions and, for moving grids, also on the
+/// ones at shutter close (culled only if culled at both ends).
+/// Returns false if the whole grid is culled
+bool Hider::CullGrid(
+                const HiderBucket	&bucket,
+                WorkGrid			&workGrid,
+                const Attributes	&attribs ) const
+{
+    static const u_int	MAX_BLKS = MP_GRID_MAX_SIZE_SIMD_BLKS;
+
+    U8	codes[ MAX_BLKS * DMT_SIMD_FLEN ];
+
+    float	screenHalfSize[2] = {
+                mFinalBuff.mWd * 0.5f,
+                mFinalBuff.mHe * 0.5f };
+
+    float	buckLims[4] = {
+                (float)bucket.mX1,
+                (float)bucket.mY1,
+                (float)bucket.mX2,
+                (float)bucket.mY2 };
+
+    float	ooFocalDist = mHasDOF ? 1.0f / mFocalDistance : 0.f;
+    float	cocScale	= mHasDOF ? DMAX( DAbs( mCoCScale[0] ), DAbs( mCoCScale[1] ) ) : 0.f;
+
+    const Float3_	*pPointsCS = workGrid.mpPointsCS;
+
+    size_t	blocksN = DMT_SIMD_BLOCKS( workGrid.mPointsN );
+    for (size_t blkIdx=0; blkIdx < blocksN; ++blkIdx)
+    {
+        U8	*pBlkCodes = codes + blkIdx * DMT_SIMD_FLEN;
+
+        makeClipCodes(
+                pBlkCodes,
+                pPointsCS[ blkIdx ],
+                mOptions.mMtxCamProj,
+                screenHalfSize,
+                buckLims,
+                ooFocalDist,
+                cocScale );
+
+        // in only if in at either end of the shutter
+        if ( workGrid.mIsMoving )
+        {
+            U8	closeCodes[ DMT_SIMD_FLEN ];
+
+            makeClipCodes(
+                    closeCodes,
+                    pPointsCS[ blkIdx ] + workGrid.mpMotionCS[ blkIdx ],
+                    mOptions.mMtxCamProj,
+                    screenHalfSize,
+                    buckLims,
+                    ooFocalDist,
+                    cocScale );
+
+            for (size_t sub=0; sub < DMT_SIMD_FLEN; ++sub)
+                pBlkCodes[ sub ] &= closeCodes[ sub ];
+        }
+    }
+
+    // the normal facing the viewer has the same direction as Ng, which
+    // is flipped by the orientation and by a mirroring transformation
+    bool	doBackface = (attribs.mSides == 1);
+
+    float	facingSign = det33( workGrid.mMtxLocalCamera ) < 0 ? -1.f : 1.f;
+    if ( attribs.mOrientationFlipped )
+        facingSign = -facingSign;
+
+    u_int	xN	= workGrid.mXDim - 1;
+    u_int	yN	= workGrid.mYDim - 1;
+
+    size_t	visibleN = 0;
+
+    size_t	srcVertIdx = 0;
+    for (u_int i=0; i < yN; ++i)
+    {
+        for (u_int j=0; j < xN; ++j, ++srcVertIdx)
+        {
+            if ( workGrid.mHasHoles && workGrid.mpMPHoles[ srcVertIdx ] )
+            {
+                workGrid.mpMPCulled[ srcVertIdx ] = 1;
+                continue;
+            }
+
+            size_t	vidx[4] = {
+                        srcVertIdx + 0,
+                        srcVertIdx + 1,
+                        srcVertIdx + xN+1,
+                        srcVertIdx + xN+2 };
+
+            U8	andCode =
+                    codes[ vidx[0] ] &
+                    codes[ vidx[1] ] &
+                    codes[ vidx[2] ] &
+                    codes[ vidx[3] ];
+
+            bool	isCulled = (andCode != 0);
+
+            if ( doBackface && NOT( isCulled ) )
+            {
+                isCulled = true;
+
+                for (u_int t=0; t < (workGrid.mIsMoving ? 2u : 1u); ++t)
+                {
+                    Float3	pos[4];
+                    for (size_t k=0; k < 4; ++k)
+                    {
+                        pos[k] = getGridPos( pPointsCS, vidx[k] );
+
+                        if ( t == 1 )
+                            pos[k] += getGridPos( workGrid.mpMotionCS, vidx[k] );
+                    }
+
+                    // ~ dPdu x dPdv from the diagonals
+                    Float3	nor = (pos[1] - pos[2]).GetCross( pos[3] - pos[0] ) * facingSign;
+
+                    Float3	viewDir = mIsPerspective ? pos[0] : Float3( 0, 0, 1 );
+
+                    if ( nor.GetDot( viewDir ) <= 0 )
+                    {
+                        isCulled = false;
+                        break;
+                    }
+                }
+            }
+
+            workGrid.mpMPCulled[ srcVertIdx ] = isCulled ? 1 : 0;
+
+            if NOT( isCulled )
+                ++visibleN;
+        }
+
+        srcVertIdx += 1;
+    }
+
+    return visibleN != 0;
+}
+
 //==================================================================
 void Hider::Bust(
                 const HiderBucket	&bucket,
                 ShadedGrid			&shadGrid,
                 const WorkGrid		&workGrid,
+                const Attributes	&attribs,
                 DVec<HiderPixel>	&pixels,
                 u_int				screenWd,
                 u_int				screenHe ) const
@@ -147,13 +536,30 @@ void Hider::Bust(
             Float4_		projP = homoP / homoP.w();
 
             shadGrid.mpPointsCS[ blkIdx ]			= pPointsCS[ blkIdx ];
-            //shadGrid.mpPointsCloseCS[ blkIdx ]	= 0;
 
             shadGrid.mpPosWin[ blkIdx ][0] =  projP.x() * screenHWd + screenCx;
             shadGrid.mpPosWin[ blkIdx ][1] = -projP.y() * screenHHe + screenCy;
 
-            shadGrid.mpCi[ blkIdx ] = pCi[ blkIdx ];
-            shadGrid.mpOi[ blkIdx ] = pOi[ blkIdx ];
+            // shaded at shutter open, then moved to shutter close
+            if ( workGrid.mIsMoving )
+            {
+                Float3_	posCloseCS = pPointsCS[ blkIdx ] + workGrid.mpMotionCS[ blkIdx ];
+
+                Float4_	homoPClose = V4__V3W1_Mul_M44<Float_>( posCloseCS, mOptions.mMtxCamProj );
+                Float4_	projPClose = homoPClose / homoPClose.w();
+
+                shadGrid.mpPointsCloseCS[ blkIdx ]	= posCloseCS;
+
+                shadGrid.mpPosWinClose[ blkIdx ][0] =  projPClose.x() * screenHWd + screenCx;
+                shadGrid.mpPosWinClose[ blkIdx ][1] = -projPClose.y() * screenHHe + screenCy;
+            }
+
+            // no shading when doing only depth
+            if NOT( mDepthOnly )
+            {
+                shadGrid.mpCi[ blkIdx ] = pCi[ blkIdx ];
+                shadGrid.mpOi[ blkIdx ] = pOi[ blkIdx ];
+            }
         }
     }
 
@@ -165,6 +571,15 @@ void Hider::Bust(
     u_int	buckWd	= bucket.GetWd();
     u_int	buckHe	= bucket.GetHe();
 
+    // circles of confusion smaller than this are left to the
+    // fast path, as if in focus
+    float	minCoC = 0.5f / bucket.mpSampCoordsBuff->GetSampsPerDim();
+    float	cocScaleMax = DMAX( DAbs( mCoCScale[0] ), DAbs( mCoCScale[1] ) );
+    float	ooFocalDist = mHasDOF ? 1.0f / mFocalDistance : 0.f;
+
+    // dissolving into another level of detail ?
+    bool	isDissolving = attribs.IsLODDissolving();
+
     if ( mParams.mDbgRasterizeVerts )
     {
         // scan the grid.. for every vertex
@@ -208,6 +623,9 @@ void Hider::Bust(
         {
             for (u_int j=0; j < xN; ++j, ++srcVertIdx)
             {
+                if ( workGrid.mpMPCulled[ srcVertIdx ] )
+                    continue;
+
                 // vector coords of the micro-poly
                 u_int	vidx[4] = {
                             (u_int)srcVertIdx + 0,
@@ -228,6 +646,9 @@ void Hider::Bust(
                 size_t	blk[4];
                 size_t	sub[4];
                 Float3	buckPos[4];
+                Float3	buckPosClose[4];
+                Float2	cocOpen[4];
+                Float2	cocClose[4];
 
                 for (size_t k=0; k < 4; ++k)
                 {
@@ -239,33 +660,114 @@ void Hider::Bust(
                     buckPos[k][2] = shadGrid.mpPointsCS[ blk[k] ][2][ sub[k] ];
 
                     updateMinMax( minPos, maxPos, buckPos[k] );
+
+                    // the bound of the whole path
+                    if ( shadGrid.mIsMoving )
+                    {
+                        buckPosClose[k][0] = shadGrid.mpPosWinClose[ blk[k] ][0][ sub[k] ] - (float)bucket.mX1;
+                        buckPosClose[k][1] = shadGrid.mpPosWinClose[ blk[k] ][1][ sub[k] ] - (float)bucket.mY1;
+                        buckPosClose[k][2] = shadGrid.mpPointsCloseCS[ blk[k] ][2][ sub[k] ];
+
+                        updateMinMax( minPos, maxPos, buckPosClose[k] );
+                    }
+                    else
+                    {
+                        buckPosClose[k] = buckPos[k];
+                    }
+                }
+
+                bool	isBlurred = shadGrid.mIsMoving || isDissolving;
+
+                if ( mHasDOF )
+                {
+                    float	maxCoCK = 0;
+                    for (size_t k=0; k < 4; ++k)
+                    {
+                        float	cocK		= ooFocalDist - 1.0f / buckPos[k][2];
+                        float	cocKClose	= ooFocalDist - 1.0f / buckPosClose[k][2];
+
+                        cocOpen[k]	= mCoCScale * cocK;
+                        cocClose[k]	= mCoCScale * cocKClose;
+
+                        maxCoCK = DMAX( maxCoCK, DMAX( DAbs( cocK ), DAbs( cocKClose ) ) );
+                    }
+
+                    float	maxCoC = maxCoCK * cocScaleMax;
+
+                    if ( maxCoC >= minCoC )
+                    {
+                        isBlurred = true;
+
+                        minPos[0] -= maxCoC;
+                        minPos[1] -= maxCoC;
+                        maxPos[0] += maxCoC;
+                        maxPos[1] += maxCoC;
+                    }
+                    else
+                    {
+                        for (size_t k=0; k < 4; ++k)
+                        {
+                            cocOpen[k]	= Float2( 0.f, 0.f );
+                            cocClose[k]	= Float2( 0.f, 0.f );
+                        }
+                    }
+                }
+                else
+                if ( isBlurred )
+                {
+                    for (size_t k=0; k < 4; ++k)
+                    {
+                        cocOpen[k]	= Float2( 0.f, 0.f );
+                        cocClose[k]	= Float2( 0.f, 0.f );
+                    }
                 }
 
                 // sample only from the first vertex.. no bilinear
                 // interpolation in the micro-poly !
-                float valOi[3] =
-                    {
-                        shadGrid.mpOi[ blk[0] ][0][ sub[0] ],
-                        shadGrid.mpOi[ blk[0] ][1][ sub[0] ],
-                        shadGrid.mpOi[ blk[0] ][2][ sub[0] ]
-                    };
-                float valCi[3] =
+                float valOi[3] = { 1, 1, 1 };
+                float valCi[3] = { 0, 0, 0 };
+
+                if NOT( mDepthOnly )
+                {
+                    for (size_t k=0; k < 3; ++k)
                     {
-                        shadGrid.mpCi[ blk[0] ][0][ sub[0] ],
-                        shadGrid.mpCi[ blk[0] ][1][ sub[0] ],
-                        shadGrid.mpCi[ blk[0] ][2][ sub[0] ]
-                    };
-
-                addMPSamples(
-                        *bucket.mpSampCoordsBuff,
-                        &pixels[0],
-                        minPos,
-                        maxPos,
-                        (int)buckWd,
-                        (int)buckHe,
-                        buckPos,
-                        valOi,
-                        valCi );
+                        valOi[k] = shadGrid.mpOi[ blk[0] ][k][ sub[0] ];
+                        valCi[k] = shadGrid.mpCi[ blk[0] ][k][ sub[0] ];
+                    }
+                }
+
+                if ( isBlurred )
+                {
+                    addMPSamplesBlurred(
+                            *bucket.mpSampCoordsBuff,
+                            &pixels[0],
+                            minPos,
+                            maxPos,
+                            (int)buckWd,
+                            (int)buckHe,
+                            buckPos,
+                            buckPosClose,
+                            cocOpen,
+                            cocClose,
+                            attribs.mLODDissolve,
+                            valOi,
+                            valCi,
+                            mDepthOnly );
+                }
+                else
+                {
+                    addMPSamples(
+                            *bucket.mpSampCoordsBuff,
+                            &pixels[0],
+                            minPos,
+                            maxPos,
+                            (int)buckWd,
+                            (int)buckHe,
+                            buckPos,
+                            valOi,
+                            valCi,
+                            mDepthOnly );
+                }
             }
 
             srcVertIdx += 1;
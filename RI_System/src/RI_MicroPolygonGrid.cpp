@@ -21,6 +21,11 @@ WorkGrid::WorkGrid( const SymbolList &globalSyms ) :
     mXDim(0),
     mYDim(0),
     mpPointsCS(0),
+    mpMotionCS(0),
+    mIsMoving(false),
+    mpMPCulled(0),
+    mpMPHoles(0),
+    mHasHoles(false),
     mPointsN(0),
     mpDataCi(0),
     mpDataOi(0),
@@ -57,11 +62,18 @@ WorkGrid::WorkGrid( const SymbolList &globalSyms ) :
     // to do in the constructor..
     mSurfRunCtx.Init( this );
     mDispRunCtx.Init( this );
+
+    mpMotionCS = (Float3_ *)DNEW U8 [ sizeof(Float3_) * MP_GRID_MAX_SIZE_SIMD_BLKS ];
+    mpMPCulled = DNEW U8 [ MP_GRID_MAX_SIZE ];
+    mpMPHoles = DNEW U8 [ MP_GRID_MAX_SIZE ];
 }
 
 //==================================================================
 WorkGrid::~WorkGrid()
 {
+    DSAFE_DELETE_ARRAY( mpMotionCS );
+    DSAFE_DELETE_ARRAY( mpMPCulled );
+    DSAFE_DELETE_ARRAY( mpMPHoles );
 }
 
 //==================================================================
@@ -110,6 +122,15 @@ void WorkGrid::Setup(
     mMtxLocalWorld	= mtxLocalWorld;
     mMtxWorldCamera	= mtxWorldCamera;
 
+    // set by the primitive when dicing, if moving or with holes
+    mIsMoving = false;
+    mHasHoles = false;
+
+    // the whole grid, and no stitching, unless the primitive says otherwise
+    mXSegs = xdim - 1;
+    mYSegs = ydim - 1;
+    mEdgeSegs[0] = mEdgeSegs[1] = mEdgeSegs[2] = mEdgeSegs[3] = 0;
+
     mMtxLocalCamera = mMtxLocalWorld * mMtxWorldCamera;
     mMtxCameraLocal = mMtxLocalCamera.GetInverse();	// this is handy for calculatenormal()
 
@@ -140,6 +161,81 @@ void WorkGrid::Displace( const Attributes &attribs )
     }
 }
 
+//==================================================================
+static inline Float3 getVert( const Float3_ *pData, u_int idx )
+{
+    const Float3_	&blk = pData[ idx / DMT_SIMD_FLEN ];
+    u_int			sub = idx & (DMT_SIMD_FLEN-1);
+
+    return Float3( blk[0][sub], blk[1][sub], blk[2][sub] );
+}
+
+static inline void setVert( Float3_ *pData, u_int idx, const Float3 &val )
+{
+    Float3_	&blk = pData[ idx / DMT_SIMD_FLEN ];
+    u_int	sub = idx & (DMT_SIMD_FLEN-1);
+
+    blk[0][sub] = val[0];
+    blk[1][sub] = val[1];
+    blk[2][sub] = val[2];
+}
+
+//==================================================================
+/// Move the vertices of a border diced finer than the border's own
+/// rate onto the straight segments between the vertices at that rate.
+/// The rates are powers of two, so the neighbour diced at the border's
+/// rate has exactly those vertices, and the two edges match
+static void stitchEdge(
+                Float3_	*pData,
+                u_int	startIdx,
+                u_int	stride,
+                u_int	segsN,
+                u_int	edgeSegsN )
+{
+    u_int	step = segsN / edgeSegsN;
+    float	oostep = 1.0f / step;
+
+    for (u_int i=0; i < segsN; i += step)
+    {
+        Float3	a = getVert( pData, startIdx + stride * i );
+        Float3	b = getVert( pData, startIdx + stride * (i + step) );
+
+        for (u_int j=1; j < step; ++j)
+            setVert( pData, startIdx + stride * (i + j), DMix( a, b, j * oostep ) );
+    }
+}
+
+//==================================================================
+/// Close the cracks that displacement opens toward the neighbouring
+/// grids diced at a different rate. Must follow Displace()
+void WorkGrid::Stitch()
+{
+    // x, y, stride and segments for the borders v=0, u=1, v=1, u=0
+    const u_int	edges[4][4] =
+    {
+        { 0,		0,		1,		mXSegs },
+        { mXSegs,	0,		mXDim,	mYSegs },
+        { 0,		mYSegs,	1,		mXSegs },
+        { 0,		0,		mXDim,	mYSegs },
+    };
+
+    for (u_int e=0; e < 4; ++e)
+    {
+        if ( mEdgeSegs[e] == 0 || mEdgeSegs[e] >= edges[e][3] )
+            continue;
+
+        DASSERT( (edges[e][3] % mEdgeSegs[e]) == 0 );
+
+        u_int	startIdx = edges[e][1] * mXDim + edges[e][0];
+
+        stitchEdge( mpPointsCS, startIdx, edges[e][2], edges[e][3], mEdgeSegs[e] );
+
+        // the shutter close positions are offsets, they blend the same way
+        if ( mIsMoving )
+            stitchEdge( mpMotionCS, startIdx, edges[e][2], edges[e][3], mEdgeSegs[e] );
+    }
+}
+
 //==================================================================
 void WorkGrid::Shade( const Attributes &attribs )
 {
@@ -160,8 +256,11 @@ ShadedGrid::ShadedGrid() :
                     mPointsN(0),
                     mpPointsCS(NULL),
                     mpPointsCloseCS(NULL),
+                    mpPosWin(NULL),
+                    mpPosWinClose(NULL),
                     mpCi(NULL),
-                    mpOi(NULL)
+                    mpOi(NULL),
+                    mIsMoving(false)
 {
 }
 
@@ -172,25 +271,31 @@ ShadedGrid::~ShadedGrid()
 }
 
 //==================================================================
-void ShadedGrid::Init( u_int pointsN )
+void ShadedGrid::Init( u_int pointsN, bool isMoving )
 {
     mPointsN = pointsN;
+    mIsMoving = isMoving;
 
     size_t	blocksN = DMT_SIMD_BLOCKS( pointsN );
 
-    size_t	offs[5] = { 0 };
+    // the shutter close positions are only there when moving
+    size_t	closeBlocksN = isMoving ? blocksN : 0;
+
+    size_t	offs[6] = { 0 };
 
     offs[0] =			sizeof(*mpPointsCS		) * blocksN;
-    offs[1] = offs[0] + sizeof(*mpPointsCloseCS	) * blocksN;
+    offs[1] = offs[0] + sizeof(*mpPointsCloseCS	) * closeBlocksN;
     offs[2] = offs[1] + sizeof(*mpPosWin		) * blocksN;
-    offs[3] = offs[2] + sizeof(*mpCi			) * blocksN;
-    offs[4] = offs[3] + sizeof(*mpOi			) * blocksN;
+    offs[3] = offs[2] + sizeof(*mpPosWinClose	) * closeBlocksN;
+    offs[4] = offs[3] + sizeof(*mpCi			) * blocksN;
+    offs[5] = offs[4] + sizeof(*mpOi			) * blocksN;
 
-    mpPointsCS		= (Float3_	*)DNEW U8 [ offs[4] ];
+    mpPointsCS		= (Float3_	*)DNEW U8 [ offs[5] ];
     mpPointsCloseCS = (Float3_	*)((U8 *)mpPointsCS + offs[0]);
     mpPosWin		= (Float2_	*)((U8 *)mpPointsCS + offs[1]);
-    mpCi			= (SlColor	*)((U8 *)mpPointsCS + offs[2]);
-    mpOi			= (SlColor	*)((U8 *)mpPointsCS + offs[3]);
+    mpPosWinClose	= (Float2_	*)((U8 *)mpPointsCS + offs[2]);
+    mpCi			= (SlColor	*)((U8 *)mpPointsCS + offs[3]);
+    mpOi			= (SlColor	*)((U8 *)mpPointsCS + offs[4]);
 }
 
 //==================================================================
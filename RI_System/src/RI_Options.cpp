@@ -195,15 +195,11 @@ void Options::cmdDisplay( const char *pName, const char *pType, const char *pMod
         pName = "no_name";
 
     if NOT( appending )
-    {
-        for (size_t i=0; i < mpDisplays.size(); ++i)
-            DSAFE_DELETE( mpDisplays[i] );
+        moDisplays.clear();
 
-        mpDisplays.clear();
-    }
+    moDisplays.push_back( std::make_shared<Display>() );
 
-    Display	*pNewDisp = DNEW Display();
-    mpDisplays.push_back( pNewDisp );
+    Display	*pNewDisp = moDisplays.back().get();
 
     if ( 0 == strcmp( pType, RI_FRAMEBUFFER ) )
     {
@@ -215,6 +211,17 @@ void Options::cmdDisplay( const char *pName, const char *pType, const char *pMod
         pNewDisp->mType = RI_FILE;
     }
     else
+    if ( 0 == strcmp( pType, RI_ZFILE ) || 0 == strcmp( pType, "shadow" ) )
+    {
+        // depth map, always a single float channel
+        pNewDisp->mType		= RI_ZFILE;
+        pNewDisp->mValZero	= 0;
+        pNewDisp->mValOne	= 0;
+        pNewDisp->mValMin	= 0;
+        pNewDisp->mValMax	= 0;
+        pMode = RI_Z;
+    }
+    else
     {
         onError( "Unknown display type '%s'", pType );
     }
@@ -239,7 +246,7 @@ void Options::Finalize(
 {
     size_t	viableDisplaysN = 0;
 
-    if NOT( mpDisplays.size() )
+    if NOT( moDisplays.size() )
     {
         if ( fallbackFileDisp )
         {
@@ -281,7 +288,7 @@ void Options::Finalize(
     if NOT( mProjectionParams.size() )
         return;
 
-    if ( mProjectionParams[0].u.stringVal == RI_PERSPECTIVE )
+    if ( 0 == strcmp( mProjectionParams[0].PChar(), RI_PERSPECTIVE ) )
     {
         mpyProjection	= mpGlobalSyms->FindSymbol( RI_PERSPECTIVE );
         
@@ -289,7 +296,7 @@ void Options::Finalize(
         {
             if ( mProjectionParams[i].type == Param::STR )
             {
-                if ( mProjectionParams[i].u.stringVal == RI_FOV )
+                if ( 0 == strcmp( mProjectionParams[i].PChar(), RI_FOV ) )
                 {
                     if ( (i+1) >= mProjectionParams.size() )
                     {
@@ -309,19 +316,32 @@ void Options::Finalize(
         }
     }
     else
-    if ( mProjectionParams[0].u.stringVal == RI_ORTHOGRAPHIC )
+    if ( 0 == strcmp( mProjectionParams[0].PChar(), RI_ORTHOGRAPHIC ) )
     {
         mpyProjection	= mpGlobalSyms->FindSymbol( RI_ORTHOGRAPHIC );
     }
 }
 
 //==================================================================
-void Options::FreeDisplays()
+// depth-only when all the displays want a depth map
+bool Options::IsDepthOnly() const
 {
-    for (size_t i=0; i < mpDisplays.size(); ++i)
-        DSAFE_DELETE( mpDisplays[i] );
+    if NOT( moDisplays.size() )
+        return false;
 
-    mpDisplays.clear();
+    for (size_t i=0; i < moDisplays.size(); ++i)
+        if NOT( moDisplays[i]->IsZFile() )
+            return false;
+
+    return true;
+}
+
+//==================================================================
+/// The displays stay alive for the options further down the stack
+/// that still have them, such as those outside of the frame
+void Options::FreeDisplays()
+{
+    moDisplays.clear();
 }
 
 //==================================================================
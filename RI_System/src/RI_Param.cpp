@@ -7,6 +7,7 @@
 //==================================================================
 
 #include "stdafx.h"
+#include <memory>
 #include "RI_Param.h"
 
 //==================================================================
@@ -18,7 +19,7 @@ int FindParam( const char *pFindName,
                u_int expectedType,
                u_int altExpectedType,
                int fromIdx,
-               ParamList &params )
+               const ParamList &params )
 {
     int n = (int)params.size() - 1;
 
@@ -40,87 +41,289 @@ int FindParam( const char *pFindName,
 }
 
 //==================================================================
-const FltVec &Param::NumVec( size_t n )
+void Param::Clear()
+{
+    type		= UNKNOWN;
+    mpValues	= NULL;
+    mValuesN	= 0;
+
+    DSAFE_DELETE( mpIntArrAsFlt );
+}
+
+//==================================================================
+size_t Param::GetHeapMemSize() const
+{
+    if ( mpIntArrAsFlt )
+        return sizeof(FltVec) + mpIntArrAsFlt->capacity() * sizeof(float);
+
+    return 0;
+}
+
+//==================================================================
+void Param::copyFrom( const Param &from )
+{
+    DASSERT( type == UNKNOWN );
+
+    type		= from.type;
+    u			= from.u;
+    mpValues	= from.mpValues;
+    mValuesN	= from.mValuesN;
+}
+
+//==================================================================
+void Param::moveFrom( Param &from )
+{
+    copyFrom( from );
+
+    mpIntArrAsFlt = from.mpIntArrAsFlt;
+    from.mpIntArrAsFlt = NULL;
+}
+
+//==================================================================
+void Param::SetInt( int val )
+{
+    Clear();
+    u.intVal = val;
+    type = INT;
+}
+
+void Param::SetFlt( float val )
+{
+    Clear();
+    u.floatVal = val;
+    type = FLT;
+}
+
+//==================================================================
+FltView Param::NumVec( size_t n ) const
 {
     if ( type == FLT_ARR )
     {
         if ( n != DNPOS )
             ensFltArr( n );
+
+        return FltView( (const float *)mpValues, mValuesN );
     }
-    else
-    if ( type == INT_ARR )
+
+    if ( type != INT_ARR )
+        badType();
+
+    if ( n != DNPOS )
+        ensIntArr( n );
+
+    // first time ? (parameters are read-only once in a primitive, and
+    // this is only reached before the buckets are rendered)
+    if NOT( mpIntArrAsFlt )
     {
-        if ( n != DNPOS )
-        {
-            ensIntArr( n );
-        }
-        else
-        {
-            // get the proper N from the int array !
-            n = u.intArrayVal.size();
-        }
+        // build it
+        const int	*pInts = (const int *)mpValues;
 
-        // first time ?
-        if ( u.floatArrayVal.size() != n )
-        {
-            // build it
-            u.floatArrayVal.resize( n );
-            for (size_t i=0; i < u.intArrayVal.size(); ++i)
-                u.floatArrayVal[i] = (float)u.intArrayVal[i];
-        }
-#ifdef _DEBUG
-        else
-        {
-            // check it !
-            for (size_t i=0; i < u.intArrayVal.size(); ++i)
-            {
-                DASSERT( u.floatArrayVal[i] == (float)u.intArrayVal[i] );
-            }
-        }
-#endif
+        mpIntArrAsFlt = DNEW FltVec( mValuesN );
+        for (size_t i=0; i < mValuesN; ++i)
+            (*mpIntArrAsFlt)[i] = (float)pInts[i];
     }
-    else
-        badType();
 
-    return u.floatArrayVal;
+    return FltView( mpIntArrAsFlt->data(), mpIntArrAsFlt->size() );
 }
 
 //==================================================================
+/// The first string of a STR_ARR is at the start of its values
 const char *Param::PChar() const
 {
-    if ( type == STR )
-        return u.stringVal.c_str();
-    else
-    if ( type == STR_ARR )
-        return u.stringArrayVal[0].c_str();
+    if ( type == STR || (type == STR_ARR && mValuesN) )
+        return (const char *)mpValues;
 
     badType();
     return NULL;
 }
 
 //==================================================================
-void ParamList::Add( const char *pStr )
+/// ParamList
+//==================================================================
+static const size_t	VALUES_MIN_SIZE = 64;
+
+//==================================================================
+void ParamList::clear()
 {
-    auto &p = Dgrow( *this );
+    DVec<Param>::clear();
 
-    p.type = Param::STR;
-    p.u.stringVal = pStr;
+    // the block goes on for the next command, unless shared
+    if ( moValues && moValues.use_count() == 1 )
+        moValues->clear();
+    else
+        moValues = NULL;
 }
 
-void ParamList::Add( float val )
+//==================================================================
+void ParamList::Add( const char *pStr )
 {
-    auto &p = Dgrow( *this );
+    AddStr( pStr, strlen( pStr ) );
+}
 
-    p.type = Param::FLT;
-    p.u.floatVal = val;
+void ParamList::Add( float val )
+{
+    Dgrow( *this ).SetFlt( val );
 }
 
 void ParamList::Add( int val )
 {
-    auto &p = Dgrow( *this );
+    Dgrow( *this ).SetInt( val );
+}
+
+//==================================================================
+/// Space at the end of the block. A shared block is copied first,
+/// a block that moves takes the views of the params with it
+U8 *ParamList::allocValues( size_t size, size_t align )
+{
+    if NOT( moValues )
+    {
+        moValues = std::make_shared<Values>();
+        moValues->reserve( VALUES_MIN_SIZE );
+    }
+    else
+    if ( moValues.use_count() > 1 )
+    {
+        std::shared_ptr<Values>	oOld = moValues;
+
+        moValues = std::make_shared<Values>();
+        moValues->reserve( DMAX( oOld->size() * 2, VALUES_MIN_SIZE ) );
+        moValues->assign( oOld->begin(), oOld->end() );
+
+        rebase( oOld->data(), moValues->data() );
+    }
+
+    Values	&vals = *moValues;
+
+    size_t	offset = (vals.size() + align - 1) & ~(align - 1);
+
+    const U8	*pOldBase = vals.data();
+
+    vals.resize( offset + size );
+
+    if ( pOldBase != vals.data() )
+        rebase( pOldBase, vals.data() );
+
+    return vals.data() + offset;
+}
+
+//==================================================================
+void ParamList::rebase( const U8 *pOldBase, const U8 *pNewBase )
+{
+    for (size_t i=0; i < size(); ++i)
+    {
+        Param	&param = (*this)[i];
+
+        if ( param.HasValues() )
+            param.mpValues = pNewBase + ((const U8 *)param.mpValues - pOldBase);
+    }
+}
+
+//==================================================================
+void ParamList::AddStr( const char *pStr, size_t len )
+{
+    U8	*pDes = allocValues( len + 1, 1 );
+
+    memcpy( pDes, pStr, len );
+    pDes[len] = 0;
+
+    Param	&param = Dgrow( *this );
+    param.type		= Param::STR;
+    param.mpValues	= pDes;
+    param.mValuesN	= len;
+}
+
+void ParamList::AddUnknown()
+{
+    Dgrow( *this );
+}
+
+void ParamList::AddArr( u_int arrType )
+{
+    DASSERT( arrType == Param::INT_ARR || arrType == Param::FLT_ARR || arrType == Param::STR_ARR );
+
+    // aligned for the first item
+    U8	*pDes = allocValues( 0, sizeof(float) );
+
+    Param	&param = Dgrow( *this );
+    param.type		= arrType;
+    param.mpValues	= pDes;
+    param.mValuesN	= 0;
+}
+
+//==================================================================
+void ParamList::AppendInt( int val )
+{
+    DASSERT( back().type == Param::INT_ARR );
+
+    *(int *)allocValues( sizeof(int), sizeof(int) ) = val;
+
+    back().mValuesN += 1;
+}
+
+void ParamList::AppendFlt( float val )
+{
+    *AppendFlts( 1 ) = val;
+}
+
+float *ParamList::AppendFlts( size_t n )
+{
+    DASSERT( back().type == Param::FLT_ARR );
+
+    float	*pDes = (float *)allocValues( n * sizeof(float), sizeof(float) );
+
+    back().mValuesN += n;
+
+    return pDes;
+}
+
+// the strings of an array follow each other, each with its terminator
+void ParamList::AppendStr( const char *pStr, size_t len )
+{
+    DASSERT( back().type == Param::STR_ARR );
+
+    U8	*pDes = allocValues( len + 1, 1 );
+
+    memcpy( pDes, pStr, len );
+    pDes[len] = 0;
+
+    back().mValuesN += 1;
+}
+
+// an array that started with integers and turned out to be of floats.
+// Same size, converted in place
+void ParamList::ChangeIntArrToFltArr()
+{
+    Param	&param = back();
+
+    DASSERT( param.type == Param::INT_ARR );
+
+    const int	*pSrc = (const int *)param.mpValues;
+    float		*pDes = (float *)const_cast<void *>( param.mpValues );
+
+    for (size_t i=0; i < param.mValuesN; ++i)
+        pDes[i] = (float)pSrc[i];
+
+    param.type = Param::FLT_ARR;
+}
+
+//==================================================================
+/// The block grows as the values come, it's copied to its exact size
+/// at the end if that saves enough. Shared blocks are left as they are
+void ParamList::ShrinkValues()
+{
+    if NOT( moValues && moValues.use_count() == 1 && moValues->size() )
+        return;
+
+    Values	&vals = *moValues;
+
+    if ( (vals.capacity() - vals.size()) <= vals.size() / 8 )
+        return;
+
+    std::shared_ptr<Values>	oOld = moValues;
+
+    moValues = std::make_shared<Values>( vals );
 
-    p.type = Param::INT;
-    p.u.intVal = val;
+    rebase( oOld->data(), moValues->data() );
 }
 
 //==================================================================
@@ -13,35 +13,29 @@
 #include "RI_Parser.h"
 
 //==================================================================
-static void printArray( const std::vector<int> &vec )
+namespace RI
 {
-    for (size_t i=0; i < vec.size(); ++i)
-        printf( "%i ", vec[i] );
-
-    printf( "\n" );
-}
 
 //==================================================================
-static void printArray( const std::vector<float> &vec )
+Parser::Parser( const char *pData, size_t dataSize ) :
+    mpTokenizer(NULL),
+    mNextCmdID(CMDID_UNKNOWN),
+    mNextCommandLine(0),
+    mHasNextCommand(false),
+    mCurCmdID(CMDID_UNKNOWN)
 {
-    for (size_t i=0; i < vec.size(); ++i)
-        printf( "%f ", vec[i] );
-
-    printf( "\n" );
+    mpTokenizer = DNEW Tokenizer( pData, dataSize );
 }
 
 //==================================================================
-namespace RI
-{
-
-//==================================================================
-Parser::Parser() :
-    mReachedEOF(false),
+Parser::Parser( DIO::InputStream &stream ) :
     mpTokenizer(NULL),
+    mNextCmdID(CMDID_UNKNOWN),
     mNextCommandLine(0),
-    mCurCommandLine(0)
+    mHasNextCommand(false),
+    mCurCmdID(CMDID_UNKNOWN)
 {
-    mpTokenizer = DNEW Tokenizer();
+    mpTokenizer = DNEW Tokenizer( stream );
 }
 
 //==================================================================
@@ -52,130 +46,65 @@ Parser::~Parser()
 }
 
 //==================================================================
-void Parser::AddChar( char ch )
+/// A command takes all the values up to the next command, or to the
+/// end of the data. The values go straight into out_params, in one
+/// block for the whole command
+bool Parser::NextCommand(
+                    CmdID		&out_cmdID,
+                    ParamList	&out_params,
+                    int			&out_cmdLine )
 {
-    if ( ch == 0 )
+    out_params.clear();
+
+    while ( true )
     {
-        mCurCommand			= mNextCommand;
-        mCurCommandLine		= mNextCommandLine;
+        Tokenizer::DataType	dtype = mpTokenizer->NextToken( out_params );
 
-        if ( mpTokenizer->AddChar( '\n' ) )
-        {
-            mNextCommand		= mpTokenizer->GetDataAphaNum();
-            mNextCommandLine	= mpTokenizer->GetCurLineNumber();
-        }
-        else
-        {
-            mNextCommand		= "";
-            mNextCommandLine	= -1;
-        }
+        if ( dtype != Tokenizer::DT_ALPHANUMERIC &&
+             dtype != Tokenizer::DT_EOF )
+            continue;
 
-        mReachedEOF = true;
-        return;
-    }
+        // values before the first command go with it
+        bool	hadCommand = mHasNextCommand;
 
-    bool foundToken = mpTokenizer->AddChar( ch );
+        if ( hadCommand )
+        {
+            mCurCmdID	= mNextCmdID;
+            mCurUnknownName.swap( mNextUnknownName );
 
-    if NOT( foundToken )
-        return;
+            out_cmdID	= mCurCmdID;
+            out_cmdLine	= mNextCommandLine;
+        }
 
-    //printf( "> %s\t", Tokenizer::GetDataTypeName( mpTokenizer->GetDataType() ) );
+        if ( dtype == Tokenizer::DT_EOF )
+        {
+            mHasNextCommand = false;
+            out_params.ShrinkValues();
+            return hadCommand;
+        }
 
-    Param	*param = NULL;
+        mNextCmdID = mpTokenizer->GetDataAphaNumCmdID();
 
-    switch ( mpTokenizer->GetDataType() )
-    {
-    case Tokenizer::DT_ALPHANUMERIC:
-            mCurCommand			= mNextCommand;
-            mCurCommandLine		= mNextCommandLine;
-            mNextCommand		= mpTokenizer->GetDataAphaNum();
-            mNextCommandLine	= mpTokenizer->GetCurLineNumber();
-            break;
-            
-    case Tokenizer::DT_INT:
-            param = &Dgrow( mCurParams );
-            param->type				= Param::INT;
-            param->u.intVal			= mpTokenizer->GetDataInt();
-            break;
-    
-    case Tokenizer::DT_FLOAT:
-            param = &Dgrow( mCurParams );
-            param->type				= Param::FLT;
-            param->u.floatVal		= mpTokenizer->GetDataFloat();
-            break;
-    
-    case Tokenizer::DT_STRING:
-            param = &Dgrow( mCurParams );
-            param->type				= Param::STR;
-            param->u.stringVal		= mpTokenizer->GetDataString();
-            break;
-
-    case Tokenizer::DT_INT_ARRAY:
-            param = &Dgrow( mCurParams );
-            param->type				= Param::INT_ARR;
-            param->u.intArrayVal		= mpTokenizer->GetDataIntArray();
-            break;
-
-    case Tokenizer::DT_FLOAT_ARRAY:
-            param = &Dgrow( mCurParams );
-            param->type				= Param::FLT_ARR;
-            param->u.floatArrayVal	= mpTokenizer->GetDataFloatArray();
-            break;
-
-    case Tokenizer::DT_STRING_ARRAY:
-            param = &Dgrow( mCurParams );
-            param->type				= Param::STR_ARR;
-            param->u.stringArrayVal	= mpTokenizer->GetDataStringArray();
-            break;
-
-    default:
-            param = &Dgrow( mCurParams );
-            param->type = Param::UNKNOWN;
-            //puts( "Unknown !!!" );
-            break;
-    }
+        if ( mNextCmdID == CMDID_UNKNOWN )
+            mNextUnknownName.assign( mpTokenizer->GetDataAphaNum(), mpTokenizer->GetDataAphaNumLen() );
+        mNextCommandLine	= mpTokenizer->GetTokenLineNumber();
+        mHasNextCommand		= true;
 
-/*
-    switch ( mpTokenizer->GetDataType() )
-    {
-    case Tokenizer::DT_ALPHANUMERIC:printf( "%s \n", mpTokenizer->GetDataAphaNum() );	break;
-    case Tokenizer::DT_INT:			printf( "%i \n", mpTokenizer->GetDataInt()	);	break;
-    case Tokenizer::DT_FLOAT:		printf( "%f \n", mpTokenizer->GetDataFloat()	);	break;
-    case Tokenizer::DT_INT_ARRAY:	printArray( mpTokenizer->GetDataIntArray()	);	break;	
-    case Tokenizer::DT_FLOAT_ARRAY:	printArray( mpTokenizer->GetDataFloatArray()	);	break;
-    case Tokenizer::DT_STRING:		printf( "%s \n", mpTokenizer->GetDataString()	);	break;
-    
-    default:
-        puts( "Unknown !!!" );
-        break;
+        if ( hadCommand )
+        {
+            out_params.ShrinkValues();
+            return true;
+        }
     }
-*/		
-    mpTokenizer->ResetState();
 }
 
 //==================================================================
-void Parser::FlushNewCommand( DStr		*out_pCmdName,
-                              ParamList	*out_pParams,
-                              int		*out_pCmdLine )
+const char *Parser::GetCommandName() const
 {
-    *out_pCmdName	= mCurCommand;
-    *out_pCmdLine	= mCurCommandLine;
-    *out_pParams	= mCurParams;
-
-    mCurParams.clear();
-
-    if ( mReachedEOF )
-    {
-        mCurCommand			= mNextCommand;
-        mCurCommandLine		= mNextCommandLine;
+    if ( mCurCmdID == CMDID_UNKNOWN )
+        return mCurUnknownName.c_str();
 
-        mNextCommand		= "";
-        mNextCommandLine	= -1;
-    }
-    else
-    {
-        mCurCommand			= "";	
-    }
+    return RI::GetCommandName( mCurCmdID );
 }
 
 //==================================================================
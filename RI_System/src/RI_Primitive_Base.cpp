@@ -61,9 +61,13 @@ void SimplePrimitiveBase::Split( Hider &hider, bool uSplit, bool vSplit )
                     pPrimsSU[i]->mVRange[1] = vMid;
                     pNewPrim->mVRange[0] = vMid;
                     hider.InsertSplitted( pNewPrim, *pPrimsSU[i] );
+                    pNewPrim->matchMotionCloseRange();
                 }
             }
         }
+
+        pPrimsSU[0]->matchMotionCloseRange();
+        pPrimsSU[1]->matchMotionCloseRange();
     }
     else
     {
@@ -79,10 +83,91 @@ void SimplePrimitiveBase::Split( Hider &hider, bool uSplit, bool vSplit )
 
             hider.InsertSplitted( pPrim1, *this );
             hider.InsertSplitted( pPrim2, *this );
+
+            pPrim1->matchMotionCloseRange();
+            pPrim2->matchMotionCloseRange();
         }
     }
 }
 
+//==================================================================
+/// Give a split primitive its own piece of the shape at the last
+/// motion key, so that the bounds stay tight
+void SimplePrimitiveBase::matchMotionCloseRange()
+{
+    if NOT( mpMotionClose )
+        return;
+
+    SimplePrimitiveBase	*pClose = ((const SimplePrimitiveBase *)mpMotionClose)->Clone();
+
+    pClose->mURange[0] = mURange[0];
+    pClose->mURange[1] = mURange[1];
+    pClose->mVRange[0] = mVRange[0];
+    pClose->mVRange[1] = mVRange[1];
+
+    SetMotionClose( pClose, mMotionBlend );
+}
+
+//==================================================================
+bool SimplePrimitiveBase::IsMoving() const
+{
+    return mpMotionClose || mpTransform->IsMoving();
+}
+
+//==================================================================
+static void expandBound( Bound &bound, const Bound &other )
+{
+    bound.Expand( other.mBox[0] );
+    bound.Expand( other.mBox[1] );
+}
+
+//==================================================================
+float SimplePrimitiveBase::RasterEstimate( const Hider &hider, int out_bound2d[4] ) const
+{
+    Float3_	testDicePo[ MAX_MAKE_BOUND_OUT_SIZE ];
+
+    Bound	bound;
+    bound.Reset();
+    MakeBound( bound, testDicePo );
+
+    if NOT( IsMoving() )
+        return hider.RasterEstimate( bound, mpTransform->GetMatrix(), out_bound2d );
+
+    // the blended shapes are inside the bound of the two keys
+    if ( mpMotionClose )
+    {
+        Bound	boundClose;
+        boundClose.Reset();
+        ((const SimplePrimitiveBase *)mpMotionClose)->MakeBound( boundClose, testDicePo );
+
+        if ( boundClose.IsValid() )
+            expandBound( bound, boundClose );
+    }
+
+    int		boundClose2d[4];
+    float	areaOpen  = hider.RasterEstimate( bound, mpTransform->GetMatrix(), out_bound2d );
+    float	areaClose = hider.RasterEstimate( bound, mpTransform->GetMatrixClose(), boundClose2d );
+
+    if ( areaClose < RI_EPSILON )
+        return areaOpen;
+
+    if ( areaOpen < RI_EPSILON )
+    {
+        for (size_t i=0; i < 4; ++i)
+            out_bound2d[i] = boundClose2d[i];
+
+        return areaClose;
+    }
+
+    // the micro-polygons move on a straight line on screen
+    out_bound2d[0] = DMIN( out_bound2d[0], boundClose2d[0] );
+    out_bound2d[1] = DMIN( out_bound2d[1], boundClose2d[1] );
+    out_bound2d[2] = DMAX( out_bound2d[2], boundClose2d[2] );
+    out_bound2d[3] = DMAX( out_bound2d[3], boundClose2d[3] );
+
+    return DMAX( areaOpen, areaClose );
+}
+
 //==================================================================
 void SimplePrimitiveBase::fillUVsArray(
                                     Float2_ out_locUV[],
@@ -175,28 +260,33 @@ void SimplePrimitiveBase::fillUVsArray(
 }
 
 //==================================================================
-void SimplePrimitiveBase::Dice(
+/// Normals matrix and colors of the grid, common to all the dicing
+void SimplePrimitiveBase::setupDice(
                     WorkGrid &g,
-                    bool doColorCoded ) const
+                    bool doColorCoded,
+                    SlColor &out_useColor,
+                    SlColor &out_useOpa ) const
 {
-    //Float3_	*pP = g.mpPointsCS;
+    // stitched grids only use part of the padded width
+    if ( mDiceSegs[0] )
+    {
+        DASSERT( mDiceSegs[0] < g.mXDim && mDiceSegs[1] == g.mYDim-1 );
 
-    // NOTE: all spatial and directional values are in "current" (camera) space
-    Float3_	*pP		= (Float3_	*)g.mSymbolIs.FindSymbolIData( "P"	);
-    Float_	*pOODu	= (Float_	*)g.mSymbolIs.FindSymbolIData( "_oodu" );
-    Float_	*pOODv	= (Float_	*)g.mSymbolIs.FindSymbolIData( "_oodv" );
-    Float_	*pu		= (Float_	*)g.mSymbolIs.FindSymbolIData( "u" );
-    Float_	*pv		= (Float_	*)g.mSymbolIs.FindSymbolIData( "v" );
-    Float3_	*pI		= (Float3_	*)g.mSymbolIs.FindSymbolIData( "I"	);
-    Float3_	*pN		= (Float3_	*)g.mSymbolIs.FindSymbolIData( "N"	);
-    Float3_	*pNg	= (Float3_	*)g.mSymbolIs.FindSymbolIData( "Ng"	);
-    SlColor	*pOs	= (SlColor	*)g.mSymbolIs.FindSymbolIData( "Os"	);
-    SlColor	*pCs	= (SlColor	*)g.mSymbolIs.FindSymbolIData( "Cs"	);
+        g.mXSegs = mDiceSegs[0];
+        g.mYSegs = mDiceSegs[1];
 
-    DASSERT( pP == g.mpPointsCS );
+        for (u_int i=0; i < 4; ++i)
+            g.mEdgeSegs[i] = mDiceEdgeSegs[i];
 
-    float	du = 1.0f / (g.mXDim-1);
-    float	dv = 1.0f / (g.mYDim-1);
+        if ( g.mXSegs < g.mXDim-1 )
+        {
+            for (u_int y=0; y < g.mYDim; ++y)
+                for (u_int x=0; x < g.mXDim; ++x)
+                    g.mpMPHoles[ y * g.mXDim + x ] = (x >= g.mXSegs);
+
+            g.mHasHoles = true;
+        }
+    }
 
     Matrix44 mtxLocalCameraNorm = g.mMtxLocalCamera.GetAs33();
 
@@ -205,11 +295,6 @@ void SimplePrimitiveBase::Dice(
 
     g.mMtxLocalCameraNorm	= mtxLocalCameraNorm;
 
-    Float3	camPosCS = g.mMtxWorldCamera.GetTranslation();
-
-    SlColor	useColor;
-    SlColor	useOpa;
-
     if ( doColorCoded )
     {
         const static float c0 = 0.0f;
@@ -254,14 +339,47 @@ void SimplePrimitiveBase::Dice(
 */
         static int cnt;
 
-        useColor = palette[ cnt++ & 15 ];
-        useOpa	 = SlColor( 1, 1, 1 );
+        out_useColor = palette[ cnt++ & 15 ];
+        out_useOpa	 = SlColor( 1, 1, 1 );
     }
     else
     {
-        useColor = mpAttribs->mColor;
-        useOpa	 = mpAttribs->mOpacity;
+        out_useColor = mpAttribs->mColor;
+        out_useOpa	 = mpAttribs->mOpacity;
     }
+}
+
+//==================================================================
+void SimplePrimitiveBase::Dice(
+                    WorkGrid &g,
+                    bool doColorCoded ) const
+{
+    //Float3_	*pP = g.mpPointsCS;
+
+    // NOTE: all spatial and directional values are in "current" (camera) space
+    Float3_	*pP		= (Float3_	*)g.mSymbolIs.FindSymbolIData( "P"	);
+    Float_	*pOODu	= (Float_	*)g.mSymbolIs.FindSymbolIData( "_oodu" );
+    Float_	*pOODv	= (Float_	*)g.mSymbolIs.FindSymbolIData( "_oodv" );
+    Float_	*pu		= (Float_	*)g.mSymbolIs.FindSymbolIData( "u" );
+    Float_	*pv		= (Float_	*)g.mSymbolIs.FindSymbolIData( "v" );
+    Float3_	*pI		= (Float3_	*)g.mSymbolIs.FindSymbolIData( "I"	);
+    Float3_	*pN		= (Float3_	*)g.mSymbolIs.FindSymbolIData( "N"	);
+    Float3_	*pNg	= (Float3_	*)g.mSymbolIs.FindSymbolIData( "Ng"	);
+    SlColor	*pOs	= (SlColor	*)g.mSymbolIs.FindSymbolIData( "Os"	);
+    SlColor	*pCs	= (SlColor	*)g.mSymbolIs.FindSymbolIData( "Cs"	);
+
+    DASSERT( pP == g.mpPointsCS );
+
+    Float3	camPosCS = g.mMtxWorldCamera.GetTranslation();
+
+    SlColor	useColor;
+    SlColor	useOpa;
+    setupDice( g, doColorCoded, useColor, useOpa );
+
+    float	du = 1.0f / g.mXSegs;
+    float	dv = 1.0f / g.mYSegs;
+
+    const Matrix44	&mtxLocalCameraNorm = g.mMtxLocalCameraNorm;
 
     // build the UVs
     Float2_	locUV[ MP_GRID_MAX_SIZE_SIMD_BLKS ];
@@ -351,7 +469,58 @@ void SimplePrimitiveBase::Dice(
 }
 
 //==================================================================
-bool ParamsFindP(	ParamList &params,
+/// Positions at shutter close, stored as offsets from the ones at
+/// shutter open, so that they follow the displacement.
+/// Deforming shapes also get their positions at shutter open blended
+/// toward the last key
+void SimplePrimitiveBase::DiceMotion( WorkGrid &g ) const
+{
+    g.mIsMoving = true;
+    g.mMtxLocalCameraClose = mpTransform->GetMatrixClose() * g.mMtxWorldCamera;
+
+    size_t	blocksN = DMT_SIMD_BLOCKS( g.mPointsN );
+
+    if NOT( mpMotionClose )
+    {
+        // same shape, just moved to where it is at shutter close
+        Matrix44	mtxOpenClose = g.mMtxCameraLocal * g.mMtxLocalCameraClose;
+
+        for (size_t blkIdx=0; blkIdx < blocksN; ++blkIdx)
+        {
+            const Float3_	&posCS = g.mpPointsCS[ blkIdx ];
+
+            g.mpMotionCS[ blkIdx ] = V3__V3W1_Mul_M44<Float_>( posCS, mtxOpenClose ) - posCS;
+        }
+
+        return;
+    }
+
+    const SimplePrimitiveBase	*pClose = (const SimplePrimitiveBase *)mpMotionClose;
+
+    Float2_	locUV[ MP_GRID_MAX_SIZE_SIMD_BLKS ];
+
+    fillUVsArray( locUV, 1.0f / g.mXSegs, 1.0f / g.mYSegs, g.mXDim, g.mYDim );
+
+    Float_	blendOpen( mMotionBlend[0] );
+    Float_	blendClose( mMotionBlend[1] );
+
+    for (size_t blkIdx=0; blkIdx < blocksN; ++blkIdx)
+    {
+        Float3_	posLS;
+        Float3_	posKeyLS;
+        EvalP( locUV[blkIdx], posLS );
+        pClose->EvalP( locUV[blkIdx], posKeyLS );
+
+        Float3_	posOpenCS  = V3__V3W1_Mul_M44<Float_>( DMix( posLS, posKeyLS, blendOpen ), g.mMtxLocalCamera );
+        Float3_	posCloseCS = V3__V3W1_Mul_M44<Float_>( DMix( posLS, posKeyLS, blendClose ), g.mMtxLocalCameraClose );
+
+        g.mpPointsCS[ blkIdx ] = posOpenCS;
+        g.mpMotionCS[ blkIdx ] = posCloseCS - posOpenCS;
+    }
+}
+
+//==================================================================
+bool ParamsFindP(	const ParamList &params,
                     const SymbolList &globalSymbols,
                     DVec<Float3> &out_vectorP,
                     int fromIdx )
@@ -367,7 +536,7 @@ bool ParamsFindP(	ParamList &params,
         {
             DASSTHROW( (i+1) < params.size(), "Invalid number of arguments" );
             
-            const FltVec	&fltVec = params[ i+1 ].NumVec();
+            const FltView	fltVec = params[ i+1 ].NumVec();
             
             DASSTHROW( (fltVec.size() % 3) == 0, "Invalid number of arguments" );
             
@@ -384,7 +553,7 @@ bool ParamsFindP(	ParamList &params,
 }
 
 //==================================================================
-bool ParamsFindP(	ParamList &params,
+bool ParamsFindP(	const ParamList &params,
                     const SymbolList &globalSymbols,
                     Float3	*pOut_vectorP,
                     int	expectedN,
@@ -401,7 +570,7 @@ bool ParamsFindP(	ParamList &params,
         {
             DASSTHROW( (i+1) < params.size(), "Invalid number of arguments" );
             
-            const FltVec	&fltVec = params[ i+1 ].NumVec();
+            const FltView	fltVec = params[ i+1 ].NumVec();
 
             DASSTHROW( (int)fltVec.size() == 3 * expectedN,
                             "Invalid number of arguments."
@@ -423,6 +592,84 @@ bool ParamsFindP(	ParamList &params,
     return false;
 }
 
+//==================================================================
+/// Estimate the raster length of the primitive along u and v, by
+/// projecting a small test grid and taking the longest row and column.
+/// Returns false if the grid cannot be projected
+bool SimplePrimitiveBase::estimateRasterLenUV(
+                            const Hider &hider,
+                            const Matrix44 &mtxLocalWorld,
+                            float &out_lenU,
+                            float &out_lenV,
+                            float out_edgeLens[4] ) const
+{
+    Float2_	locUV[ TEST_DICE_SIMD_BLOCKS ];
+    // clear the padding of the last block
+    locUV[ TEST_DICE_SIMD_BLOCKS - 1 ] = Float2_( 0.f, 0.f );
+
+    fillUVsArray(
+            locUV,
+            1.0f / (TEST_DICE_LEN - 1),
+            1.0f / (TEST_DICE_LEN - 1),
+            TEST_DICE_LEN,
+            TEST_DICE_LEN );
+
+    Float3	testPo[ TEST_DICE_LEN * TEST_DICE_LEN ];
+
+    for (u_int i=0; i < TEST_DICE_SIMD_BLOCKS; ++i)
+    {
+        Float3_	posLS;
+        EvalP( locUV[i], posLS );
+
+        for (u_int sub=0; sub < DMT_SIMD_FLEN; ++sub)
+        {
+            u_int	idx = i * DMT_SIMD_FLEN + sub;
+            if ( idx < TEST_DICE_LEN * TEST_DICE_LEN )
+                testPo[idx] = Float3( posLS[0][sub], posLS[1][sub], posLS[2][sub] );
+        }
+    }
+
+    Float2	testWin[ TEST_DICE_LEN * TEST_DICE_LEN ];
+
+    if NOT( hider.RasterProject(
+                        testPo,
+                        TEST_DICE_LEN * TEST_DICE_LEN,
+                        mtxLocalWorld,
+                        testWin ) )
+        return false;
+
+    out_lenU = 0;
+    out_lenV = 0;
+    for (u_int i=0; i < TEST_DICE_LEN; ++i)
+    {
+        float	rowLen = 0;
+        float	colLen = 0;
+        for (u_int j=1; j < TEST_DICE_LEN; ++j)
+        {
+            rowLen += (testWin[i*TEST_DICE_LEN+j] - testWin[i*TEST_DICE_LEN+j-1]).GetLength();
+            colLen += (testWin[j*TEST_DICE_LEN+i] - testWin[(j-1)*TEST_DICE_LEN+i]).GetLength();
+        }
+
+        out_lenU = DMAX( out_lenU, rowLen );
+        out_lenV = DMAX( out_lenV, colLen );
+
+        // borders v=0, u=1, v=1, u=0
+        if ( i == 0 )
+        {
+            out_edgeLens[0] = rowLen;
+            out_edgeLens[3] = colLen;
+        }
+        else
+        if ( i == TEST_DICE_LEN-1 )
+        {
+            out_edgeLens[2] = rowLen;
+            out_edgeLens[1] = colLen;
+        }
+    }
+
+    return true;
+}
+
 //==================================================================
 SimplePrimitiveBase::CheckSplitRes
     SimplePrimitiveBase::CheckForSplit(
@@ -431,104 +678,169 @@ SimplePrimitiveBase::CheckSplitRes
                             bool		&out_uSplit,
                             bool		&out_vSplit )
 {
-    const Matrix44 &mtxLocalWorld = mpTransform->GetMatrix();
-
     DASSERT( mDiceGridWd == -1 && mDiceGridHe == -1 );
 
-    Float3_	testDicePo[ MAX_MAKE_BOUND_OUT_SIZE ];
+    float pixelArea = RasterEstimate( hider, out_bound2d );
 
-    Bound	bound;
-    bound.Reset();
+    if ( pixelArea < RI_EPSILON )
+    {
+        return CHECKSPLITRES_CULL;
+    }
 
-    MakeBound( bound, testDicePo );
+    return CheckDiceOrSplit( hider, pixelArea, out_uSplit, out_vSplit );
+}
 
-    float pixelArea = hider.RasterEstimate( bound, mtxLocalWorld, out_bound2d );
-    
-    if ( pixelArea <= MP_GRID_MAX_SIZE )
-    {
-        if ( pixelArea < RI_EPSILON )
-        {
-            return CHECKSPLITRES_CULL;
-        }
+//==================================================================
+static u_int ceilPow2( u_int val )
+{
+    u_int	pow2 = 1;
+    while ( pow2 < val )
+        pow2 <<= 1;
+
+    return pow2;
+}
 
-        float	dim = DSqrt( pixelArea );
+//==================================================================
+/// Each border gets a power-of-two rate from its own length only, so
+/// that the primitive on the other side picks the same one. The grid
+/// is diced at multiples of those, and WorkGrid::Stitch() brings the
+/// borders back to their rate after displacement.
+/// Returns false if the grid would be too large
+bool SimplePrimitiveBase::setDiceSegs(
+                            float lenU,
+                            float lenV,
+                            const float edgeLens[4],
+                            float mpSide )
+{
+    float	segsUF = ceilf( lenU / mpSide );
+    float	segsVF = ceilf( lenV / mpSide );
 
-        mDiceGridWd = DMT_SIMD_PADSIZE( (int)ceilf( dim ) );
-        mDiceGridHe = (int)ceilf( dim );
+    // check in float first, the lengths may be arbitrarily large
+    if ( segsUF >= (float)MP_GRID_MAX_DIM ||
+         segsVF >= (float)MP_GRID_MAX_DIM )
+        return false;
 
-        out_uSplit = false;
-        out_vSplit = false;
+    u_int	edgeSegs[4];
+    for (u_int i=0; i < 4; ++i)
+    {
+        float	segsF = ceilf( edgeLens[i] / mpSide );
 
-        return CHECKSPLITRES_DICE;	// will dice
+        if ( segsF >= (float)MP_GRID_MAX_DIM )
+            return false;
+
+        edgeSegs[i] = ceilPow2( DMAX( 1, (int)segsF ) );
     }
-    else
-    {
-#if 0
-        SlVec2	locUV[ TEST_DICE_SIMD_BLOCKS ];
-        // set last item to 0 to be safe when using the AddReduce() later on
-        locUV[ TEST_DICE_SIMD_BLOCKS - 1 ] = SlVec2( 0.f, 0.f );
-
-        fillUVsArray(
-                locUV,
-                1.0f / (TEST_DICE_LEN - 1),
-                1.0f / (TEST_DICE_LEN - 1),
-                TEST_DICE_LEN,
-                TEST_DICE_LEN );
-
-        //Float3_	avg_dPdu( 0.f, 0.f, 0.f );
-        //Float3_	avg_dPdv( 0.f, 0.f, 0.f );
-        SlScalar	avg_dPdu( 0.f );
-        SlScalar	avg_dPdv( 0.f );
-        for (u_int i=0; i < TEST_DICE_SIMD_BLOCKS; ++i)
-        {
-            SlVec3	posLS;
-            SlVec3	dPdu;
-            SlVec3	dPdv;
 
-            Eval_dPdu_dPdv( locUV[ i ], posLS, &dPdu, &dPdv );
+    // the grid must have all the vertices of its borders
+    u_int	stepU = DMAX( edgeSegs[0], edgeSegs[2] );
+    u_int	stepV = DMAX( edgeSegs[1], edgeSegs[3] );
 
-            avg_dPdu += dPdu.GetLengthSqr();
-            avg_dPdv += dPdv.GetLengthSqr();
-        }
+    u_int	segsU = (DMAX( 1, (int)segsUF ) + stepU - 1) / stepU * stepU;
+    u_int	segsV = (DMAX( 1, (int)segsVF ) + stepV - 1) / stepV * stepV;
 
-        // divide by the total number of elements 
-        //avg_dPdu /= (float)TEST_DICE_SIMD_BLOCKS * DMT_SIMD_FLEN;
-        //avg_dPdv /= (float)TEST_DICE_SIMD_BLOCKS * DMT_SIMD_FLEN;
-/*
+    int	wd = DMT_SIMD_PADSIZE( (int)segsU + 1 );
+    int	he = (int)segsV + 1;
 
-        Float3 avg_dPdu_s(
-                avg_dPdu.x().AddReduce(),	// avg_dPdu.x()[0] + avg_dPdu.x()[1] ...
-                avg_dPdu.y().AddReduce(),
-                avg_dPdu.z().AddReduce() );
+    if ( wd > (int)MP_GRID_MAX_DIM ||
+         (u_int)(wd * he) > MP_GRID_MAX_SIZE )
+        return false;
 
-        Float3 avg_dPdv_s(
-                avg_dPdv.x().AddReduce(),	// avg_dPdv.x()[0] + avg_dPdv.x()[1] ...
-                avg_dPdv.y().AddReduce(),
-                avg_dPdv.z().AddReduce() );
-*/
+    mDiceGridWd = wd;
+    mDiceGridHe = he;
+
+    mDiceSegs[0] = segsU;
+    mDiceSegs[1] = segsV;
+
+    for (u_int i=0; i < 4; ++i)
+        mDiceEdgeSegs[i] = edgeSegs[i];
+
+    return true;
+}
+
+//==================================================================
+/// Choose the dicing rates, or the split direction, without culling.
+/// pixelArea is only used when the primitive can't be projected
+SimplePrimitiveBase::CheckSplitRes
+    SimplePrimitiveBase::CheckDiceOrSplit(
+                            const Hider &hider,
+                            float		pixelArea,
+                            bool		&out_uSplit,
+                            bool		&out_vSplit )
+{
+    const Matrix44 &mtxLocalWorld = mpTransform->GetMatrix();
 
-        float lenU = avg_dPdu.AddReduce();
-        float lenV = avg_dPdv.AddReduce();
+    // micropolygons side in pixels
+    float	shadingRate = mpAttribs->mShadingRate;
+    float	mpSide = DSqrt( shadingRate );
 
-        if ( lenU < lenV )
+    clearDiceSegs();
+
+    float	lenU;
+    float	lenV;
+    float	edgeLens[4];
+    if NOT( estimateRasterLenUV( hider, mtxLocalWorld, lenU, lenV, edgeLens ) )
+    {
+        // can't project the test grid, fall back to the screen bound
+        if ( pixelArea / shadingRate <= MP_GRID_MAX_SIZE )
         {
+            float	dim = DMAX( 2.f, ceilf( DSqrt( pixelArea / shadingRate ) ) );
+
+            mDiceGridWd = DMT_SIMD_PADSIZE( (int)dim );
+            mDiceGridHe = (int)dim;
+
             out_uSplit = false;
-            out_vSplit = true;
-        }
-        else
-        {
-            out_uSplit = true;
             out_vSplit = false;
+
+            return CHECKSPLITRES_DICE;	// will dice
         }
 
-#else
         out_uSplit = true;
         out_vSplit = true;
 
-#endif
-
         return CHECKSPLITRES_SPLIT;	// will split
     }
+
+    // vertices needed along u and v
+    float	dimU = DMAX( 2.f, ceilf( lenU / mpSide ) + 1 );
+    float	dimV = DMAX( 2.f, ceilf( lenV / mpSide ) + 1 );
+
+    // displaced primitives need rates that can be stitched
+    if ( mpAttribs->moDisplaceSHI.get() )
+    {
+        if ( setDiceSegs( lenU, lenV, edgeLens, mpSide ) )
+        {
+            out_uSplit = false;
+            out_vSplit = false;
+
+            return CHECKSPLITRES_DICE;	// will dice
+        }
+    }
+    else
+    // check in float first, the lengths may be arbitrarily large
+    if ( dimU <= (float)MP_GRID_MAX_DIM &&
+         dimV <= (float)MP_GRID_MAX_DIM )
+    {
+        int	wd = DMT_SIMD_PADSIZE( (int)dimU );
+        int	he = (int)dimV;
+
+        if ( wd <= (int)MP_GRID_MAX_DIM &&
+             (u_int)(wd * he) <= MP_GRID_MAX_SIZE )
+        {
+            mDiceGridWd = wd;
+            mDiceGridHe = he;
+
+            out_uSplit = false;
+            out_vSplit = false;
+
+            return CHECKSPLITRES_DICE;	// will dice
+        }
+    }
+
+    // split only along the longer direction, unless the two are similar
+    out_uSplit = (dimU * 2 >= dimV);
+    out_vSplit = (dimV * 2 >= dimU);
+
+    return CHECKSPLITRES_SPLIT;	// will split
 }
 
 //==================================================================
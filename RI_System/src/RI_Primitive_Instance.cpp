@@ -0,0 +1,98 @@
+//==================================================================
+/// RI_Primitive_Instance.cpp
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info. 
+//==================================================================
+
+#include "stdafx.h"
+#include "RI_Attributes.h"
+#include "RI_Transform.h"
+#include "RI_Primitive_Instance.h"
+
+//==================================================================
+namespace RI
+{
+
+//==================================================================
+/// ObjectDef
+//==================================================================
+ObjectDef::ObjectDef() :
+    mIsSimplified(false)
+{
+    mBound.Reset();
+}
+
+//==================================================================
+ObjectDef::~ObjectDef()
+{
+    for (size_t ci=0; ci < mSplitCaches.size(); ++ci)
+        for (size_t j=0; j < mSplitCaches[ci].mpLeaves.size(); ++j)
+            mSplitCaches[ci].mpLeaves[j]->Release();
+
+    for (size_t i=0; i < mpSimplePrims.size(); ++i)		mpSimplePrims[i]->Release();
+    for (size_t i=0; i < mpPrims.size(); ++i)			mpPrims[i]->Release();
+    for (size_t i=0; i < mpUniqueAttribs.size(); ++i)	DDELETE( mpUniqueAttribs[i] );
+    for (size_t i=0; i < mpUniqueTransform.size(); ++i)	DDELETE( mpUniqueTransform[i] );
+}
+
+//==================================================================
+void ObjectDef::Insert(
+                        PrimitiveBase		*pPrim,
+                        const Attributes	&attr,
+                        const Transform		&xform )
+{
+    if ( mAttrsRev.Sync( *attr.mpRevision ) )
+        mpUniqueAttribs.push_back( DNEW Attributes( attr ) );
+
+    if ( mTransRev.Sync( *xform.mpRevision ) )
+        mpUniqueTransform.push_back( DNEW Transform( xform ) );
+
+    pPrim->SetStates(
+                mpUniqueAttribs.back(),
+                mpUniqueTransform.back()
+                );
+
+    mpPrims.push_back( pPrim->Borrow() );
+}
+
+//==================================================================
+/// takes the reference of the primitive
+void ObjectDef::AddSimplified( SimplePrimitiveBase *pPrim )
+{
+    u_int	xformIdx = 0;
+    while ( mpUniqueTransform[ xformIdx ] != pPrim->mpTransform )
+    {
+        xformIdx += 1;
+        DASSERT( xformIdx < mpUniqueTransform.size() );
+    }
+
+    mpSimplePrims.push_back( pPrim );
+    mSimplePrimXFormIdx.push_back( xformIdx );
+
+    // expand the object's bound with the primitive's one
+    Float3_	testDicePo[ SimplePrimitiveBase::MAX_MAKE_BOUND_OUT_SIZE ];
+
+    Bound	primBound;
+    primBound.Reset();
+    pPrim->MakeBound( primBound, testDicePo );
+
+    if NOT( primBound.IsValid() )
+        return;
+
+    const Matrix44 &mtx = pPrim->mpTransform->GetMatrix();
+
+    for (u_int i=0; i < 8; ++i)
+    {
+        Float3	corner(
+                    primBound.mBox[ (i >> 0) & 1 ][0],
+                    primBound.mBox[ (i >> 1) & 1 ][1],
+                    primBound.mBox[ (i >> 2) & 1 ][2] );
+
+        mBound.Expand( V3__V3W1_Mul_M44<float>( corner, mtx ) );
+    }
+}
+
+//==================================================================
+}
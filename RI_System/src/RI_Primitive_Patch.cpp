@@ -22,7 +22,7 @@ PatchMesh::PatchMesh( RtToken type,
                       ParamList &params,
                       const SymbolList &globalSymbols ) :
     ComplexPrimitiveBase(PATCHMESH),
-    mParams(params)
+    moParams(DNEW ParamListRC( params ))
 {
     mpPatchType = globalSymbols.FindSymbol( type );
 }
@@ -33,20 +33,22 @@ void PatchMesh::Simplify( Hider &hider )
     // PatchMesh "bilinear" 2 "nonperiodic" 5 "nonperiodic" "P"  [ -0.995625 2 -0.495465 ...
     //               0      1       2       3       4        5     6
 
-    int				nu		= mParams[1];
-    const Symbol*	pyUWrap = hider.mpGlobalSyms->FindSymbol( mParams[2] );
-    int				nv		= mParams[3];
-    const Symbol*	pyVWrap = hider.mpGlobalSyms->FindSymbol( mParams[4] );
+    const ParamList	&params = moParams->mList;
+
+    int				nu		= params[1];
+    const Symbol*	pyUWrap = hider.mpGlobalSyms->FindSymbol( params[2] );
+    int				nv		= params[3];
+    const Symbol*	pyVWrap = hider.mpGlobalSyms->FindSymbol( params[4] );
 
     bool	uPeriodic = pyUWrap->IsName( RI_PERIODIC );
     bool	vPeriodic = pyVWrap->IsName( RI_PERIODIC );
         
-    int	PValuesParIdx = FindParam( "P", Param::FLT_ARR, 5, mParams );
+    int	PValuesParIdx = FindParam( "P", Param::FLT_ARR, 5, params );
     if ( PValuesParIdx == -1 )
         return;
     
     int			meshHullSize = 3 * nu * nv;
-    const float	*pMeshHull = mParams[PValuesParIdx].PFlt( meshHullSize );
+    const float	*pMeshHull = params[PValuesParIdx].PFlt( meshHullSize );
 
     if ( mpPatchType->IsName( RI_BILINEAR ) )
     {
@@ -69,7 +71,7 @@ void PatchMesh::Simplify( Hider &hider )
                 hullv3[3] = Float3( &pMeshHull[(ii+nu*jj)*3] );
 
                 hider.InsertSimple(
-                        DNEW RI::PatchBilinear( mParams, hullv3 ),
+                        DNEW RI::PatchBilinear( params, hullv3 ),
                         *this
                         );
             }
@@ -111,7 +113,7 @@ void PatchMesh::Simplify( Hider &hider )
                 }
 
                 hider.InsertSimple(
-                        DNEW RI::PatchBicubic( mParams, hullv3, attr, *hider.mpGlobalSyms ),
+                        DNEW RI::PatchBicubic( moParams.get(), hullv3, attr, *hider.mpGlobalSyms ),
                         *this
                         );
             }
@@ -127,7 +129,7 @@ void PatchMesh::Simplify( Hider &hider )
 }
 
 //==================================================================
-PatchBilinear::PatchBilinear( ParamList &params, const SymbolList &globalSymbols ) :
+PatchBilinear::PatchBilinear( const ParamList &params, const SymbolList &globalSymbols ) :
     SimplePrimitiveBase(PATCHBILINEAR)//,
     //mParams(params)
 {
@@ -142,7 +144,7 @@ PatchBilinear::PatchBilinear( ParamList &params, const SymbolList &globalSymbols
 }
 
 //==================================================================
-PatchBilinear::PatchBilinear( ParamList &params, const Float3 hull[4] ) :
+PatchBilinear::PatchBilinear( const ParamList &params, const Float3 hull[4] ) :
     SimplePrimitiveBase(PATCHBILINEAR)//,
     //mParams(params)
 {
@@ -150,6 +152,14 @@ PatchBilinear::PatchBilinear( ParamList &params, const Float3 hull[4] ) :
         mHullPos_sca[i] = hull[i];
 }
 
+//==================================================================
+PatchBilinear::PatchBilinear( const Float3 hull[4] ) :
+    SimplePrimitiveBase(PATCHBILINEAR)
+{
+    for (int i=0; i < 4; ++i)
+        mHullPos_sca[i] = hull[i];
+}
+
 /*
 //==================================================================
 void PatchBilinear::Eval_dPdu_dPdv(
@@ -207,7 +217,7 @@ void PatchBilinear::Eval_dPdu_dPdv(
 //==================================================================
 PatchBicubic::PatchBicubic( ParamList &params, const Attributes &attr, const SymbolList &globalSymbols ) :
     SimplePrimitiveBase(PATCHBICUBIC),
-    mParams(params)
+    moParams(DNEW ParamListRC( params ))
 {
     mpUBasis = &attr.GetUBasis();
     mpVBasis = &attr.GetVBasis();
@@ -220,13 +230,14 @@ PatchBicubic::PatchBicubic( ParamList &params, const Attributes &attr, const Sym
 }
 
 //==================================================================
-PatchBicubic::PatchBicubic( ParamList &params,
+PatchBicubic::PatchBicubic( const ParamListRC *pParams,
                             const Float3 hull[16],
                             const Attributes &attr,
                             const SymbolList &globalSymbols ) :
-    SimplePrimitiveBase(PATCHBICUBIC),
-    mParams(params)
+    SimplePrimitiveBase(PATCHBICUBIC)
 {
+    moParams = pParams;
+
     mpUBasis = &attr.GetUBasis();
     mpVBasis = &attr.GetVBasis();
 
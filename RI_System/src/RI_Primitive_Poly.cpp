@@ -23,7 +23,7 @@ namespace RI
 //==================================================================
 Polygon::Polygon( ParamList &params, const SymbolList &globalSymbols ) :
     ComplexPrimitiveBase(POLYGON),
-    mParams(params)
+    moParams(DNEW ParamListRC( params ))
 {
 }
 
@@ -33,7 +33,7 @@ static void simplifyAddTriangle(
                 const Float3 &v1,
                 const Float3 &v2,
                 const Float3 &v3,
-                ParamList &params,
+                const ParamList &params,
                 ComplexPrimitiveBase &srcPrim
                 )
 {
@@ -63,14 +63,16 @@ static void simplifyAddTriangle(
 //==================================================================
 void Polygon::Simplify( Hider &hider )
 {
-    int	PValuesParIdx = FindParam( "P", Param::FLT_ARR, 0, mParams );
+    const ParamList	&params = moParams->mList;
+
+    int	PValuesParIdx = FindParam( "P", Param::FLT_ARR, 0, params );
     if ( PValuesParIdx == -1 )
     {
         DASSTHROW( 0, ("Missing 'P'") );
         return;
     }
 
-    const FltVec	&paramP = mParams[PValuesParIdx].NumVec();
+    const FltView	paramP = params[PValuesParIdx].NumVec();
     
     int	last	= (int)paramP.size()/3 - 1;
     int	start	= 1;
@@ -86,7 +88,7 @@ void Polygon::Simplify( Hider &hider )
         patchVerts[3].Set( &paramP[3 * (start+1)] );
 
         hider.InsertSimple(
-                DNEW PatchBilinear( mParams, patchVerts ),
+                DNEW PatchBilinear( params, patchVerts ),
                 *this );
         
         start	= end;
@@ -100,7 +102,7 @@ void Polygon::Simplify( Hider &hider )
                         Float3( &paramP[3 * 0] ),
                         Float3( &paramP[3 * start] ),
                         Float3( &paramP[3 * end] ),
-                        mParams,
+                        params,
                         *this
                     );
     }
@@ -117,30 +119,59 @@ struct VertInfo
 };
 
 //==================================================================
-static void tessellateToBilinearPatches(
-                            Hider	 &hider,
-                            const FltVec &paramP,
+static U32 addMeshVert( PolyCluster::MeshDef &mesh, const Float3 &pos )
+{
+    mesh.mVerts.push_back( pos );
+
+    return (U32)mesh.mVerts.size() - 1;
+}
+
+//==================================================================
+static void addMeshQuad( PolyCluster::MeshDef &mesh, U32 i0, U32 i1, U32 i2, U32 i3 )
+{
+    U32	*pDes = Dgrow( mesh.mQuads, 4 );
+    pDes[0] = i0;
+    pDes[1] = i1;
+    pDes[2] = i2;
+    pDes[3] = i3;
+}
+
+//==================================================================
+/// Same tessellation as simplifyAddTriangle(), the new vertices are
+/// added to the mesh
+static void addMeshTriangle( PolyCluster::MeshDef &mesh, U32 i1, U32 i2, U32 i3 )
+{
+    Float3	v1 = mesh.mVerts[ i1 ];
+    Float3	v2 = mesh.mVerts[ i2 ];
+    Float3	v3 = mesh.mVerts[ i3 ];
+
+    U32	mid	= addMeshVert( mesh, (v1 + v2 + v3) * (1.0f/3) );
+    U32	a	= addMeshVert( mesh, (v1 + v2) * 0.5f );
+    U32	b	= addMeshVert( mesh, (v2 + v3) * 0.5f );
+    U32	c	= addMeshVert( mesh, (v1 + v3) * 0.5f );
+
+    addMeshQuad( mesh, i1, a, c, mid );
+    addMeshQuad( mesh, i2, a, b, mid );
+    addMeshQuad( mesh, i3, b, c, mid );
+}
+
+//==================================================================
+static void tessellateToMeshQuads(
+                            PolyCluster::MeshDef &mesh,
                             const int	 *pIndices,
-                            int			 indicesN,
-                            ParamList	 &primParams,
-                            ComplexPrimitiveBase &srcPrim )
+                            int			 indicesN )
 {
     int	last	= (int)indicesN - 1;
     int	start	= 1;
     int	end		= DMIN( (int)3, last );
 
-    Float3	patchVerts[4];
-
     while ( (end - start) == 2 )
     {
-        patchVerts[0].Set( &paramP[3 * pIndices[ 0			] ] );
-        patchVerts[1].Set( &paramP[3 * pIndices[ start		] ] );
-        patchVerts[2].Set( &paramP[3 * pIndices[ end		] ] );
-        patchVerts[3].Set( &paramP[3 * pIndices[ (start+1)	] ] );
-
-        hider.InsertSimple(
-                DNEW PatchBilinear( primParams, patchVerts ),
-                srcPrim );
+        addMeshQuad( mesh,
+                    pIndices[ 0			],
+                    pIndices[ start		],
+                    pIndices[ end		],
+                    pIndices[ (start+1)	] );
 
         start	= end;
         end		= DMIN( start+2, last );
@@ -148,14 +179,56 @@ static void tessellateToBilinearPatches(
 
     if ( (end - start) == 1 )
     {	
-        simplifyAddTriangle(
-                        hider,
-                        Float3( &paramP[3 * pIndices[ 0		] ] ),
-                        Float3( &paramP[3 * pIndices[ start	] ] ),
-                        Float3( &paramP[3 * pIndices[ end	] ] ),
-                        primParams,
-                        srcPrim
-                    );
+        addMeshTriangle( mesh,
+                    pIndices[ 0		],
+                    pIndices[ start	],
+                    pIndices[ end	] );
+    }
+}
+
+//==================================================================
+static PolyCluster::MeshDef *newMeshDef( const FltView &paramP )
+{
+    PolyCluster::MeshDef	*pMesh = DNEW PolyCluster::MeshDef();
+
+    pMesh->mVerts.resize( paramP.size() / 3 );
+
+    for (size_t i=0; i < pMesh->mVerts.size(); ++i)
+        pMesh->mVerts[i].Set( &paramP[ i * 3 ] );
+
+    return pMesh;
+}
+
+//==================================================================
+/// Many small quads are better diced together, unless the keys of a
+/// deforming mesh need to match one to one, or the grid is displaced:
+/// calculatenormal() doesn't know about the separate blocks
+static void insertMeshQuads(
+                    Hider &hider,
+                    PolyCluster::MeshDef *pMesh,
+                    ComplexPrimitiveBase &srcPrim )
+{
+    RCSha<PolyCluster::MeshDef>	oMesh( pMesh );
+
+    u_int	quadsN = pMesh->GetQuadsN();
+
+    if ( quadsN > 1 &&
+         NOT( srcPrim.mIsMotionKey ) &&
+         NOT( srcPrim.mpAttribs->moDisplaceSHI.get() ) )
+    {
+        pMesh->SortSpatially();
+
+        hider.InsertSimple( DNEW PolyCluster( pMesh, 0, quadsN ), srcPrim );
+        return;
+    }
+
+    Float3	patchVerts[4];
+
+    for (u_int i=0; i < quadsN; ++i)
+    {
+        pMesh->GetQuadHull( i, patchVerts );
+
+        hider.InsertSimple( DNEW PatchBilinear( patchVerts ), srcPrim );
     }
 }
 
@@ -164,7 +237,7 @@ static void tessellateToBilinearPatches(
 //==================================================================
 PointsPolygons::PointsPolygons( ParamList &params, const SymbolList &globalSymbols ) :
     ComplexPrimitiveBase(POINTSGENERALPOLYGONS),
-    mParams(params)
+    moParams(DNEW ParamListRC( params ))
 {
 }
 
@@ -212,17 +285,19 @@ static void buildVInfoForPoly( const ParamList &params, size_t fromParamIdx, int
 //==================================================================
 void PointsPolygons::Simplify( Hider &hider )
 {
-    size_t		nvertsN = mParams[0].IntArrSize();
-    const int	*pNVerts = mParams[0].PInt();
+    const ParamList	&params = moParams->mList;
+
+    size_t		nvertsN = params[0].IntArrSize();
+    const int	*pNVerts = params[0].PInt();
 
-    size_t		vertsN = mParams[1].IntArrSize();
-    const int	*pVerts = mParams[1].PInt();
+    size_t		vertsN = params[1].IntArrSize();
+    const int	*pVerts = params[1].PInt();
 
     VertInfo	vinfo[MAX_VERT_INFO];
     int			PValuesParIdx;
-    buildVInfoForPoly( mParams, 2, PValuesParIdx, vinfo );
+    buildVInfoForPoly( params, 2, PValuesParIdx, vinfo );
 
-    const FltVec	&paramP = mParams[PValuesParIdx].NumVec();
+    PolyCluster::MeshDef	*pMesh = newMeshDef( params[PValuesParIdx].NumVec() );
 
     size_t nVertsIdx	= 0;
     size_t idxVertsIdx	= 0;
@@ -235,16 +310,15 @@ void PointsPolygons::Simplify( Hider &hider )
 
         DASSERT( (nVertsIdx+nVerts) <= vertsN );
 
-        tessellateToBilinearPatches(
-                        hider,
-                        paramP,
+        tessellateToMeshQuads(
+                        *pMesh,
                         &pVerts[ idxVertsIdx ],
-                        nVerts,
-                        mParams,
-                        *this );
+                        nVerts );
 
         idxVertsIdx += nVerts;
     }
+
+    insertMeshQuads( hider, pMesh, *this );
 }
 
 //==================================================================
@@ -252,27 +326,29 @@ void PointsPolygons::Simplify( Hider &hider )
 //==================================================================
 PointsGeneralPolygons::PointsGeneralPolygons( ParamList &params, const SymbolList &globalSymbols ) :
     ComplexPrimitiveBase(POINTSGENERALPOLYGONS),
-    mParams(params)
+    moParams(DNEW ParamListRC( params ))
 {
 }
 
 //==================================================================
 void PointsGeneralPolygons::Simplify( Hider &hider )
 {
-    size_t		nloopsN = mParams[0].IntArrSize();
-    const int	*pNLoops = mParams[0].PInt();
+    const ParamList	&params = moParams->mList;
+
+    size_t		nloopsN = params[0].IntArrSize();
+    const int	*pNLoops = params[0].PInt();
 
-    size_t		nvertsN = mParams[1].IntArrSize();
-    const int	*pNVerts = mParams[1].PInt();
+    size_t		nvertsN = params[1].IntArrSize();
+    const int	*pNVerts = params[1].PInt();
 
-    size_t		vertsN = mParams[2].IntArrSize();
-    const int	*pVerts = mParams[2].PInt();
+    size_t		vertsN = params[2].IntArrSize();
+    const int	*pVerts = params[2].PInt();
 
     VertInfo	vinfo[MAX_VERT_INFO];
     int			PValuesParIdx;
-    buildVInfoForPoly( mParams, 3, PValuesParIdx, vinfo );
+    buildVInfoForPoly( params, 3, PValuesParIdx, vinfo );
 
-    const FltVec	&paramP = mParams[PValuesParIdx].NumVec();
+    PolyCluster::MeshDef	*pMesh = newMeshDef( params[PValuesParIdx].NumVec() );
 
     size_t nVertsIdx	= 0;
     size_t idxVertsIdx	= 0;
@@ -293,17 +369,420 @@ void PointsGeneralPolygons::Simplify( Hider &hider )
 
             DASSERT( (idxVertsIdx+nVerts) <= vertsN );
 
-            tessellateToBilinearPatches(
-                            hider,
-                            paramP,
+            tessellateToMeshQuads(
+                            *pMesh,
                             &pVerts[ idxVertsIdx ],
-                            nVerts,
-                            mParams,
-                            *this );
+                            nVerts );
 
             idxVertsIdx += nVerts;
         }
     }
+
+    insertMeshQuads( hider, pMesh, *this );
+}
+
+//==================================================================
+/// PolyCluster
+//==================================================================
+static void sortQuadsRange(
+                    DVec<U32> &order,
+                    const DVec<Float3> &centers,
+                    size_t begin,
+                    size_t end )
+{
+    if ( (end - begin) <= 2 )
+        return;
+
+    Bound	bound;
+    bound.Reset();
+    for (size_t i=begin; i < end; ++i)
+        bound.Expand( centers[ order[i] ] );
+
+    Float3	size = bound.mBox[1] - bound.mBox[0];
+
+    int	axis = 0;
+    if ( size[1] > size[axis] )	axis = 1;
+    if ( size[2] > size[axis] )	axis = 2;
+
+    // same halves as PolyCluster::Split()
+    size_t	mid = begin + (end - begin) / 2;
+
+    std::nth_element(
+            order.begin() + begin,
+            order.begin() + mid,
+            order.begin() + end,
+            [&centers,axis]( U32 a, U32 b ) { return centers[a][axis] < centers[b][axis]; } );
+
+    sortQuadsRange( order, centers, begin, mid );
+    sortQuadsRange( order, centers, mid, end );
+}
+
+//==================================================================
+void PolyCluster::MeshDef::SortSpatially()
+{
+    u_int	quadsN = GetQuadsN();
+
+    DVec<Float3>	centers( quadsN );
+    DVec<U32>		order( quadsN );
+
+    for (u_int i=0; i < quadsN; ++i)
+    {
+        const U32	*pIdx = &mQuads[ i * 4 ];
+
+        centers[i] = (mVerts[pIdx[0]] + mVerts[pIdx[1]] + mVerts[pIdx[2]] + mVerts[pIdx[3]]) * 0.25f;
+        order[i] = i;
+    }
+
+    sortQuadsRange( order, centers, 0, quadsN );
+
+    DVec<U32>	sorted( mQuads.size() );
+
+    for (u_int i=0; i < quadsN; ++i)
+        for (u_int j=0; j < 4; ++j)
+            sorted[ i * 4 + j ] = mQuads[ order[i] * 4 + j ];
+
+    mQuads.swap( sorted );
+}
+
+//==================================================================
+PolyCluster::PolyCluster( const MeshDef *pMesh, u_int quadsBegin, u_int quadsEnd ) :
+    SimplePrimitiveBase(POLYCLUSTER),
+    mBlocksPerRow(0)
+{
+    moMesh = pMesh;
+
+    mQuadsRange[0] = quadsBegin;
+    mQuadsRange[1] = quadsEnd;
+
+    mBlockDim[0] = 0;
+    mBlockDim[1] = 0;
+
+    updateBound();
+}
+
+//==================================================================
+void PolyCluster::updateBound()
+{
+    mBound.Reset();
+
+    const MeshDef	&mesh = *moMesh.get();
+
+    for (u_int i=mQuadsRange[0]*4; i < mQuadsRange[1]*4; ++i)
+        mBound.Expand( mesh.mVerts[ mesh.mQuads[i] ] );
+}
+
+//==================================================================
+void PolyCluster::MakeBound( Bound &out_bound, Float3_ *out_pPo ) const
+{
+    out_bound = mBound;
+}
+
+//==================================================================
+/// Only the first quad, the cluster is diced by Dice()
+void PolyCluster::Eval_dPdu_dPdv(
+                        const Float2_ &uv,
+                        Float3_ &out_pt,
+                        Float3_ *out_dPdu,
+                        Float3_ *out_dPdv ) const
+{
+    Float3	hull[4];
+    moMesh->GetQuadHull( mQuadsRange[0], hull );
+
+    Float3_	h0( hull[0] );
+    Float3_	h1( hull[1] );
+    Float3_	h2( hull[2] );
+    Float3_	h3( hull[3] );
+
+    Float3_	left	= DMix( h0, h2, uv[1] );
+    Float3_	right	= DMix( h1, h3, uv[1] );
+    out_pt			= DMix( left, right, uv[0] );
+
+    if ( out_dPdu )
+    {
+        *out_dPdu	= DMix( h1 - h0, h3 - h2, uv[1] );
+        *out_dPdv	= DMix( h2 - h0, h3 - h1, uv[0] );
+    }
+}
+
+//==================================================================
+/// A cluster reaching behind the eye is split rather than culled, the
+/// quads in front may still be visible
+SimplePrimitiveBase::CheckSplitRes
+    PolyCluster::CheckForSplit(
+                            const Hider &hider,
+                            int			out_bound2d[4],
+                            bool		&out_uSplit,
+                            bool		&out_vSplit )
+{
+    DASSERT( mDiceGridWd == -1 && mDiceGridHe == -1 );
+
+    float pixelArea = RasterEstimate( hider, out_bound2d );
+
+    if ( pixelArea >= RI_EPSILON )
+        return CheckDiceOrSplit( hider, pixelArea, out_uSplit, out_vSplit );
+
+    if ( (mQuadsRange[1] - mQuadsRange[0]) > 1 &&
+         (hider.IsAcrossEyePlane( mBound, mpTransform->GetMatrix() ) ||
+          hider.IsAcrossEyePlane( mBound, mpTransform->GetMatrixClose() )) )
+    {
+        out_bound2d[0] = 0;
+        out_bound2d[1] = 0;
+        out_bound2d[2] = (int)hider.GetOutputDataWd();
+        out_bound2d[3] = (int)hider.GetOutputDataHe();
+
+        out_uSplit = true;
+        out_vSplit = true;
+
+        return CHECKSPLITRES_SPLIT;
+    }
+
+    return CHECKSPLITRES_CULL;
+}
+
+//==================================================================
+/// All the quads get a block of the same size, large enough for the
+/// largest one on screen
+SimplePrimitiveBase::CheckSplitRes
+    PolyCluster::CheckDiceOrSplit(
+                            const Hider &hider,
+                            float		pixelArea,
+                            bool		&out_uSplit,
+                            bool		&out_vSplit )
+{
+    out_uSplit = true;
+    out_vSplit = true;
+
+    u_int	quadsN = mQuadsRange[1] - mQuadsRange[0];
+
+    // at least 2x2 vertices per quad
+    if ( quadsN * 4 > MP_GRID_MAX_SIZE )
+        return CHECKSPLITRES_SPLIT;
+
+    const Matrix44 &mtxLocalWorld = mpTransform->GetMatrix();
+
+    float	mpSide = DSqrt( mpAttribs->mShadingRate );
+
+    float	maxDimU = 2;
+    float	maxDimV = 2;
+    float	sumVerts = 0;
+
+    for (u_int qi=mQuadsRange[0]; qi < mQuadsRange[1]; ++qi)
+    {
+        Float3	hull[4];
+        moMesh->GetQuadHull( qi, hull );
+
+        Float2	win[4];
+        if NOT( hider.RasterProject( hull, 4, mtxLocalWorld, win ) )
+            return CHECKSPLITRES_SPLIT;
+
+        float	lenU = DMAX( (win[1] - win[0]).GetLength(), (win[3] - win[2]).GetLength() );
+        float	lenV = DMAX( (win[2] - win[0]).GetLength(), (win[3] - win[1]).GetLength() );
+
+        float	dimU = DMAX( 2.f, ceilf( lenU / mpSide ) + 1 );
+        float	dimV = DMAX( 2.f, ceilf( lenV / mpSide ) + 1 );
+
+        maxDimU = DMAX( maxDimU, dimU );
+        maxDimV = DMAX( maxDimV, dimV );
+        sumVerts += dimU * dimV;
+    }
+
+    if ( maxDimU > (float)MP_GRID_MAX_DIM ||
+         maxDimV > (float)MP_GRID_MAX_DIM )
+        return CHECKSPLITRES_SPLIT;
+
+    u_int	dimU = (u_int)maxDimU;
+    u_int	dimV = (u_int)maxDimV;
+
+    // too much waste on the smaller quads ? Better split
+    if ( quadsN > 1 && (float)(quadsN * dimU * dimV) > sumVerts * 4 )
+        return CHECKSPLITRES_SPLIT;
+
+    // blocks per row for a grid about as wide as it's tall
+    u_int	perRow = (u_int)ceilf( DSqrt( (float)(quadsN * dimV) / dimU ) );
+    perRow = DClamp( perRow, 1u, DMIN( quadsN, MP_GRID_MAX_DIM / dimU ) );
+
+    u_int	rowsN = (quadsN + perRow - 1) / perRow;
+
+    int	wd = DMT_SIMD_PADSIZE( (int)(perRow * dimU) );
+    int	he = (int)(rowsN * dimV);
+
+    if ( wd > (int)MP_GRID_MAX_DIM ||
+         (u_int)(wd * he) > MP_GRID_MAX_SIZE )
+        return CHECKSPLITRES_SPLIT;
+
+    mDiceGridWd		= wd;
+    mDiceGridHe		= he;
+    mBlockDim[0]	= dimU;
+    mBlockDim[1]	= dimV;
+    mBlocksPerRow	= perRow;
+
+    out_uSplit = false;
+    out_vSplit = false;
+
+    return CHECKSPLITRES_DICE;
+}
+
+//==================================================================
+/// Halves of the range, a single quad goes on as a patch
+void PolyCluster::Split( Hider &hider, bool uSplit, bool vSplit )
+{
+    DASSERT( IsUsed() );
+
+    u_int	quadsN = mQuadsRange[1] - mQuadsRange[0];
+
+    if ( quadsN == 1 )
+    {
+        Float3	hull[4];
+        moMesh->GetQuadHull( mQuadsRange[0], hull );
+
+        PatchBilinear	*pPatch = DNEW PatchBilinear( hull );
+        hider.InsertSplitted( pPatch, *this );
+        pPatch->mSplitCnt = 0;
+        return;
+    }
+
+    u_int	mid = mQuadsRange[0] + quadsN / 2;
+
+    PolyCluster	*pClusters[2] = { Clone(), Clone() };
+
+    pClusters[0]->mQuadsRange[1] = mid;
+    pClusters[1]->mQuadsRange[0] = mid;
+
+    for (size_t i=0; i < 2; ++i)
+    {
+        pClusters[i]->updateBound();
+        hider.InsertSplitted( pClusters[i], *this );
+    }
+}
+
+//==================================================================
+void PolyCluster::Dice( WorkGrid &g, bool doColorCoded ) const
+{
+    Float3_	*pP		= (Float3_	*)g.mSymbolIs.FindSymbolIData( "P"	);
+    Float_	*pOODu	= (Float_	*)g.mSymbolIs.FindSymbolIData( "_oodu" );
+    Float_	*pOODv	= (Float_	*)g.mSymbolIs.FindSymbolIData( "_oodv" );
+    Float_	*pu		= (Float_	*)g.mSymbolIs.FindSymbolIData( "u" );
+    Float_	*pv		= (Float_	*)g.mSymbolIs.FindSymbolIData( "v" );
+    Float3_	*pI		= (Float3_	*)g.mSymbolIs.FindSymbolIData( "I"	);
+    Float3_	*pN		= (Float3_	*)g.mSymbolIs.FindSymbolIData( "N"	);
+    Float3_	*pNg	= (Float3_	*)g.mSymbolIs.FindSymbolIData( "Ng"	);
+    SlColor	*pOs	= (SlColor	*)g.mSymbolIs.FindSymbolIData( "Os"	);
+    SlColor	*pCs	= (SlColor	*)g.mSymbolIs.FindSymbolIData( "Cs"	);
+
+    DASSERT( pP == g.mpPointsCS );
+    DASSERT( mBlocksPerRow != 0 );
+
+    Float3	camPosCS = g.mMtxWorldCamera.GetTranslation();
+
+    SlColor	useColor;
+    SlColor	useOpa;
+    setupDice( g, doColorCoded, useColor, useOpa );
+
+    const Matrix44	&mtxLocalCameraNorm = g.mMtxLocalCameraNorm;
+
+    const MeshDef	&mesh = *moMesh.get();
+
+    u_int	dimU	= mBlockDim[0];
+    u_int	dimV	= mBlockDim[1];
+    u_int	usedWd	= mBlocksPerRow * dimU;
+    u_int	quadsN	= mQuadsRange[1] - mQuadsRange[0];
+
+    float	du = 1.0f / (dimU - 1);
+    float	dv = 1.0f / (dimV - 1);
+
+    // unused vertices are kept on the surface, their micro-polygons are holes
+    Float3	fillHull[4];
+    mesh.GetQuadHull( mQuadsRange[0], fillHull );
+
+    g.mHasHoles = true;
+
+    Float_	oodu( (float)(dimU - 1) );
+    Float_	oodv( (float)(dimV - 1) );
+
+    size_t	blocksN = DMT_SIMD_BLOCKS( g.mPointsN );
+
+    for (size_t blkIdx=0; blkIdx < blocksN; ++blkIdx)
+    {
+        Float3_	posLS;
+        Float3_	dPdu;
+        Float3_	dPdv;
+        Float2_	uv;
+
+        for (u_int sub=0; sub < DMT_SIMD_FLEN; ++sub)
+        {
+            u_int	vertIdx = (u_int)blkIdx * DMT_SIMD_FLEN + sub;
+            u_int	x = vertIdx % g.mXDim;
+            u_int	y = vertIdx / g.mXDim;
+
+            u_int	bx = x / dimU;
+            u_int	by = y / dimV;
+            u_int	quadIdx = by * mBlocksPerRow + bx;
+
+            u_int	ix = x - bx * dimU;
+            u_int	iy = y - by * dimV;
+
+            Float3	hull[4];
+            float	s = 0;
+            float	t = 0;
+
+            bool	isUsed = (x < usedWd && quadIdx < quadsN);
+
+            if ( isUsed )
+            {
+                mesh.GetQuadHull( mQuadsRange[0] + quadIdx, hull );
+                s = ix * du;
+                t = iy * dv;
+            }
+            else
+            {
+                for (size_t k=0; k < 4; ++k)
+                    hull[k] = fillHull[k];
+            }
+
+            if ( vertIdx < g.mPointsN )
+            {
+                g.mpMPHoles[ vertIdx ] =
+                        NOT( isUsed ) ||
+                        ix == dimU-1 ||
+                        iy == dimV-1 ||
+                        x >= usedWd-1;
+            }
+
+            Float3	left	= DMix( hull[0], hull[2], t );
+            Float3	right	= DMix( hull[1], hull[3], t );
+            Float3	pos		= DMix( left, right, s );
+            Float3	tanU	= DMix( hull[1] - hull[0], hull[3] - hull[2], t );
+            Float3	tanV	= DMix( hull[2] - hull[0], hull[3] - hull[1], s );
+
+            for (u_int c=0; c < 3; ++c)
+            {
+                posLS[c][sub]	= pos[c];
+                dPdu[c][sub]	= tanU[c];
+                dPdv[c][sub]	= tanV[c];
+            }
+
+            uv[0][sub] = s;
+            uv[1][sub] = t;
+        }
+
+        Float3_	norLS = dPdu.GetCross( dPdv ).GetNormalized();
+        Float3_	posCS = V3__V3W1_Mul_M44<Float_>( posLS, g.mMtxLocalCamera );
+        Float3_	norCS = V3__V3W1_Mul_M44<Float_>( norLS, mtxLocalCameraNorm ).GetNormalized();
+
+        pP[blkIdx]		= posCS;
+
+        pI[blkIdx]		= (posCS - -camPosCS);
+        pOODu[blkIdx]	= oodu;
+        pOODv[blkIdx]	= oodv;
+
+        pu[blkIdx]		= uv[0];
+        pv[blkIdx]		= uv[1];
+
+        pN[blkIdx]		= norCS;
+        pNg[blkIdx]		= norCS;
+        pOs[blkIdx]		= useOpa;
+        pCs[blkIdx]		= useColor;
+    }
 }
 
 //==================================================================
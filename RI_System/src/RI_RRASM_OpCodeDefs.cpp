@@ -145,6 +145,10 @@ OpCodeDef	_gOpCodeDefs[] =
     "texture.sxss"	,	4,			OPC_FLG_1STISDEST,	F1,	STR, F1, F1, NA,
     "texture.vxss"	,	4,			OPC_FLG_1STISDEST,	F3,	STR, F1, F1, NA,
 
+    "shadow.sxvs"	,	4,			OPC_FLG_1STISDEST,	F1,	STR, F3, F1, NA,
+    "environment.sxv",	3,			OPC_FLG_1STISDEST,	F1,	STR, F3, NA, NA,
+    "environment.vxv",	3,			OPC_FLG_1STISDEST,	F3,	STR, F3, NA, NA,
+
     NULL			,	0,			0,	NA, NA, NA, NA, NA
 };
 
@@ -21,21 +21,27 @@ void ResourceManager::Collect()
     // TODO: should not block during delete
     std::lock_guard<std::mutex> lock( mMutex );
 
+    deleteUnused( mpList );
+    deleteUnused( mpDropped );
+}
+
+//==================================================================
+void ResourceManager::deleteUnused( DVec<ResourceBase *> &pList )
+{
     size_t	wi = 0;
-    for (size_t ri=0; ri < mpList.size(); ++ri)
+    for (size_t ri=0; ri < pList.size(); ++ri)
     {
-        if ( mpList[ri]->GetRef() == 0 )
+        if ( pList[ri]->GetRef() == 0 )
         {
-            DDELETE( mpList[ri] );
-            mpList[ri] = nullptr;
+            DDELETE( pList[ri] );
+            pList[ri] = nullptr;
         }
         else
         {
-            if ( wi != ri )
-                mpList[wi++] = mpList[ri];
+            pList[wi++] = pList[ri];
         }
     }
-    mpList.resize( wi );
+    pList.resize( wi );
 }
 
 //==================================================================
@@ -48,6 +54,22 @@ ResourceBase * ResourceManager::AddResource( ResourceBase *pRes )
     return pRes;
 }
 
+//==================================================================
+/// Add a resource loaded from a file, that will be dropped by
+/// DropChanged() when the file changes
+ResourceBase * ResourceManager::AddResource(
+                            ResourceBase			*pRes,
+                            DIO::FileManagerBase	&fileManager,
+                            const char				*pPathFName )
+{
+    DASSERT( pRes != nullptr );
+
+    if ( fileManager.GetFileStamp( pPathFName, pRes->mFileSize, pRes->mFileTime ) )
+        pRes->mPathFName = pPathFName;
+
+    return AddResource( pRes );
+}
+
 //==================================================================
 ResourceBase *ResourceManager::FindResource(
                                 const char *pName,
@@ -65,5 +87,37 @@ ResourceBase *ResourceManager::FindResource(
     return nullptr;
 }
 
+//==================================================================
+/// Stop finding the resources whose files have changed, so that
+/// they get loaded again. Those not in use anymore are deleted
+void ResourceManager::DropChanged( DIO::FileManagerBase &fileManager )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    size_t	wi = 0;
+    for (size_t ri=0; ri < mpList.size(); ++ri)
+    {
+        ResourceBase	*pRes = mpList[ri];
+
+        U64	fileSize;
+        U64	fileTime;
+
+        if ( pRes->mPathFName.length() &&
+             NOT( fileManager.GetFileStamp( pRes->mPathFName.c_str(), fileSize, fileTime ) &&
+                  fileSize == pRes->mFileSize &&
+                  fileTime == pRes->mFileTime ) )
+        {
+            mpDropped.push_back( pRes );
+        }
+        else
+        {
+            mpList[wi++] = pRes;
+        }
+    }
+    mpList.resize( wi );
+
+    deleteUnused( mpDropped );
+}
+
 //==================================================================
 }
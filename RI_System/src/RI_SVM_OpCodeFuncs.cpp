@@ -152,6 +152,10 @@ SlOpCodeFunc	_gSlOpCodeFuncs[] =
     Inst_Texture<V,0>	,
     Inst_Texture<S,1>	,
     Inst_Texture<V,1>	,
+
+    Inst_Shadow_SXVS	,
+    Inst_Environment_SXV,
+    Inst_Environment_VXV,
 };
 
 #undef S
@@ -0,0 +1,104 @@
+//==================================================================
+/// RI_SVM_Ops_Texture.cpp
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info. 
+//==================================================================
+
+#include "stdafx.h"
+#include "RI_SVM_Context.h"
+#include "RI_SVM_Ops_Texture.h"
+#include "RI_Attributes.h"
+#include "RI_MicroPolygonGrid.h"
+
+//==================================================================
+namespace RI
+{
+//==================================================================
+namespace SVM
+{
+
+//==================================================================
+void Inst_Shadow_SXVS( Context &ctx, u_int blocksN )
+{
+          Float_	*lhs	= (		 Float_ *)ctx.GetRW( 1 );
+    const SlStr		*pName	= (const SlStr	*)ctx.GetRO( 2 );
+    const Float3_	*pPos	= (const Float3_*)ctx.GetRO( 3 );
+    const Float_	*pBias	= (const Float_ *)ctx.GetRO( 4 );
+
+    DASSERT( ctx.IsSymbolVarying( 2 ) == false );
+
+    RCSha<ShadowMap>	oMap( ctx.mpAttribs->GetShadowMap( pName->mStr ) );
+
+    // "current" is camera space
+    Matrix44	mtxCurWorld = ctx.mpGrid->mMtxWorldCamera.GetInverse();
+
+    int		pos_offset	= 0;
+    int		bias_offset	= 0;
+    int		pos_step	= ctx.GetSymbolVaryingStep( 3 );
+    int		bias_step	= ctx.GetSymbolVaryingStep( 4 );
+
+    for (u_int i=0; i < blocksN; ++i)
+    {
+        SLRUNCTX_BLKWRITECHECK( i );
+        {
+            // no map, no shadow
+            if ( oMap.get() )
+                oMap->Sample_PCF( lhs[i], pPos[pos_offset], mtxCurWorld, pBias[bias_offset] );
+            else
+                lhs[i] = Float_( 0.f );
+        }
+
+        pos_offset	+= pos_step;
+        bias_offset	+= bias_step;
+    }
+
+    ctx.NextInstruction();
+}
+
+//==================================================================
+template <class TA>
+static void environment_XV( Context &ctx, u_int blocksN )
+{
+            TA		*lhs	= (			TA *)ctx.GetRW( 1 );
+    const SlStr		*pName	= (const SlStr	*)ctx.GetRO( 2 );
+    const Float3_	*pDir	= (const Float3_*)ctx.GetRO( 3 );
+
+    DASSERT( ctx.IsSymbolVarying( 2 ) == false );
+
+    RCSha<EnvMap>	oMap( ctx.mpAttribs->GetEnvMap( pName->mStr ) );
+
+    int		dir_offset	= 0;
+    int		dir_step	= ctx.GetSymbolVaryingStep( 3 );
+
+    for (u_int i=0; i < blocksN; ++i)
+    {
+        SLRUNCTX_BLKWRITECHECK( i );
+        {
+            Float3_	col( 0.f );
+
+            if ( oMap.get() )
+                oMap->Sample( col, pDir[dir_offset] );
+
+            // float lookups get the first channel
+            if ( sizeof(TA) == sizeof(Float_) )
+                ((Float_ *)lhs)[i] = col[0];
+            else
+                ((Float3_ *)lhs)[i] = col;
+        }
+
+        dir_offset += dir_step;
+    }
+
+    ctx.NextInstruction();
+}
+
+//==================================================================
+void Inst_Environment_SXV( Context &ctx, u_int blocksN )	{ environment_XV<Float_>( ctx, blocksN );	}
+void Inst_Environment_VXV( Context &ctx, u_int blocksN )	{ environment_XV<Float3_>( ctx, blocksN );	}
+
+//==================================================================
+}
+//==================================================================
+}
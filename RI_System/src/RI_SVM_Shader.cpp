@@ -7,9 +7,11 @@
 //==================================================================
 
 #include "stdafx.h"
+#include <filesystem>
 #include "RI_SVM_Shader.h"
 #include "RI_SVM_Context.h"
 #include "RI_RRASM_Parser.h"
+#include "RI_SVM_ShaderObj.h"
 #include "RI_Attributes.h"
 #include "RI_State.h"
 #include "RI_SVM_OpCodeFuncs.h"
@@ -29,23 +31,83 @@ namespace SVM
 {
 
 //==================================================================
-static void compileSLToAsm(
-                        DIO::FileManagerBase &fmanager,
-                        DUT::MemFile &slSource,
-                        const char *pSrcFPathName,
-                        const char *pBaseIncDir,
-                        const char *pAsmOutName )
+static void makeObjCacheName(
+                    char *pOut,
+                    size_t outSize,
+                    const char *pSrcFPathName,
+                    const char *pShaderName,
+                    const char *pCacheDir,
+                    U64 sourceKey )
+{
+    if ( pCacheDir && pCacheDir[0] )
+    {
+        const char *pBaseName = DUT::GetFileNameOnly( pShaderName );
+        if NOT( pBaseName[0] )
+            pBaseName = pShaderName;
+
+        // shared cache, by name and key, so that different versions
+        // of the same shader can coexist
+        snprintf( pOut, outSize, "%s/%s_%016llx.rrobj",
+                    pCacheDir,
+                    pBaseName,
+                    (unsigned long long)sourceKey );
+    }
+    else
+    {
+        // ..otherwise next to the source, as <name>.autogen.rrobj
+        snprintf( pOut, outSize, "%s", pSrcFPathName );
+        DUT::GetFileNameExt( pOut )[0] = 0;	// cut the extension
+        strcat_s( pOut, outSize, "autogen.rrobj" );
+    }
+}
+
+//==================================================================
+static bool loadCachedObj( Shader *pShader, const char *pObjFName, U64 sourceKey )
+{
+    DVec<U8>	data;
+
+    if NOT( DUT::FileExists( pObjFName ) && DUT::GrabFile( pObjFName, data ) )
+        return false;
+
+    // another source or another build ?
+    if ( data.size() == 0 || GetShaderObjKey( &data[0], data.size() ) != sourceKey )
+        return false;
+
+    try {
+        return ReadShaderObj( *pShader, &data[0], data.size() );
+    }
+    catch ( ... )
+    {
+        // broken file ? ..will just be replaced
+        return false;
+    }
+}
+
+//==================================================================
+static void compileSL(
+                DIO::FileManagerBase &fmanager,
+                DUT::MemFile &slSource,
+                Shader *pShader,
+                const char *pSrcFPathName,
+                const char *pShaderName,
+                const char *pBaseIncDir,
+                const char *pCacheDir )
 {
     // compile
     std::string	basInclude( pBaseIncDir );
     basInclude += "/RSLC_Builtins.sl";
 
+    DVec<U8>	asmData;
+    U64			sourceKey = 0;
+    char		objOutName[4096];
+
     try {
         RSLCompiler::Params	params;
         params.mDbgOutputTree = false;
+        params.mPreproOnly = true;
         params.mpFileManager = &fmanager;
 
-        // try compile
+        // preprocess only for now
         RSLCompiler	compiler(
                         pSrcFPathName,
                         (const char *)slSource.GetData(),
@@ -54,8 +116,26 @@ static void compileSLToAsm(
                         params
                     );
 
-        // save autogen rrasm file
-        compiler.SaveASM( pAsmOutName, pSrcFPathName );
+        // the preprocessed source (includes and builtins too) is
+        // what decides if a cached object can be used
+        sourceKey = MakeShaderObjKey( compiler.CalcSourceHash() );
+
+        makeObjCacheName(
+                objOutName,
+                sizeof(objOutName),
+                pSrcFPathName,
+                pShaderName,
+                pCacheDir,
+                sourceKey );
+
+        if ( loadCachedObj( pShader, objOutName, sourceKey ) )
+            return;
+
+        // try compile
+        compiler.Compile();
+
+        // get the rrasm in memory, it's only an intermediate step now
+        compiler.GetASM( asmData, pSrcFPathName );
     }
     catch ( RSLC::Exception &e )
     {
@@ -65,6 +145,8 @@ static void compileSLToAsm(
             e.GetMessage().c_str(),
             pSrcFPathName
             );
+
+        DEX_RUNTIME_ERROR( "Failed to compile '%s'", pSrcFPathName );
     }
     catch ( ... )
     {
@@ -72,6 +154,26 @@ static void compileSLToAsm(
             "SHADER ERR> FROM: %s\n\n",
             pSrcFPathName
             );
+
+        DEX_RUNTIME_ERROR( "Failed to compile '%s'", pSrcFPathName );
+    }
+
+    // parse/compile the rrasm
+    DUT::MemFile	asmFile;
+    asmFile.InitExclusiveOwenership( asmData );
+
+    RRASM::Parser	parser( asmFile, pShader, pShaderName );
+
+    // ..and save the object for the next time
+    try {
+        if ( pCacheDir && pCacheDir[0] )
+            std::filesystem::create_directories( pCacheDir );
+
+        SaveShaderObj( *pShader, objOutName, sourceKey );
+    }
+    catch ( ... )
+    {
+        printf( "WARNING: Could not save '%s'\n", objOutName );
     }
 }
 
@@ -82,42 +184,27 @@ static void compileFromMemFile(
                 const char *pFileName,
                 const char *pShaderName,
                 const char *pBaseIncDir,
+                const char *pCacheDir,
                 DIO::FileManagerBase &fileManager )
 {
-    bool	isSL =
-        (0 == strcasecmp( DUT::GetFileNameExt( pFileName ), "sl" ) );
+    const char	*pExt = DUT::GetFileNameExt( pFileName );
 
-    if NOT( isSL )
+    if ( 0 == strcasecmp( pExt, "rrobj" ) )
     {
-        // compile/parse the rrasm file and return right away
-        RRASM::Parser	parser( file, pShader, pShaderName );
-        return;
+        // precompiled object, just load it
+        if NOT( ReadShaderObj( *pShader, file.GetData(), file.GetDataSize() ) )
+            DEX_RUNTIME_ERROR( "Shader object '%s' is out of date, it needs to be recompiled", pFileName );
     }
-
-    // make the autogen name
-    char	asmOutName[1024];
-    strcpy_s( asmOutName, pFileName );
-    DUT::GetFileNameExt( asmOutName )[0] = 0;	// cut the extension
-    strcat_s( asmOutName, "autogen.rrasm" );	// make the .autogen etc name
-
-    DUT::MemFile	autogenAsmFile;
-
-    // does the autogen file already exist ?
-    if ( fileManager.FileExists( asmOutName ) )
+    else
+    if ( 0 == strcasecmp( pExt, "sl" ) )
     {
-        // just get it from the file manager
-        fileManager.GrabFile( asmOutName, autogenAsmFile );
+        compileSL( fileManager, file, pShader, pFileName, pShaderName, pBaseIncDir, pCacheDir );
     }
     else
     {
-        // ..otherwise.. compile the sl into an autogen.rrasm
-        compileSLToAsm( fileManager, file, pFileName, pBaseIncDir, asmOutName );
-        // ..and also read in the file..
-        autogenAsmFile.Init( asmOutName );
+        // compile/parse the rrasm file
+        RRASM::Parser	parser( file, pShader, pShaderName );
     }
-
-    // now parse/compile the rrasm file
-    RRASM::Parser	parser( autogenAsmFile, pShader, pShaderName );
 }
 
 //==================================================================
@@ -129,20 +216,37 @@ Shader::Shader( const CtorParams &params, DIO::FileManagerBase &fileManager ) :
     mStartPC(INVALID_PC),
     mHasDirPosInstructions(false)
 {
+    Load( params, fileManager );
+}
+
+//==================================================================
+Shader::Shader( const char *pName ) :
+    ResourceBase(pName, ResourceBase::TYPE_SHADER),
+    mType(TYPE_UNKNOWN),
+    mStartPC(INVALID_PC),
+    mHasDirPosInstructions(false)
+{
+}
+
+//==================================================================
+void Shader::Load( const CtorParams &params, DIO::FileManagerBase &fileManager )
+{
+    DASSERT( mpShaSyms.size() == 0 && mCode.size() == 0 );
+
     DUT::MemFile	file;
 
     if ( params.pSource )
     {
         file.Init( (const void *)params.pSource, strlen(params.pSource) );
 
-        compileFromMemFile( file, this, params.pSourceFileName, params.pName, params.pBaseIncDir, fileManager );
+        compileFromMemFile( file, this, params.pSourceFileName, params.pName, params.pBaseIncDir, params.pCacheDir, fileManager );
     }
     else
     if ( params.pSourceFileName )
     {
         fileManager.GrabFile( params.pSourceFileName, file );
 
-        compileFromMemFile( file, this, params.pSourceFileName, params.pName, params.pBaseIncDir, fileManager );
+        compileFromMemFile( file, this, params.pSourceFileName, params.pName, params.pBaseIncDir, params.pCacheDir, fileManager );
     }
     else
     {
@@ -150,6 +254,20 @@ Shader::Shader( const CtorParams &params, DIO::FileManagerBase &fileManager ) :
     }
 }
 
+//==================================================================
+void Shader::Clear()
+{
+    for (size_t i=0; i < mpShaSyms.size(); ++i)
+        DSAFE_DELETE( mpShaSyms[i] );
+
+    mpShaSyms.clear();
+    mpShaSymsStartPCs.clear();
+    mCode.clear();
+    mType					= TYPE_UNKNOWN;
+    mStartPC				= INVALID_PC;
+    mHasDirPosInstructions	= false;
+}
+
 //==================================================================
 /// ShaderInst
 //==================================================================
@@ -0,0 +1,582 @@
+//==================================================================
+/// RI_SVM_ShaderObj.cpp
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info.
+//==================================================================
+
+#include "stdafx.h"
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+#include "RI_SVM_ShaderObj.h"
+#include "RI_RRASM_OpCodeDefs.h"
+
+//==================================================================
+namespace RI
+{
+//==================================================================
+namespace SVM
+{
+
+//==================================================================
+static const U8		SHADEROBJ_MAGIC[4] = { 'R', 'R', 'S', 'O' };
+
+static const U32	SHADEROBJ_FLG_DIRPOSINSTRUCTIONS	= 1;
+
+static const U32	NO_CONST	= 0xffffffff;
+
+//==================================================================
+struct ObjHeader
+{
+    U8		mMagic[4];
+    U32		mVersion;
+    U32		mOpCodesSignature;
+    U32		mShaderType;
+    U32		mFlags;
+    U32		mStartPC;
+    U32		mSymbolsN;
+    U32		mConstFloatsN;
+    U32		mStrTableSize;
+    U32		mCodeWordsN;
+    U64		mSourceKey;		// 0 if not known
+};
+
+//==================================================================
+struct ObjSymbol
+{
+    U32		mNameOff;		// offset in the string table
+    U8		mType;
+    U8		mStorage;
+    U8		mClass;
+    U8		mPad;
+    U32		mStartPC;		// default param value subroutine
+    U32		mConstOff;		// float or string table offset (or NO_CONST)
+};
+
+//==================================================================
+// 3 words per CPUWord, the meaning depends on the position in the
+// instruction stream (opcode, symbol index, address or immediate)
+struct ObjWord
+{
+    U32		mVal[3];
+};
+
+//==================================================================
+enum OperKind
+{
+    OPER_SYMBOL,
+    OPER_ADDR,
+    OPER_IMM,
+};
+
+//==================================================================
+// same rules as RRASM::Parser::parseCodeLine()
+static OperKind getOperKind( const RRASM::OpCodeDef &def, u_int operIdx )
+{
+    if ( operIdx > 0 && (def.Flags & RRASM::OPC_FLG_RIGHTISIMM) )
+        return OPER_IMM;
+
+    if ( def.Types[operIdx] == Symbol::TYP_ADDR )
+        return OPER_ADDR;
+
+    return OPER_SYMBOL;
+}
+
+//==================================================================
+static U32 hashFNV( U32 hash, const void *pData, size_t size )
+{
+    const U8 *pBytes = (const U8 *)pData;
+
+    for (size_t i=0; i < size; ++i)
+        hash = (hash ^ pBytes[i]) * 16777619u;
+
+    return hash;
+}
+
+//==================================================================
+// Opcodes are stored by index, so the object is only valid for the
+// same opcodes table it was compiled against
+static U32 calcOpCodesSignature( u_int &out_opCodesN )
+{
+    U32		hash = 2166136261u;
+    u_int	n = 0;
+
+    for (; RRASM::_gOpCodeDefs[n].pName != NULL; ++n)
+    {
+        const RRASM::OpCodeDef	&def = RRASM::_gOpCodeDefs[n];
+
+        hash = hashFNV( hash, def.pName, strlen(def.pName)+1 );
+        hash = hashFNV( hash, &def.OperCnt, sizeof(def.OperCnt) );
+        hash = hashFNV( hash, &def.Flags, sizeof(def.Flags) );
+
+        for (u_int i=0; i < def.OperCnt; ++i)
+        {
+            U32	type = (U32)def.Types[i];
+            hash = hashFNV( hash, &type, sizeof(type) );
+        }
+    }
+
+    out_opCodesN = n;
+
+    return hash;
+}
+
+//==================================================================
+static U32 getOpCodesSignature( u_int &out_opCodesN )
+{
+    static u_int	sOpCodesN;
+    static U32		sSignature = calcOpCodesSignature( sOpCodesN );
+
+    out_opCodesN = sOpCodesN;
+
+    return sSignature;
+}
+
+//==================================================================
+static u_int getConstFloatsN( Symbol::Type type )
+{
+    switch ( type )
+    {
+    case Symbol::TYP_FLOAT:		return 1;
+    case Symbol::TYP_POINT:
+    case Symbol::TYP_VECTOR:
+    case Symbol::TYP_NORMAL:
+    case Symbol::TYP_COLOR:		return 3;
+    case Symbol::TYP_HPOINT:	return 4;
+
+    default:
+        return 0;
+    }
+}
+
+//==================================================================
+static void getConstFloats( const Symbol &sym, float out_vals[4] )
+{
+    const void	*pData = sym.GetConstantData();
+
+    switch ( sym.mType )
+    {
+    case Symbol::TYP_FLOAT:
+        out_vals[0] = ((const Float_ *)pData)[0][0];
+        break;
+
+    case Symbol::TYP_POINT:
+    case Symbol::TYP_VECTOR:
+    case Symbol::TYP_NORMAL:
+    case Symbol::TYP_COLOR:
+        for (int i=0; i < 3; ++i)
+            out_vals[i] = ((const Float3_ *)pData)[0][i][0];
+        break;
+
+    case Symbol::TYP_HPOINT:
+        for (int i=0; i < 4; ++i)
+            out_vals[i] = ((const Float4_ *)pData)[0][i][0];
+        break;
+
+    default:
+        DASSERT( 0 );
+        break;
+    }
+}
+
+//==================================================================
+static U32 addString( DVec<char> &strTable, const char *pStr )
+{
+    U32		off = (U32)strTable.size();
+    size_t	len = strlen( pStr ) + 1;
+
+    strTable.resize( off + len );
+    memcpy( &strTable[off], pStr, len );
+
+    return off;
+}
+
+//==================================================================
+bool IsShaderObj( const void *pData, size_t dataSize )
+{
+    return
+        dataSize >= sizeof(ObjHeader) &&
+        0 == memcmp( pData, SHADEROBJ_MAGIC, sizeof(SHADEROBJ_MAGIC) );
+}
+
+//==================================================================
+/// Key for caching an object made from a given source: includes what
+/// makes objects incompatible, so that different builds sharing a
+/// cache don't keep replacing each other's objects
+U64 MakeShaderObjKey( U64 sourceHash )
+{
+    u_int	opCodesN;
+    U32		sig = getOpCodesSignature( opCodesN );
+
+    U64	key = sourceHash;
+    key = (key ^ SHADEROBJ_VERSION) * 1099511628211ULL;
+    key = (key ^ sig) * 1099511628211ULL;
+
+    // 0 is reserved for "unknown"
+    return key ? key : 1;
+}
+
+//==================================================================
+U64 GetShaderObjKey( const void *pData, size_t dataSize )
+{
+    if NOT( IsShaderObj( pData, dataSize ) )
+        return 0;
+
+    ObjHeader	head;
+    memcpy( &head, pData, sizeof(head) );
+
+    return head.mVersion == SHADEROBJ_VERSION ? head.mSourceKey : 0;
+}
+
+//==================================================================
+void WriteShaderObj( const Shader &shader, DUT::MemWriterDynamic &mw, U64 sourceKey )
+{
+    u_int	opCodesN;
+
+    ObjHeader	head;
+    memcpy( head.mMagic, SHADEROBJ_MAGIC, sizeof(SHADEROBJ_MAGIC) );
+    head.mVersion			= SHADEROBJ_VERSION;
+    head.mOpCodesSignature	= getOpCodesSignature( opCodesN );
+    head.mShaderType		= (U32)shader.mType;
+    head.mFlags				= shader.mHasDirPosInstructions ? SHADEROBJ_FLG_DIRPOSINSTRUCTIONS : 0;
+    head.mStartPC			= shader.mStartPC;
+    head.mSymbolsN			= (U32)shader.mpShaSyms.size();
+    head.mSourceKey			= sourceKey;
+
+    DVec<char>		strTable;
+    DVec<float>		constFloats;
+    DVec<ObjSymbol>	objSyms( shader.mpShaSyms.size() );
+
+    for (size_t i=0; i < shader.mpShaSyms.size(); ++i)
+    {
+        const Symbol	&sym = *shader.mpShaSyms[i];
+        ObjSymbol		&objSym = objSyms[i];
+
+        objSym.mNameOff		= addString( strTable, sym.GetNameChr() );
+        objSym.mType		= (U8)sym.mType;
+        objSym.mStorage		= (U8)sym.mStorage;
+        objSym.mClass		= (U8)sym.mClass;
+        objSym.mPad			= 0;
+        objSym.mStartPC		= shader.mpShaSymsStartPCs[i];
+        objSym.mConstOff	= NO_CONST;
+
+        if NOT( sym.GetConstantData() )
+            continue;
+
+        if ( sym.mType == Symbol::TYP_STRING )
+        {
+            objSym.mConstOff = addString( strTable, ((const SlStr *)sym.GetConstantData())->mStr );
+        }
+        else
+        {
+            u_int	n = getConstFloatsN( sym.mType );
+
+            DASSTHROW( n != 0, ("Unsupported constant type for '%s'", sym.GetNameChr()) );
+
+            float	vals[4];
+            getConstFloats( sym, vals );
+
+            objSym.mConstOff = (U32)constFloats.size();
+            for (u_int j=0; j < n; ++j)
+                constFloats.push_back( vals[j] );
+        }
+    }
+
+    head.mConstFloatsN	= (U32)constFloats.size();
+    head.mStrTableSize	= (U32)strTable.size();
+    head.mCodeWordsN	= (U32)shader.mCode.size();
+
+    // code
+    DVec<ObjWord>	objCode( shader.mCode.size() );
+
+    for (size_t pc=0; pc < shader.mCode.size(); )
+    {
+        const OpCode	&op = shader.mCode[pc].mOpCode;
+
+        DASSERT( op.mTableOffset < opCodesN );
+        const RRASM::OpCodeDef	&def = RRASM::_gOpCodeDefs[ op.mTableOffset ];
+
+        ObjWord	&objOp = objCode[pc++];
+        objOp.mVal[0] = op.mTableOffset;
+        objOp.mVal[1] = (U32)op.mOperandCount | ((U32)op.mFuncopEndAddr << 16);
+        objOp.mVal[2] = op.mDbgLineNum;
+
+        for (u_int i=0; i < def.OperCnt; ++i, ++pc)
+        {
+            DASSTHROW( pc < shader.mCode.size(), ("Truncated instruction '%s'", def.pName) );
+
+            const CPUWord	&word = shader.mCode[pc];
+            ObjWord			&objWord = objCode[pc];
+
+            objWord.mVal[0] = 0;
+            objWord.mVal[1] = 0;
+            objWord.mVal[2] = 0;
+
+            switch ( getOperKind( def, i ) )
+            {
+            case OPER_SYMBOL:	objWord.mVal[0] = word.mSymbol.mTableOffset;	break;
+            case OPER_ADDR:		objWord.mVal[0] = word.mAddress.mOffset;		break;
+            case OPER_IMM:		memcpy( &objWord.mVal[0], &word.mImmFloat.mValue, sizeof(float) ); break;
+            }
+        }
+    }
+
+    mw.WriteValue( head );
+    mw.WriteArray( strTable.size() ? &strTable[0] : NULL, strTable.size() );
+    mw.WriteArray( constFloats.size() ? &constFloats[0] : NULL, constFloats.size() );
+    mw.WriteArray( objSyms.size() ? &objSyms[0] : NULL, objSyms.size() );
+    mw.WriteArray( objCode.size() ? &objCode[0] : NULL, objCode.size() );
+}
+
+//==================================================================
+/// Write to a temporary file first and then rename it, so that other
+/// processes or threads sharing the same file never see it partially
+/// written
+void SaveShaderObj( const Shader &shader, const char *pFName, U64 sourceKey )
+{
+    DUT::MemWriterDynamic	mw;
+
+    WriteShaderObj( shader, mw, sourceKey );
+
+    static std::atomic<U32>	sTmpCnt;
+
+    char	tmpFName[4096];
+    sprintf_s( tmpFName, "%s.%llx_%llx_%x.tmp",
+                pFName,
+                (unsigned long long)std::chrono::steady_clock::now().time_since_epoch().count(),
+                (unsigned long long)std::hash<std::thread::id>()( std::this_thread::get_id() ),
+                (U32)sTmpCnt++ );
+
+    FILE	*pFile;
+    if ( fopen_s( &pFile, tmpFName, "wb" ) )
+        DEX_RUNTIME_ERROR( "Failed to save %s", tmpFName );
+
+    bool	ok = (mw.GetCurSize() == fwrite( mw.GetDataBegin(), 1, mw.GetCurSize(), pFile ));
+
+    if ( fclose( pFile ) )
+        ok = false;
+
+    std::error_code	ec;
+
+    if ( ok )
+        std::filesystem::rename( tmpFName, pFName, ec );
+
+    if ( !ok || ec )
+    {
+        std::filesystem::remove( tmpFName, ec );
+        DEX_RUNTIME_ERROR( "Failed to save %s", pFName );
+    }
+}
+
+//==================================================================
+static bool isGoodAddr( const DVec<U8> &isOpStart, U32 addr )
+{
+    return addr < isOpStart.size() && isOpStart[ addr ];
+}
+
+//==================================================================
+static bool readShaderObj( Shader &shader, const void *pData, size_t dataSize )
+{
+    if NOT( IsShaderObj( pData, dataSize ) )
+        DEX_RUNTIME_ERROR( "Not a shader object" );
+
+    DUT::MemReader	reader( pData, dataSize );
+
+    ObjHeader	head = reader.ReadValue<ObjHeader>();
+
+    // different format or opcodes table ? Needs to be recompiled
+    u_int	opCodesN;
+    if ( head.mVersion != SHADEROBJ_VERSION ||
+         head.mOpCodesSignature != getOpCodesSignature( opCodesN ) )
+        return false;
+
+    if ( head.mShaderType == Shader::TYPE_UNKNOWN || head.mShaderType >= Shader::TYPE_N )
+        DEX_RUNTIME_ERROR( "Invalid shader type" );
+
+    U64	expectedSize =
+            (U64)sizeof(ObjHeader) +
+            (U64)head.mStrTableSize +
+            (U64)head.mConstFloatsN * sizeof(float) +
+            (U64)head.mSymbolsN * sizeof(ObjSymbol) +
+            (U64)head.mCodeWordsN * sizeof(ObjWord);
+
+    if ( expectedSize != dataSize )
+        DEX_RUNTIME_ERROR( "Bad shader object size" );
+
+    const char	*pStrTable	= (const char *)reader.GetDataPtr( head.mStrTableSize );
+
+    if ( head.mStrTableSize && pStrTable[ head.mStrTableSize-1 ] != 0 )
+        DEX_RUNTIME_ERROR( "Bad string table" );
+
+    DVec<float>	constFloats( head.mConstFloatsN );
+    if ( head.mConstFloatsN )
+        reader.ReadArray( &constFloats[0], head.mConstFloatsN );
+
+    // symbols
+    shader.mpShaSyms.resize( head.mSymbolsN );
+    shader.mpShaSymsStartPCs.resize( head.mSymbolsN );
+
+    for (U32 i=0; i < head.mSymbolsN; ++i)
+    {
+        ObjSymbol	objSym = reader.ReadValue<ObjSymbol>();
+
+        if ( objSym.mNameOff >= head.mStrTableSize )
+            DEX_RUNTIME_ERROR( "Bad symbol name" );
+
+        Symbol::CtorParams	params;
+        params.mpName	= pStrTable + objSym.mNameOff;
+        params.mType	= (Symbol::Type)objSym.mType;
+        params.mStorage	= (Symbol::Storage)objSym.mStorage;
+        params.mClass	= objSym.mClass;
+
+        std::unique_ptr<Symbol>	pSymbol( DNEW Symbol( params ) );
+
+        if ( objSym.mConstOff != NO_CONST )
+        {
+            if ( pSymbol->mType == Symbol::TYP_STRING )
+            {
+                if ( objSym.mConstOff >= head.mStrTableSize )
+                    DEX_RUNTIME_ERROR( "Bad string constant" );
+
+                SlStr	str( pStrTable + objSym.mConstOff );
+                pSymbol->InitConstValue( &str );
+            }
+            else
+            {
+                u_int	n = getConstFloatsN( pSymbol->mType );
+
+                if ( n == 0 || objSym.mConstOff + n > head.mConstFloatsN )
+                    DEX_RUNTIME_ERROR( "Bad constant" );
+
+                pSymbol->InitConstValue( &constFloats[ objSym.mConstOff ] );
+            }
+        }
+
+        shader.mpShaSyms[i]			= pSymbol.release();
+        shader.mpShaSymsStartPCs[i]	= objSym.mStartPC;
+    }
+
+    // code
+    const ObjWord	*pObjCode =
+        (const ObjWord *)reader.GetDataPtr( sizeof(ObjWord) * head.mCodeWordsN );
+
+    shader.mCode.resize( head.mCodeWordsN );
+
+    // where the instructions begin, for the jumps
+    DVec<U8>	isOpStart( head.mCodeWordsN, 0 );
+
+    for (U32 pc=0; pc < head.mCodeWordsN; )
+    {
+        isOpStart[pc] = 1;
+
+        ObjWord	objOp;
+        memcpy( &objOp, pObjCode + pc, sizeof(ObjWord) );
+
+        if ( objOp.mVal[0] >= opCodesN )
+            DEX_RUNTIME_ERROR( "Bad opcode at %u", pc );
+
+        const RRASM::OpCodeDef	&def = RRASM::_gOpCodeDefs[ objOp.mVal[0] ];
+
+        OpCode	&op = shader.mCode[pc++].mOpCode;
+        op.mTableOffset		= objOp.mVal[0];
+        op.mOperandCount	= (u_short)(objOp.mVal[1] & 0xffff);
+        op.mFuncopEndAddr	= (u_short)(objOp.mVal[1] >> 16);
+        op.mDbgLineNum		= objOp.mVal[2];
+
+        for (u_int i=0; i < def.OperCnt; ++i, ++pc)
+        {
+            if ( pc >= head.mCodeWordsN )
+                DEX_RUNTIME_ERROR( "Truncated instruction '%s'", def.pName );
+
+            ObjWord	objWord;
+            memcpy( &objWord, pObjCode + pc, sizeof(ObjWord) );
+
+            CPUWord	&word = shader.mCode[pc];
+
+            switch ( getOperKind( def, i ) )
+            {
+            case OPER_SYMBOL:
+                if ( objWord.mVal[0] >= head.mSymbolsN )
+                    DEX_RUNTIME_ERROR( "Bad symbol index at %u", pc );
+
+                word.mSymbol.mTableOffset	= objWord.mVal[0];
+                word.mSymbol.mpOrigSymbol	= shader.mpShaSyms[ objWord.mVal[0] ];
+                word.mSymbol.mIsVarying		= word.mSymbol.mpOrigSymbol->IsVarying();
+                break;
+
+            case OPER_ADDR:
+                word.mAddress.mOffset = objWord.mVal[0];
+                break;
+
+            case OPER_IMM:
+                memcpy( &word.mImmFloat.mValue, &objWord.mVal[0], sizeof(float) );
+                break;
+            }
+        }
+    }
+
+    // every jump must land on an instruction
+    for (U32 pc=0; pc < head.mCodeWordsN; )
+    {
+        const OpCode			&op = shader.mCode[pc].mOpCode;
+        const RRASM::OpCodeDef	&def = RRASM::_gOpCodeDefs[ op.mTableOffset ];
+
+        if ( op.mFuncopEndAddr != OpCode::INVALID_ADDR && !isGoodAddr( isOpStart, op.mFuncopEndAddr ) )
+            DEX_RUNTIME_ERROR( "Bad block end address at %u", pc );
+
+        ++pc;
+
+        for (u_int i=0; i < def.OperCnt; ++i, ++pc)
+        {
+            if ( getOperKind( def, i ) == OPER_ADDR &&
+                 !isGoodAddr( isOpStart, shader.mCode[pc].mAddress.mOffset ) )
+                DEX_RUNTIME_ERROR( "Bad jump address at %u", pc );
+        }
+    }
+
+    if NOT( isGoodAddr( isOpStart, head.mStartPC ) )
+        DEX_RUNTIME_ERROR( "Bad entry point" );
+
+    for (size_t i=0; i < shader.mpShaSymsStartPCs.size(); ++i)
+    {
+        U32	startPC = shader.mpShaSymsStartPCs[i];
+
+        if ( startPC != INVALID_PC && !isGoodAddr( isOpStart, startPC ) )
+            DEX_RUNTIME_ERROR( "Bad default value address for '%s'", shader.mpShaSyms[i]->mName.c_str() );
+    }
+
+    shader.mType	= (Shader::Type)head.mShaderType;
+    shader.mStartPC	= head.mStartPC;
+
+    if ( (head.mFlags & SHADEROBJ_FLG_DIRPOSINSTRUCTIONS) )
+        shader.mHasDirPosInstructions = true;
+
+    return true;
+}
+
+//==================================================================
+bool ReadShaderObj( Shader &shader, const void *pData, size_t dataSize )
+{
+    DASSERT( shader.mpShaSyms.size() == 0 && shader.mCode.size() == 0 );
+
+    try {
+        return readShaderObj( shader, pData, dataSize );
+    }
+    catch ( ... )
+    {
+        // leave the shader empty, in case the caller wants to retry
+        // from another source
+        shader.Clear();
+
+        throw;
+    }
+}
+
+//==================================================================
+}
+//==================================================================
+}
@@ -18,6 +18,9 @@ namespace RI
 /// State
 //==================================================================
 State::State( const Params &params ) :
+    mpCurObjectDef(NULL),
+    mMotionKeyIdx(0),
+    mpMotionFirstPrim(NULL),
     mParams(params)
 {
     // normalize the directories in input...
@@ -143,23 +146,14 @@ State::State( const Params &params ) :
 
     mOptionsStack.top().Init( &mGlobalSyms, &mOptionsRevTrack );
     mAttributesStack.top().Init( this, &mGlobalSyms, &mResManager, &mAttribsRevTrack );
-    mTransformOpenStack.top().Init( &mTransOpenRevTrack );
-    mTransformCloseStack.top().Init( &mTransCloseRevTrack );
+    mTransformStack.top().Init( &mTransRevTrack );
     
     mParams.mpFramework->SetGlobalSyms( &mGlobalSyms );
 }
 
 //==================================================================
-SVM::Shader *State::GetShader( const char *pShaderName, const char *pAlternateName )
+DStr State::findShaderFile( const char *pShaderName )
 {
-    // try see if we have it loaded already
-    SVM::Shader	*pShader =
-            (SVM::Shader *)mResManager.FindResource( pShaderName,
-                                                    ResourceBase::TYPE_SHADER );
-
-    if ( pShader )
-        return pShader;
-
     DStr	tmpFName;
     DStr	shaderFullPathName;
 
@@ -167,6 +161,13 @@ SVM::Shader *State::GetShader( const char *pShaderName, const char *pAlternateNa
     tmpFName = DStr( pShaderName ) + ".sl";
     shaderFullPathName = FindResFile( tmpFName.c_str(), Options::SEARCHPATH_SHADER );
 
+    if NOT( shaderFullPathName.length() )
+    {
+        // try .rrobj (precompiled)
+        tmpFName = DStr( pShaderName ) + ".rrobj";
+        shaderFullPathName = FindResFile( tmpFName.c_str(), Options::SEARCHPATH_SHADER );
+    }
+
     if NOT( shaderFullPathName.length() )
     {
         // try .rrasm
@@ -174,22 +175,54 @@ SVM::Shader *State::GetShader( const char *pShaderName, const char *pAlternateNa
         shaderFullPathName = FindResFile( tmpFName.c_str(), Options::SEARCHPATH_SHADER );
     }
 
+    return shaderFullPathName;
+}
+
+//==================================================================
+SVM::Shader *State::GetShader( const char *pShaderName, const char *pAlternateName )
+{
+    // try see if we have it loaded already
+    SVM::Shader	*pShader =
+            (SVM::Shader *)mResManager.FindResource( pShaderName,
+                                                    ResourceBase::TYPE_SHADER );
+
+    if ( pShader )
+        return pShader;
+
+    DStr	shaderFullPathName = findShaderFile( pShaderName );
+
     if ( shaderFullPathName.length() )
     {
-        SVM::Shader::CtorParams	params;
-        params.pName			= pShaderName;
-        params.pBaseIncDir		= GetDefShadersDir();
-        params.pSourceFileName	= shaderFullPathName.c_str();
-
-        try {
-            pShader = DNEW SVM::Shader( params, GetFileManager() );
-        } catch ( ... )
-        {
-            //ERRPrintf( "Could not compile '%s' !", params.pSourceFileName );
-            return NULL;
-        }
+        // add the empty shader now, so that it can be referenced
+        // already, and load it in the background.
+        // Anything needing the shader's contents must wait for
+        // ResolveShaders() (called at WorldEnd)
+        pShader = DNEW SVM::Shader( pShaderName );
+
+        mResManager.AddResource( pShader, GetFileManager(), shaderFullPathName.c_str() );
+
+        Dgrow( mPendingShaders );
+        PendingShader	&pend = mPendingShaders.back();
+        pend.moShader		= pShader;
+        pend.mFullPathName	= shaderFullPathName;
+        pend.mAlternateName	= pAlternateName ? pAlternateName : "";
+
+        DStr	shaderName		= pShaderName;
+        DStr	baseIncDir		= GetDefShadersDir();
+        DStr	cacheDir		= mParams.mShaderCacheDir;
+        DIO::FileManagerBase	*pFileManager = &GetFileManager();
+
+        pend.mFuture = mShaderLoadTasks.AddJob<void>(
+            [=]()
+            {
+                SVM::Shader::CtorParams	params;
+                params.pName			= shaderName.c_str();
+                params.pBaseIncDir		= baseIncDir.c_str();
+                params.pSourceFileName	= shaderFullPathName.c_str();
+                params.pCacheDir		= cacheDir.c_str();
 
-        mResManager.AddResource( pShader );
+                pShader->Load( params, *pFileManager );
+            } );
 
         return pShader;
     }
@@ -212,6 +245,68 @@ SVM::Shader *State::GetShader( const char *pShaderName, const char *pAlternateNa
     return NULL;
 }
 
+//==================================================================
+void State::ResolveShaders()
+{
+    waitPendingShaders();
+
+    // lights need to know what their shader does
+    for (size_t i=0; i < mpLightSources.size(); ++i)
+    {
+        LightSourceT	*pLight = mpLightSources[i];
+
+        pLight->mIsAmbient =
+            !pLight->moShaderInst->GetShader()->mHasDirPosInstructions;
+    }
+}
+
+//==================================================================
+void State::waitPendingShaders()
+{
+    for (size_t i=0; i < mPendingShaders.size(); ++i)
+    {
+        PendingShader	&pend = mPendingShaders[i];
+
+        try {
+            pend.mFuture.get();
+        }
+        catch ( ... )
+        {
+            printf( "SHADER ERR> Could not load '%s'\n\n", pend.mFullPathName.c_str() );
+
+            // references are already out there.. so leave the shader
+            // empty (it does nothing), or turn it into the alternate one
+            pend.moShader->Clear();
+
+            if ( pend.mAlternateName.length() )
+                loadAlternateShader( pend.moShader.get(), pend.mAlternateName.c_str() );
+        }
+    }
+
+    mPendingShaders.clear();
+}
+
+//==================================================================
+void State::loadAlternateShader( SVM::Shader *pShader, const char *pAlternateName )
+{
+    DStr	altFullPathName = findShaderFile( pAlternateName );
+
+    SVM::Shader::CtorParams	params;
+    params.pName			= pAlternateName;
+    params.pBaseIncDir		= GetDefShadersDir();
+    params.pSourceFileName	= altFullPathName.c_str();
+    params.pCacheDir		= mParams.mShaderCacheDir.c_str();
+
+    try {
+        if ( altFullPathName.length() )
+            pShader->Load( params, GetFileManager() );
+    }
+    catch ( ... )
+    {
+        pShader->Clear();
+    }
+}
+
 //==================================================================
 void State::makeDefaultShaders( const char *pBasePath )
 {
@@ -238,11 +333,16 @@ void State::makeDefaultShaders( const char *pBasePath )
 //==================================================================
 State::~State()
 {
+    // don't leave loads running on shaders about to be released
+    mShaderLoadTasks.Wait();
+
+    for (size_t i=0; i < mpObjectDefs.size(); ++i)
+        DDELETE( mpObjectDefs[i] );
+
     mModeStack.clear();
     mOptionsStack.clear();
     mAttributesStack.clear();
-    mTransformOpenStack.clear();
-    mTransformCloseStack.clear();
+    mTransformStack.clear();
 }
 
 //==================================================================
@@ -250,7 +350,7 @@ void State::pushStacks( const u_int flags )
 {
     if ( flags & SF_OPTS )	mOptionsStack.push();
     if ( flags & SF_ATRB )	mAttributesStack.push();
-    if ( flags & SF_TRAN )	mTransformOpenStack.push(), mTransformCloseStack.push();
+    if ( flags & SF_TRAN )	mTransformStack.push();
 }
 
 //==================================================================
@@ -258,7 +358,7 @@ void State::popStacks( const u_int flags )
 {
     if ( flags & SF_OPTS )	mOptionsStack.pop();
     if ( flags & SF_ATRB )	mAttributesStack.pop();
-    if ( flags & SF_TRAN )	mTransformOpenStack.pop(), mTransformCloseStack.pop();
+    if ( flags & SF_TRAN )	mTransformStack.pop();
 }
 
 //==================================================================
@@ -274,18 +374,31 @@ void State::End()
 //==================================================================
 void State::FrameBegin( int frame )
 {
+    if NOT( VerifyOutsideProcedural( "FrameBegin" ) )
+        return;
+
     pushMode( MD_FRAME );
     pushStacks( SF_OPTS | SF_ATRB | SF_TRAN );
 }
 //==================================================================
 void State::FrameEnd()
 {
+    if NOT( VerifyOutsideProcedural( "FrameEnd" ) )
+        return;
+
     popStacks( SF_OPTS | SF_ATRB | SF_TRAN );
     popMode( MD_FRAME );
 }
 //==================================================================
 void State::WorldBegin()
 {
+    if NOT( VerifyOutsideProcedural( "WorldBegin" ) )
+        return;
+
+    // shaders and textures are kept from the previous worlds, unless
+    // their files have changed since (e.g. a shadow map just rendered)
+    mResManager.DropChanged( GetFileManager() );
+
     // tell the options what drivers we have available
     mOptionsStack.top().Finalize(
                     mParams.mpFramework->mParams.mFallBackFileDisplay,
@@ -294,19 +407,24 @@ void State::WorldBegin()
     pushMode( MD_WORLD );
 
     // store the current (camera) transformation
-    mMtxWorldCamera = mTransformOpenStack.top().GetMatrix();
+    mMtxWorldCamera = mTransformStack.top().GetMatrix();
 
     pushStacks( SF_OPTS | SF_ATRB | SF_TRAN );
 
     // initialize the world transformation
-    mTransformOpenStack.top().SetIdentity();
-    mTransformCloseStack.top().SetIdentity();
+    mTransformStack.top().SetIdentity();
 
     mParams.mpFramework->WorldBegin( mOptionsStack.top(), mMtxWorldCamera );
 }
 //==================================================================
 void State::WorldEnd()
 {
+    if NOT( VerifyOutsideProcedural( "WorldEnd" ) )
+        return;
+
+    // shaders are needed from here on
+    ResolveShaders();
+
     mParams.mpFramework->WorldEnd();
 
     popStacks( SF_OPTS | SF_ATRB | SF_TRAN );
@@ -328,7 +446,7 @@ void State::AttributeEnd()
 void State::TransformBegin()
 {
     //printf( ">> " );
-    //mTransformOpenStack.top().mMatrix.PrintOut();
+    //mTransformStack.top().mMatrix.PrintOut();
 
     pushMode( MD_TRANSFORM );
     pushStacks( SF_TRAN );
@@ -340,7 +458,7 @@ void State::TransformEnd()
     popMode( MD_TRANSFORM );
 
     //printf( "<< " );
-    //mTransformOpenStack.top().mMatrix.PrintOut();
+    //mTransformStack.top().mMatrix.PrintOut();
 }
 //==================================================================
 void State::SolidBegin( RtToken operation )
@@ -357,26 +475,292 @@ void State::SolidEnd()
 //==================================================================
 ObjectHandle State::ObjectBegin()
 {
+    if ( mpCurObjectDef )
+        ErrHandler( E_NESTING );
+
     pushMode( MD_OBJECT );
     pushStacks( SF_ATRB | SF_TRAN );
 
-    return NULL;
+    // primitives are defined in the object's space, and placed
+    // by the transformation current at ObjectInstance
+    mTransformStack.top().SetIdentity();
+
+    mpCurObjectDef = DNEW ObjectDef();
+    mpObjectDefs.push_back( mpCurObjectDef );
+
+    return (ObjectHandle)mpCurObjectDef;
 }
 //==================================================================
 void State::ObjectEnd()
 {
     popStacks( SF_ATRB | SF_TRAN );
     popMode( MD_OBJECT );
+
+    mpCurObjectDef = NULL;
 }
 //==================================================================
 void State::MotionBegin( int n, const float times[] )
 {
+    if ( isInMotion() )
+        ErrHandler( E_NESTING );
+
+    if ( n < 1 )
+        ErrHandler( E_BADARGUMENT, "MotionBegin needs at least one time" );
+
     pushMode( MD_MOTION );
+
+    mMotionTimes.assign( times, times + n );
+    mMotionKeyIdx		= 0;
+    mpMotionFirstPrim	= NULL;
 }
 //==================================================================
 void State::MotionEnd()
 {
     popMode( MD_MOTION );
+
+    mMotionTimes.clear();
+    mpMotionFirstPrim = NULL;
+}
+//==================================================================
+void State::DelayedBegin( const Attributes &attr, const Transform &xform )
+{
+    DelayedMark	&mark = Dgrow( mDelayedMarks );
+    mark.mModesN	= mModeStack.size();
+    mark.mAttribsN	= mAttributesStack.size();
+    mark.mTransN	= mTransformStack.size();
+
+    pushMode( MD_PROCEDURAL );
+    pushStacks( SF_ATRB | SF_TRAN );
+
+    mAttributesStack.top()	= attr;
+    mTransformStack.top()	= xform;
+
+    // not the same as the primitives inserted last
+    mAttribsRevTrack.BumpRevision();
+    mTransRevTrack.BumpRevision();
+}
+//==================================================================
+/// False if the archive left some block open, closed here anyway
+bool State::DelayedEnd()
+{
+    // shaders of the archive, before its primitives are rendered
+    waitPendingShaders();
+
+    DelayedMark	mark = mDelayedMarks.back();
+    mDelayedMarks.pop_back();
+
+    bool	isBalanced =
+                mModeStack.size() == mark.mModesN + 1 &&
+                mModeStack.back() == MD_PROCEDURAL;
+
+    mModeStack.resize( mark.mModesN );
+
+    while ( mAttributesStack.size() > mark.mAttribsN )	mAttributesStack.pop();
+    while ( mTransformStack.size() > mark.mTransN )		mTransformStack.pop();
+
+    mpCurObjectDef		= NULL;
+    mMotionTimes.clear();
+    mpMotionFirstPrim	= NULL;
+
+    mAttribsRevTrack.BumpRevision();
+    mTransRevTrack.BumpRevision();
+
+    return isBalanced;
+}
+//==================================================================
+/// How much of the last motion key is blended in at shutter open
+/// and at shutter close
+void State::getMotionBlend( float out_blend[2] ) const
+{
+    float	t0 = mMotionTimes.front();
+    float	t1 = mMotionTimes.back();
+
+    if ( t1 == t0 )
+    {
+        out_blend[0] = 0;
+        out_blend[1] = 0;
+        return;
+    }
+
+    const Options	&opt = mOptionsStack.top();
+
+    out_blend[0] = DClamp( (opt.mOpenShutter  - t0) / (t1 - t0), 0.f, 1.f );
+    out_blend[1] = DClamp( (opt.mCloseShutter - t0) / (t1 - t0), 0.f, 1.f );
+}
+//==================================================================
+/// Unit quaternion of an orthonormal rotation matrix
+static Float4 rotMatrixToQuat( const Matrix44 &m )
+{
+    float	tr = m.mij(0,0) + m.mij(1,1) + m.mij(2,2);
+
+    if ( tr > 0 )
+    {
+        float	s = sqrtf( tr + 1 ) * 2;
+        return Float4(
+                (m.mij(1,2) - m.mij(2,1)) / s,
+                (m.mij(2,0) - m.mij(0,2)) / s,
+                (m.mij(0,1) - m.mij(1,0)) / s,
+                s * 0.25f );
+    }
+
+    if ( m.mij(0,0) > m.mij(1,1) && m.mij(0,0) > m.mij(2,2) )
+    {
+        float	s = sqrtf( 1 + m.mij(0,0) - m.mij(1,1) - m.mij(2,2) ) * 2;
+        return Float4(
+                s * 0.25f,
+                (m.mij(0,1) + m.mij(1,0)) / s,
+                (m.mij(0,2) + m.mij(2,0)) / s,
+                (m.mij(1,2) - m.mij(2,1)) / s );
+    }
+
+    if ( m.mij(1,1) > m.mij(2,2) )
+    {
+        float	s = sqrtf( 1 + m.mij(1,1) - m.mij(0,0) - m.mij(2,2) ) * 2;
+        return Float4(
+                (m.mij(0,1) + m.mij(1,0)) / s,
+                s * 0.25f,
+                (m.mij(1,2) + m.mij(2,1)) / s,
+                (m.mij(2,0) - m.mij(0,2)) / s );
+    }
+
+    float	s = sqrtf( 1 + m.mij(2,2) - m.mij(0,0) - m.mij(1,1) ) * 2;
+    return Float4(
+            (m.mij(0,2) + m.mij(2,0)) / s,
+            (m.mij(1,2) + m.mij(2,1)) / s,
+            s * 0.25f,
+            (m.mij(0,1) - m.mij(1,0)) / s );
+}
+
+//==================================================================
+/// Rotation matrix of a unit quaternion, same layout as Matrix44::Rot()
+static Matrix44 quatToRotMatrix( const Float4 &q )
+{
+    float	x = q.x(), y = q.y(), z = q.z(), w = q.w();
+
+    return Matrix44(
+            1 - 2*(y*y + z*z),	2*(x*y + z*w),		2*(x*z - y*w),		0,
+            2*(x*y - z*w),		1 - 2*(x*x + z*z),	2*(y*z + x*w),		0,
+            2*(x*z + y*w),		2*(y*z - x*w),		1 - 2*(x*x + y*y),	0,
+            0,					0,					0,					1 );
+}
+
+//==================================================================
+static Float4 quatSlerp( const Float4 &a, Float4 b, float t )
+{
+    float	cosAng = a.x()*b.x() + a.y()*b.y() + a.z()*b.z() + a.w()*b.w();
+
+    // take the short way around
+    if ( cosAng < 0 )
+    {
+        b = -b;
+        cosAng = -cosAng;
+    }
+
+    float	wa = 1 - t;
+    float	wb = t;
+
+    if ( cosAng < 0.9995f )
+    {
+        float	ang = acosf( cosAng );
+        float	oosin = 1.0f / sinf( ang );
+
+        wa = sinf( wa * ang ) * oosin;
+        wb = sinf( wb * ang ) * oosin;
+    }
+
+    Float4	q = a * wa + b * wb;
+
+    return q / sqrtf( q.x()*q.x() + q.y()*q.y() + q.z()*q.z() + q.w()*q.w() );
+}
+
+//==================================================================
+/// Splits an affine transform into a stretch (scale and shear), a
+/// rotation and a translation, so that m = stretch * rot * translation
+static void decomposeTransform(
+                    const Matrix44 &m,
+                    Matrix44 &out_stretch,
+                    Float4 &out_rot,
+                    Float3 &out_tra )
+{
+    // Gram-Schmidt on the rows. The cross product keeps it a proper
+    // rotation, any mirroring ends up in the stretch
+    Float3	r0 = m.GetV3(0).GetNormalized();
+    Float3	r1 = m.GetV3(1);
+    r1 = (r1 - r0 * r0.GetDot( r1 )).GetNormalized();
+    Float3	r2 = r0.GetCross( r1 );
+
+    Matrix44	rot( true );
+    rot.SetV3( 0, r0 );
+    rot.SetV3( 1, r1 );
+    rot.SetV3( 2, r2 );
+
+    out_stretch = m.GetAs33() * rot.GetTranspose();
+    out_rot		= rotMatrixToQuat( rot );
+    out_tra		= m.GetTranslation();
+}
+
+//==================================================================
+/// Blends two transforms by their components, as blending the
+/// matrices directly would shrink and shear a rotating object
+static Matrix44 mixTransforms( const Matrix44 &a, const Matrix44 &b, float t )
+{
+    if ( t <= 0 )	return a;
+    if ( t >= 1 )	return b;
+
+    // only affine transforms can be decomposed
+    for (size_t i=0; i < 4; ++i)
+    {
+        if ( a.mij(i,3) != (i == 3 ? 1.f : 0.f) ||
+             b.mij(i,3) != (i == 3 ? 1.f : 0.f) )
+            return DMix( a, b, t );
+    }
+
+    Matrix44	stretchA, stretchB;
+    Float4		rotA, rotB;
+    Float3		traA, traB;
+    decomposeTransform( a, stretchA, rotA, traA );
+    decomposeTransform( b, stretchB, rotB, traB );
+
+    Matrix44	out =
+        DMix( stretchA, stretchB, t ) *
+        quatToRotMatrix( quatSlerp( rotA, rotB, t ) );
+
+    out.SetV3( 3, DMix( traA, traB, t ) );
+
+    return out;
+}
+
+//==================================================================
+/// Transformations in a MotionBegin/End block are the keys of a
+/// linear motion. Only the first and the last keys are used
+void State::motionTransform( const Matrix44 &mtx, bool isConcat )
+{
+    u_int	keyIdx = mMotionKeyIdx++;
+
+    if ( keyIdx == 0 )
+        mMotionFirstMtx = mtx;
+
+    if ( keyIdx != mMotionTimes.size() - 1 )
+        return;
+
+    float	blend[2];
+    getMotionBlend( blend );
+
+    Matrix44	mtxOpen  = mixTransforms( mMotionFirstMtx, mtx, blend[0] );
+    Matrix44	mtxClose = mixTransforms( mMotionFirstMtx, mtx, blend[1] );
+
+    if ( isConcat )
+        mTransformStack.top().ConcatTransform( mtxOpen, mtxClose );
+    else
+        mTransformStack.top().SetMatrix( mtxOpen, mtxClose );
+}
+//==================================================================
+void State::concatTransform( const Matrix44 &mtx )
+{
+    if ( isInMotion() )
+        motionTransform( mtx, true );
+    else
+        mTransformStack.top().ConcatTransform( mtx );
 }
 
 // setting attributes
@@ -394,7 +778,24 @@ void State::Detail( const Bound &detail )
     if NOT( verifyOpType( OPTYPE_ATRB ) )
         return;
 
-    mAttributesStack.top().cmdDetail( detail );
+    // raster size of the bound, for the level of detail selection.
+    // Only known in the world block, and not for retained objects, as
+    // their final transformation isn't known yet
+    float	detailSize = -1;
+
+    bool	isInWorld = false;
+    for (size_t i=0; i < mModeStack.size(); ++i)
+        if ( mModeStack[i] == MD_WORLD )
+            isInWorld = true;
+
+    if ( isInWorld && NOT( mpCurObjectDef ) )
+    {
+        detailSize = mParams.mpFramework->mHider.RasterDetail(
+                                        detail,
+                                        mTransformStack.top().GetMatrix() );
+    }
+
+    mAttributesStack.top().cmdDetail( detail, detailSize );
 }
 //==================================================================
 void State::DetailRange(float	minVisible,
@@ -439,6 +840,15 @@ void State::Sides( int sides )
     mAttributesStack.top().cmdSides( sides );
 }
 
+//==================================================================
+void State::ShadingRate( float size )
+{
+    if NOT( verifyOpType( OPTYPE_ATRB ) )
+        return;
+
+    mAttributesStack.top().cmdShadingRate( size );
+}
+
 //==================================================================
 void State::Basis( RtToken ubasis, const float *pCustomUBasis, int ustep,
                    RtToken vbasis, const float *pCustomVBasis, int vstep )
@@ -481,6 +891,9 @@ void State::AreaLightSource( ParamList &params )
     if NOT( verifyOpType( OPTYPE_ATRB ) )
         return;
 
+    if NOT( VerifyOutsideProcedural( "AreaLightSource" ) )
+        return;
+
     mAttributesStack.top().cmdLightSource( params );
 }
 
@@ -490,6 +903,9 @@ void State::LightSource( ParamList &params )
     if NOT( verifyOpType( OPTYPE_ATRB ) )
         return;
 
+    if NOT( VerifyOutsideProcedural( "LightSource" ) )
+        return;
+
     mAttributesStack.top().cmdLightSource( params );
 }
 
@@ -501,9 +917,15 @@ void State::Declare( ParamList &params )
         DASSTHROW( 0, ("Broken declare ?") );
     }
 
+    if NOT( VerifyOutsideProcedural( "Declare" ) )
+        return;
+
     const char *pSymName = params[0].PChar();
     const char *pSymType = params[1].PChar();
 
+    // primitives being split may be looking up symbols
+    mParams.mpFramework->WaitSplitting();
+
     mGlobalSyms.AddGlob( pSymType, pSymName, NULL, Symbol::CLASS_MSK_UNIFORM );
 
     //mGlobalSyms.Add( );
@@ -615,7 +1037,7 @@ void State::PixelSamples( int samplesX, int samplesY )
 //==================================================================
 void State::Identity()
 {
-    mTransformOpenStack.top().SetIdentity();
+    mTransformStack.top().SetIdentity();
 }
 
 //==================================================================
@@ -624,7 +1046,7 @@ void State::ConcatTransform( const Matrix44 &mtxLeft )
     if NOT( verifyOpType( OPTYPE_STD_XFORM ) )
         return;
 
-    mTransformOpenStack.top().ConcatTransform( mtxLeft );
+    concatTransform( mtxLeft );
 }
 
 //==================================================================
@@ -633,7 +1055,15 @@ void State::TransformCmd( const float *pMtx )
     if NOT( verifyOpType( OPTYPE_STD_XFORM ) )
         return;
 
-    mTransformOpenStack.top().CopyRowMajor( pMtx );
+    if ( isInMotion() )
+    {
+        Matrix44	mtx;
+        mtx.CopyRowMajor( pMtx );
+        motionTransform( mtx, false );
+        return;
+    }
+
+    mTransformStack.top().CopyRowMajor( pMtx );
 }
 
 //==================================================================
@@ -642,7 +1072,7 @@ void State::Scale( float sx, float sy, float sz )
     if NOT( verifyOpType( OPTYPE_STD_XFORM ) )
         return;
 
-    mTransformOpenStack.top().ConcatTransform( Matrix44::Scale( sx, sy, sz ) );
+    concatTransform( Matrix44::Scale( sx, sy, sz ) );
 }
 
 //==================================================================
@@ -651,7 +1081,7 @@ void State::Rotate( float angDeg, float ax, float ay, float az )
     if NOT( verifyOpType( OPTYPE_STD_XFORM ) )
         return;
 
-    mTransformOpenStack.top().ConcatTransform( Matrix44::Rot( DEG2RAD(angDeg), ax, ay, az ) );
+    concatTransform( Matrix44::Rot( DEG2RAD(angDeg), ax, ay, az ) );
 }
 
 //==================================================================
@@ -660,7 +1090,7 @@ void State::Translate( float tx, float ty, float tz )
     if NOT( verifyOpType( OPTYPE_STD_XFORM ) )
         return;
 
-    mTransformOpenStack.top().ConcatTransform( Matrix44::Translate( tx, ty, tz ) );
+    concatTransform( Matrix44::Translate( tx, ty, tz ) );
 }
 
 //==================================================================
@@ -83,6 +83,7 @@ bool State::verifyOpType( OpType optype )
         case MD_SOLID:
         case MD_OBJECT:
         case MD_MOTION:
+        case MD_PROCEDURAL:
             // set primitive
             break;
 
@@ -104,6 +105,7 @@ bool State::verifyOpType( OpType optype )
         case MD_SOLID:
         //case MD_OBJECT:	// exclude object...
         case MD_MOTION:
+        case MD_PROCEDURAL:
             // set primitive
             break;
 
@@ -117,6 +119,23 @@ bool State::verifyOpType( OpType optype )
     return true;
 }
 
+//==================================================================
+/// Delayed archives are read while rendering, where the global
+/// state must stay as it is
+bool State::VerifyOutsideProcedural( const char *pCmdName )
+{
+    for (size_t i=0; i < mModeStack.size(); ++i)
+    {
+        if ( mModeStack[i] == MD_PROCEDURAL )
+        {
+            ErrHandler( E_ILLSTATE, "%s is not allowed in a delayed archive", pCmdName );
+            return false;
+        }
+    }
+
+    return true;
+}
+
 //==================================================================
 bool State::verifyBasis( RtToken basis, int steps )
 {
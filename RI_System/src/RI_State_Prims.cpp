@@ -13,6 +13,7 @@
 #include "RI_Primitive_Poly.h"
 #include "RI_Primitive_Quadric.h"
 #include "RI_Primitive_Poly.h"
+#include "RI_Primitive_Procedural.h"
 
 //==================================================================
 namespace RI
@@ -21,9 +22,59 @@ namespace RI
 //==================================================================
 inline void State::insertPrimitive( PrimitiveBase *pPrim )
 {
+    // out of the range of the current level of detail
+    if NOT( mAttributesStack.top().IsLODVisible() )
+    {
+        DDELETE( pPrim );
+        return;
+    }
+
+    // a key of a deforming primitive ? The first key goes in, and it
+    // gets the last as the shape to move to
+    if ( isInMotion() )
+    {
+        u_int	keyIdx = mMotionKeyIdx++;
+
+        if ( keyIdx > 0 )
+        {
+            if ( keyIdx == mMotionTimes.size() - 1 && mpMotionFirstPrim )
+            {
+                if ( pPrim->mType != mpMotionFirstPrim->mType )
+                {
+                    DDELETE( pPrim );
+                    ErrHandler( E_BADARGUMENT, "Motion keys must be of the same primitive type" );
+                    return;
+                }
+
+                float	blend[2];
+                getMotionBlend( blend );
+
+                mpMotionFirstPrim->SetMotionClose( pPrim, blend );
+            }
+            else
+            {
+                // only the first and the last keys are used
+                DDELETE( pPrim );
+            }
+
+            return;
+        }
+
+        mpMotionFirstPrim = pPrim;
+    }
+
+    // in an object definition ?
+    if ( mpCurObjectDef )
+    {
+        mpCurObjectDef->Insert( pPrim,
+                      mAttributesStack.top(),
+                      mTransformStack.top() );
+        return;
+    }
+
     mParams.mpFramework->Insert( pPrim,
                       mAttributesStack.top(),
-                      mTransformOpenStack.top() );
+                      mTransformStack.top() );
 }
 
 //==================================================================
@@ -129,5 +180,69 @@ void State::PointsGeneralPolygons( ParamList &params )
     insertPrimitive( DNEW RI::PointsGeneralPolygons( params, mGlobalSyms ) );
 }
     
+//==================================================================
+void State::ObjectInstance( ObjectHandle handle )
+{
+    if ( mpCurObjectDef )
+        ErrHandler( E_NESTING, "ObjectInstance inside an object definition" );
+
+    ObjectDef	*pObjectDef = (ObjectDef *)handle;
+
+    bool	found = false;
+    for (size_t i=0; i < mpObjectDefs.size() && !found; ++i)
+        found = (mpObjectDefs[i] == pObjectDef);
+
+    if NOT( found )
+        ErrHandler( E_BADHANDLE );
+
+    insertPrimitive( DNEW RI::ObjectInstance( pObjectDef ) );
+}
+
+//==================================================================
+/// Where an archive of only geometry can be an instance of itself,
+/// same as having its primitives right here
+bool State::CanInstanceArchive() const
+{
+    Mode	curMode = mModeStack.back();
+
+    if ( mpCurObjectDef ||
+         (curMode != MD_WORLD &&
+          curMode != MD_ATTRIBUTE &&
+          curMode != MD_TRANSFORM &&
+          curMode != MD_PROCEDURAL) )
+        return false;
+
+    for (size_t i=0; i < mModeStack.size(); ++i)
+        if ( mModeStack[i] == MD_WORLD || mModeStack[i] == MD_PROCEDURAL )
+            return true;
+
+    return false;
+}
+
+//==================================================================
+/// False when the current attributes would make the primitives of the
+/// object differently from when it was defined
+bool State::IsObjectShapeCurrent( ObjectHandle handle ) const
+{
+    const ObjectDef	&objDef = *(const ObjectDef *)handle;
+
+    if NOT( objDef.mpUniqueAttribs.size() )
+        return true;
+
+    return objDef.mpUniqueAttribs[0]->IsSameShaping( mAttributesStack.top() );
+}
+
+//==================================================================
+void State::DelayedReadArchive( const char *pPathFName, const Bound &bound )
+{
+    if ( mpCurObjectDef )
+        ErrHandler( E_NESTING, "DelayedReadArchive inside an object definition" );
+
+    if ( isInMotion() )
+        ErrHandler( E_NESTING, "DelayedReadArchive inside a motion block" );
+
+    insertPrimitive( DNEW RI::DelayedArchive( pPathFName, bound ) );
+}
+
 //==================================================================
 }
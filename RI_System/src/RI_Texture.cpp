@@ -58,10 +58,7 @@ static const char *StrFindLastChar( const char *pStr, char ch )
 }
 
 //==================================================================
-/// Texture
-//==================================================================
-Texture::Texture( const char *pName, DUT::MemFile &file ) :
-    ResourceBase(pName, ResourceBase::TYPE_TEXTURE)
+static void loadImage( DIMG::Image &img, const char *pName, DUT::MemFile &file )
 {
     const char	*pDotExt = StrFindLastChar( pName, '.' );
 
@@ -72,13 +69,22 @@ Texture::Texture( const char *pName, DUT::MemFile &file ) :
     
     if ( 0 == strcasecmp( pDotExt, ".tif" ) || 0 == strcasecmp( pDotExt, ".mip" ) )
     {
-        DIMG::LoadTIFF( mImage, file, pName );
+        DIMG::LoadTIFF( img, file, pName );
     }
     else
     if ( 0 == strcasecmp( pDotExt, ".bmp" ) )
     {
-        DIMG::LoadBMP( mImage, file, pName );
+        DIMG::LoadBMP( img, file, pName );
     }
+}
+
+//==================================================================
+/// Texture
+//==================================================================
+Texture::Texture( const char *pName, DUT::MemFile &file ) :
+    ResourceBase(pName, ResourceBase::TYPE_TEXTURE)
+{
+    loadImage( mImage, pName, file );
 
     mS_to_X = Float_( (float)mImage.mWd-1 );
     mT_to_Y = Float_( (float)mImage.mHe-1 );
@@ -164,5 +170,266 @@ void Texture::Sample_1_filter( Float_ &dest, const Float_ &s00, const Float_ &t0
     dest = tmp * Float_( 1.0f / 255.0f );
 }
 
+//==================================================================
+/// TiledMap
+//==================================================================
+void TiledMap::Init( const DIMG::Image &img, u_int chansN )
+{
+    DASSERT( chansN >= 1 && chansN <= DIMG::Image::MAX_SAMP_PER_PIX );
+
+    mWd		= img.mWd;
+    mHe		= img.mHe;
+    mChansN	= chansN;
+    mTilesX	= (mWd + TILE_DIM-1) >> TILE_DIM_LOG2;
+
+    u_int	tilesY = (mHe + TILE_DIM-1) >> TILE_DIM_LOG2;
+
+    mTexels.resize( (size_t)mTilesX * tilesY * TILE_DIM * TILE_DIM * mChansN );
+
+    for (u_int y=0; y < mHe; ++y)
+    {
+        for (u_int x=0; x < mWd; ++x)
+        {
+            float	samps[ DIMG::Image::MAX_SAMP_PER_PIX ] = { 0 };
+
+            img.GetPixelAsFloat( x, y, samps );
+
+            // grey images fill all the channels
+            if ( img.mSampPerPix == 1 )
+                for (u_int c=1; c < mChansN; ++c)
+                    samps[c] = samps[0];
+
+            float	*pDes = (float *)GetTexel( x, y );
+
+            for (u_int c=0; c < mChansN; ++c)
+                pDes[c] = samps[c];
+        }
+    }
+}
+
+//==================================================================
+void TiledMap::SampleBilinear(
+                float *out_pVal,
+                float x,
+                float y,
+                int minX,
+                int maxX,
+                bool wrapX ) const
+{
+    float	x_flr = floorf( x );
+    float	y_flr = floorf( y );
+
+    float	u = x - x_flr;
+    float	v = y - y_flr;
+
+    int		x0 = (int)x_flr;
+    int		y0 = D::Clamp( (int)y_flr + 0, 0, (int)mHe-1 );
+    int		y1 = D::Clamp( (int)y_flr + 1, 0, (int)mHe-1 );
+    int		x1;
+
+    if ( wrapX )
+    {
+        int	spanX = maxX - minX + 1;
+
+        x0 = minX + ((x0 - minX) % spanX + spanX) % spanX;
+        x1 = (x0 + 1 > maxX) ? minX : x0 + 1;
+    }
+    else
+    {
+        x1 = D::Clamp( x0 + 1, minX, maxX );
+        x0 = D::Clamp( x0 + 0, minX, maxX );
+    }
+
+    const float	*p00 = GetTexel( (u_int)x0, (u_int)y0 );
+    const float	*p01 = GetTexel( (u_int)x1, (u_int)y0 );
+    const float	*p10 = GetTexel( (u_int)x0, (u_int)y1 );
+    const float	*p11 = GetTexel( (u_int)x1, (u_int)y1 );
+
+    for (u_int c=0; c < mChansN; ++c)
+    {
+        float	top = (1 - u) * p00[c] + u * p01[c];
+        float	bot = (1 - u) * p10[c] + u * p11[c];
+
+        out_pVal[c] = (1 - v) * top + v * bot;
+    }
+}
+
+//==================================================================
+/// ShadowMap
+//==================================================================
+ShadowMap::ShadowMap( const char *pName, DUT::MemFile &file ) :
+    ResourceBase(pName, ResourceBase::TYPE_SHADOWMAP)
+{
+    DIMG::Image			img;
+    DIMG::TIFFDepthInfo	info;
+
+    DIMG::LoadTIFFDepth( img, info, file, pName );
+
+    mMap.Init( img, 1 );
+
+    mMtxWorldCamera.CopyRowMajor( info.mMtxWorldCamera );
+    mMtxWorldProj.CopyRowMajor( info.mMtxWorldScreen );
+}
+
+//==================================================================
+void ShadowMap::Sample_PCF(
+                Float_			&dest,
+                const Float3_	&pos,
+                const Matrix44	&mtxCurWorld,
+                const Float_	&bias ) const
+{
+    static const int	PCF_HDIM = 2;	// 4x4 taps
+    static const Float_	zero( 0.f );
+
+    Matrix44	mtxCurLight		= mtxCurWorld * mMtxWorldCamera;
+    Matrix44	mtxCurLightProj	= mtxCurWorld * mMtxWorldProj;
+
+    Float4_	homoP	= V4__V3W1_Mul_M44<Float_>( pos, mtxCurLightProj );
+    Float3_	posLS	= V3__V3W1_Mul_M44<Float_>( pos, mtxCurLight );
+
+    Float_	halfWd	= Float_( mMap.GetWd() * 0.5f );
+    Float_	halfHe	= Float_( mMap.GetHe() * 0.5f );
+
+    Float_	ooW		= Float_( 1.f ) / homoP.w();
+    Float_	mapX	=  homoP.x() * ooW * halfWd + halfWd;
+    Float_	mapY	= -homoP.y() * ooW * halfHe + halfHe;
+
+    Float_	testZ	= posLS.z() - bias;
+
+    // base texel for each SIMD item.. behind the light is
+    // pushed out of the map, to be never in shadow
+    int		baseX[ DMT_SIMD_FLEN ];
+    int		baseY[ DMT_SIMD_FLEN ];
+
+    for (size_t smdi=0; smdi < DMT_SIMD_FLEN; ++smdi)
+    {
+        if ( homoP.w()[smdi] > 0 )
+        {
+            baseX[smdi] = (int)floorf( mapX[smdi] ) - PCF_HDIM + 1;
+            baseY[smdi] = (int)floorf( mapY[smdi] ) - PCF_HDIM + 1;
+        }
+        else
+        {
+            baseX[smdi] = INT_MIN / 2;
+            baseY[smdi] = INT_MIN / 2;
+        }
+    }
+
+    int		mapWd = (int)mMap.GetWd();
+    int		mapHe = (int)mMap.GetHe();
+
+    Float_	occluded( 0.f );
+
+    for (int ty=0; ty < PCF_HDIM*2; ++ty)
+    {
+        for (int tx=0; tx < PCF_HDIM*2; ++tx)
+        {
+            // gather..
+            Float_	mapZ;
+
+            for (size_t smdi=0; smdi < DMT_SIMD_FLEN; ++smdi)
+            {
+                int	x = baseX[smdi] + tx;
+                int	y = baseY[smdi] + ty;
+
+                if ( x >= 0 && y >= 0 && x < mapWd && y < mapHe )
+                    mapZ[smdi] = *mMap.GetTexel( (u_int)x, (u_int)y );
+                else
+                    mapZ[smdi] = FLT_MAX;
+            }
+
+            // ..and compare all at once
+            occluded += DMax( DSign( testZ - mapZ ), zero );
+        }
+    }
+
+    dest = occluded * Float_( 1.f / (PCF_HDIM*2 * PCF_HDIM*2) );
+}
+
+//==================================================================
+/// EnvMap
+//==================================================================
+EnvMap::EnvMap( const char *pName, DUT::MemFile &file ) :
+    ResourceBase(pName, ResourceBase::TYPE_ENVMAP)
+{
+    DIMG::Image	img;
+    loadImage( img, pName, file );
+
+    mMap.Init( img, 3 );
+
+    // 6 square faces side by side, otherwise assume lat-long
+    if ( img.mWd == img.mHe * 6 )
+        mLayout = LAYOUT_CUBESTRIP;
+    else
+        mLayout = LAYOUT_LATLONG;
+}
+
+//==================================================================
+void EnvMap::Sample( Float3_ &dest, const Float3_ &dir ) const
+{
+    int		mapWd = (int)mMap.GetWd();
+    int		mapHe = (int)mMap.GetHe();
+
+    for (size_t smdi=0; smdi < DMT_SIMD_FLEN; ++smdi)
+    {
+        float	dx = dir[0][smdi];
+        float	dy = dir[1][smdi];
+        float	dz = dir[2][smdi];
+
+        float	val[3];
+
+        if ( mLayout == LAYOUT_LATLONG )
+        {
+            // longitude around +z, with +z at the top of the map
+            float	len = sqrtf( dx*dx + dy*dy + dz*dz );
+            float	ooLen = len > 0 ? 1.f / len : 0.f;
+
+            float	s = 0.5f + atan2f( dy, dx ) * (float)(0.5 / M_PI);
+            float	t = acosf( D::Clamp( dz * ooLen, -1.f, 1.f ) ) * (float)(1 / M_PI);
+
+            mMap.SampleBilinear(
+                    val,
+                    s * mapWd - 0.5f,
+                    t * mapHe - 0.5f,
+                    0,
+                    mapWd - 1,
+                    true );
+        }
+        else
+        {
+            float	ax = fabsf( dx );
+            float	ay = fabsf( dy );
+            float	az = fabsf( dz );
+
+            int		face;
+            float	sc, tc, ma;
+
+            if ( ax >= ay && ax >= az )	{ ma = ax; if ( dx > 0 ) { face = 0; sc = -dz; } else { face = 1; sc =  dz; } tc = -dy; }	else
+            if ( ay >= az )				{ ma = ay; if ( dy > 0 ) { face = 2; tc =  dz; } else { face = 3; tc = -dz; } sc =  dx; }
+            else						{ ma = az; if ( dz > 0 ) { face = 4; sc =  dx; } else { face = 5; sc = -dx; } tc = -dy; }
+
+            float	ooMa = ma > 0 ? 1.f / ma : 0.f;
+
+            float	s = (sc * ooMa + 1) * 0.5f;
+            float	t = (tc * ooMa + 1) * 0.5f;
+
+            int		faceDim = mapHe;
+
+            // clamp within the face, no filtering across faces
+            mMap.SampleBilinear(
+                    val,
+                    (face + s) * faceDim - 0.5f,
+                    t * faceDim - 0.5f,
+                    face * faceDim,
+                    face * faceDim + faceDim - 1,
+                    false );
+        }
+
+        dest[0][smdi] = val[0];
+        dest[1][smdi] = val[1];
+        dest[2][smdi] = val[2];
+    }
+}
+
 //==================================================================
 }
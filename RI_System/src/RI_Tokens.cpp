@@ -12,6 +12,7 @@
 
 RtToken	RI_FRAMEBUFFER		= "framebuffer";
 RtToken RI_FILE				= "file";
+RtToken RI_ZFILE			= "zfile";
 RtToken	RI_RGB				= "rgb";
 RtToken RI_RGBA				= "rgba";
 RtToken	RI_RGBZ				= "rgbz";
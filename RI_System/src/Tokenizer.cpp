@@ -3,10 +3,11 @@
 ///
 /// Created by Davide Pasca - 2008/11/19
 /// See the file "license.txt" that comes with this project for
-/// copyright info. 
+/// copyright info.
 //==================================================================
 
 #include "stdafx.h"
+#include <charconv>
 #include "Tokenizer.h"
 
 //===============================================================
@@ -22,387 +23,474 @@ const char *Tokenizer::GetDataTypeName( DataType dtype )
     case DT_INT_ARRAY:		return "INT_ARRAY";
     case DT_FLOAT_ARRAY:	return "FLOAT_ARRAY";
     case DT_STRING_ARRAY:	return "STRING_ARRAY";
+    case DT_EOF:			return "EOF";
     }
-    
+
     DASSERT( 0 );
     return "UNKNOWN";
 }
 
-/*
 //===============================================================
-static bool isFloatStr( const char *pStr )
+static inline bool isWhite( char ch )
 {
-    const char *pStrRun = pStr;
-
-    char ch;
-    while ( ch = *pStrRun++ )
-    {
-        if NOT( (ch >= '0' && ch <= '9') ||
-                ch == '.' ||
-                ch == 'e' ||
-                ch == 'f' ||
-                ch == 'E' ||
-                ch == 'F' ||
-                ch == '-' ||
-                ch == '+'  )
-        {
-            return false;
-        }
-    }
-
-    return true;
-}
-*/
-
-//===============================================================
-static bool isFloatStr( const char *pStr )
-{
-    if (
-        strchr( pStr, '.' ) ||
-        strchr( pStr, 'f' ) ||
-        strchr( pStr, 'F' ) ||
-        strchr( pStr, 'd' ) ||
-        strchr( pStr, 'D' ) ||
-        strchr( pStr, 'e' ) ||
-        strchr( pStr, 'E' ) )
-    {
-        double tmp;
-        return 1 == sscanf( pStr, "%lf", &tmp );
-    }
-    else
-        return false;
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\f';
 }
 
 //===============================================================
-static bool isStringStr( const char *pStr )
+static inline bool isDelimiter( char ch )
 {
-    size_t	len = strlen( pStr );
-
-    if ( len >= 2 && pStr[0] == '"' && pStr[len-1] == '"' )
-        return true;
-    else
-        return false;
+    // binary tokens need no separation from the ASCII ones
+    return isWhite( ch ) || ch == '"' || ch == '[' || ch == ']' || ch == '#' ||
+            (U8)ch >= 0200;
 }
 
 //===============================================================
-static bool isIntStr( const char *pStr )
+static inline bool isDigit( char ch )
 {
-    char ch;
-    while ( (ch = *pStr++) )
-    {
-        if NOT( (ch >= '0' && ch <= '9') ||
-                ch == '-' ||
-                ch == '+'  )
-            return false;
-    }
-    
-    return true;
+    return ch >= '0' && ch <= '9';
 }
 
 //===============================================================
 static bool isAlphanumStr( const char *pStr )
 {
-    if NOT( pStr[0] )
-        return false;
-
     if ( (pStr[0] >= 'a' && pStr[0] <= 'z') ||
          (pStr[0] >= 'A' && pStr[0] <= 'Z') ||
          (pStr[0] >= '_' ) )
     {
         return true;
-    }	
-    
+    }
+
     return false;
 }
 
 //===============================================================
-static bool isWhite( char ch )
+enum NumType
 {
-    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\f';
+    NUM_NONE,
+    NUM_INT,
+    NUM_FLOAT,
+};
+
+//===============================================================
+/// Only digits and signs make an integer. Anything with a '.', an
+/// exponent or a 'f'/'d' suffix is a float.
+/// Parsed in a single pass, without copying the token
+static NumType parseNumber(
+                const char	*pBeg,
+                const char	*pEnd,
+                int			&out_int,
+                float		&out_flt )
+{
+    char	ch0 = *pBeg;
+
+    if NOT( isDigit( ch0 ) || ch0 == '.' || ch0 == '-' || ch0 == '+' )
+        return NUM_NONE;
+
+    bool	isInt = true;
+    bool	hasFloatChar = false;
+
+    for (const char *p=pBeg; p < pEnd; ++p)
+    {
+        char	ch = *p;
+
+        if ( isDigit( ch ) || ch == '-' || ch == '+' )
+            continue;
+
+        isInt = false;
+
+        if ( ch == '.' ||
+             ch == 'e' || ch == 'E' ||
+             ch == 'f' || ch == 'F' ||
+             ch == 'd' || ch == 'D' )
+        {
+            hasFloatChar = true;
+        }
+    }
+
+    // from_chars doesn't take the plus sign
+    const char	*pNum = pBeg;
+    if ( *pNum == '+' )
+        ++pNum;
+
+    if ( isInt )
+    {
+        // like atoi(), 0 if there is no number at all
+        out_int = 0;
+        std::from_chars( pNum, pEnd, out_int );
+        return NUM_INT;
+    }
+
+    if NOT( hasFloatChar )
+        return NUM_NONE;
+
+    // double first, then float, same as atof()
+    double	val;
+    if ( std::from_chars( pNum, pEnd, val ).ec != std::errc() )
+        return NUM_NONE;
+
+    out_flt = (float)val;
+    return NUM_FLOAT;
 }
 
 //===============================================================
-static bool isNewLine( char ch )
+Tokenizer::Tokenizer( DIO::InputStream &stream ) :
+    mpCur(NULL),
+    mpEnd(NULL),
+    mLineNumber(1),
+    mTokenLineNumber(1),
+    mpStream(&stream),
+    mIsStreamEnd(false),
+    mpAlphanum(NULL),
+    mAlphanumLen(0),
+    mAlphanumCmdID(RI::CMDID_UNKNOWN)
 {
-    return ch == '\n' || ch == '\r' || ch == '\f';
+    mWindow.resize( STREAM_WINDOW_SIZE );
 }
 
 //===============================================================
-bool Tokenizer::AddChar( char ch )
+/// Streaming only. Keeps the data from mpCur on, and reads more after
+/// it, until there are at least minAvail bytes or the stream is over.
+/// Anything pointing in the window before the call is not valid after
+bool Tokenizer::refill( size_t minAvail )
 {
-    if ( mState != STRING && !mIsInArrayItemQuotedString )
+    if ( !mpStream || mIsStreamEnd )
+        return false;
+
+    size_t	left = (size_t)(mpEnd - mpCur);
+
+    if ( left )
+        memmove( &mWindow[0], mpCur, left );
+
+    // grow after moving, mpCur is in the old window
+    if ( minAvail > mWindow.size() )
+        mWindow.resize( DMAX( minAvail, mWindow.size() * 2 ) );
+
+    char	*pWin = &mWindow[0];
+    char	*pWinEnd = pWin + mWindow.size();
+    char	*pFill = pWin + left;
+
+    mpCur = pWin;
+
+    bool	gotData = false;
+
+    do
     {
-        if ( ch == '#' )
+        size_t	n = mpStream->Read( pFill, (size_t)(pWinEnd - pFill) );
+
+        if NOT( n )
         {
-            if ( mStateInComment )
-            {
-                // handle the ## case
-                if ( mStateCommentStarted )
-                {
-                    // not a comment anymore
-                    // and return
-                    mStateInComment = false;
-                    mStateCommentStarted = false;
-                    return false;
-                }
-            }
-            else
-            {
-                // it's a comment, and it's the first char of it
-                mStateInComment = true;
-
-                // This is to handle ## at the beginning of the line
-                // ... for the time being, simply ignore it
-                //mStateCommentStarted = true;
-                mStateCommentStarted = false;
-                return false;
-            }
+            mIsStreamEnd = true;
+            break;
         }
-    }
-    
-    if ( mStateInComment )
-    {
-        if ( isNewLine( ch ) )
-        {
-            if ( ch == '\n' )
-                mLineNumber += 1;
 
-            mStateInComment = false;
-            //ResetState();
-        }
+        pFill	+= n;
+        gotData = true;
 
-        // not start of a comment anymore 8)
-        mStateCommentStarted = false;
-    }
-    else
-    if ( mState == UNKNOWN )
+    } while ( (size_t)(pFill - pWin) < minAvail );
+
+    mpEnd = pFill;
+
+    return gotData;
+}
+
+//===============================================================
+void Tokenizer::skipWhiteAndComments()
+{
+    while ( mpCur < mpEnd || refill() )
     {
-        if ( ch == '"' )
+        char	ch = *mpCur;
+
+        if ( ch == '\n' )
         {
-            mState = STRING;
-            setDataType();
+            mLineNumber += 1;
+            ++mpCur;
         }
         else
-        if ( ch == '[' )
+        if ( isWhite( ch ) )
         {
-            mFloatArray.clear();
-            mIntArray.clear();
-            mStringArray.clear();
-            mState = ARRAY;
-            mArrayType = 0;
+            ++mpCur;
         }
         else
+        if ( ch == '#' )
         {
-            if NOT( isWhite( ch ) )
-            {
-                mState = NORMAL;
-                mCurToken += ch;
-            }
-            else
-                if ( ch == '\n' )
-                    mLineNumber += 1;			
+            // the new line is left for the loop to count
+            do {
+                ++mpCur;
+            } while ( (mpCur < mpEnd || refill()) && *mpCur != '\n' );
         }
+        else
+            break;
     }
-    else
-    if ( mState == NORMAL )
+}
+
+//===============================================================
+const char *Tokenizer::readWord()
+{
+    while ( true )
     {
-        if ( isWhite( ch ) )
-        {
-            if ( ch == '\n' )
-                mLineNumber += 1;
+        const char	*pBeg = mpCur;
 
-            setDataType();
-            return true;
-        }
-        else
-        {
-            mCurToken += ch;
-        }
+        while ( mpCur < mpEnd && !isDelimiter( *mpCur ) )
+            ++mpCur;
+
+        if ( mpCur < mpEnd || !mpStream || mIsStreamEnd )
+            return pBeg;
+
+        // streaming and out of data, start again with more of it
+        size_t	len = (size_t)(mpCur - pBeg);
+        mpCur = pBeg;
+        refill( len * 2 + 1 );
     }
-    else
-    if ( mState == STRING )
+}
+
+//===============================================================
+/// Expects to be at the opening quote. No escape sequences
+void Tokenizer::readString( const char *&out_pStr, size_t &out_len )
+{
+    DASSERT( *mpCur == '"' );
+
+    int		begLineNumber = mLineNumber;
+
+    while ( true )
     {
-        if ( ch == '"' )
+        const char	*pQuote = mpCur;
+        const char	*pBeg = ++mpCur;
+
+        while ( mpCur < mpEnd && *mpCur != '"' )
         {
-            mDataString = mCurToken;
-            setDataType();
-            return true;
+            if ( *mpCur == '\n' )
+                mLineNumber += 1;
+
+            ++mpCur;
         }
-        else
+
+        if ( mpCur >= mpEnd && mpStream && !mIsStreamEnd )
         {
-            mCurToken += ch;
+            // streaming and out of data, start again with more of it
+            size_t	len = (size_t)(mpCur - pQuote);
+            mpCur = pQuote;
+            mLineNumber = begLineNumber;
+            refill( len * 2 + 1 );
+            continue;
         }
+
+        out_pStr	= pBeg;
+        out_len		= (size_t)(mpCur - pBeg);
+
+        // skip the closing quote
+        if ( mpCur < mpEnd )
+            ++mpCur;
+
+        return;
     }
-    else
-    if ( mState == ARRAY )
-    {
-        return inputHandleArray( ch );
-    }
-    
-    return false;
 }
 
 //===============================================================
-bool Tokenizer::inputHandleArray( char ch )
+/// The type of the array is chosen by its first item. An array of
+/// integers becomes of floats at the first float
+Tokenizer::DataType Tokenizer::readArray( RI::ParamList &out_params )
 {
-    bool	isEndOfArray = (ch == ']');
+    // UNKNOWN until the first item
+    u_int	arrType = RI::Param::UNKNOWN;
 
-    if ( ch == '"' )
+    while ( true )
     {
-        if ( mIsInArrayItemQuotedString )
+        skipWhiteAndComments();
+        skipBinaryDefinitions();
+
+        if ( mpCur >= mpEnd )
+            break;
+
+        char	ch = *mpCur;
+
+        if ( ch == ']' )
         {
-            mIsInArrayItemQuotedString = false;
-            if ( mArrayType && mArrayType != 's' )
-            {
-                DASSTHROW( false, ("Cannot mix strings with numerical values in arrays") );
-            }
-            //mCurToken += ch;
-            return false;
+            ++mpCur;
+            break;
         }
-        else
+
+        const char	*pStr = NULL;
+        size_t		len = 0;
+        NumType		numType = NUM_NONE;
+        int			intVal = 0;
+        float		fltVal = 0;
+
+        if ( ch == '"' )
         {
-            mIsInArrayItemQuotedString = true;
-            mArrayType = 's';
-            //mCurToken += ch;
-            return false;
+            readString( pStr, len );
         }
-    }
-    else
-    {
-        if ( mIsInArrayItemQuotedString )
+        else
+        if ( isBinaryCode( ch ) )
         {
-            mCurToken += ch;
-            return false;
-        }
-    }
-    
-    if ( isWhite( ch ) || isEndOfArray )
-    {
-        if ( ch == '\n' )
-            mLineNumber += 1;
+            BinValue	val;
+            readBinaryValue( val );
 
-        if ( mCurToken.length() != 0 )
-        {
-            if ( isStringStr( mCurToken.c_str() ) )
+            switch ( val.type )
             {
-                // initialize this array to string
-                if ( mArrayType == 0 )
-                    mArrayType = 's';
+            case BinValue::INT:		numType = NUM_INT;		intVal = val.intVal;	break;
+            case BinValue::FLOAT:	numType = NUM_FLOAT;	fltVal = val.fltVal;	break;
+            case BinValue::STRING:	pStr = val.pStr;		len = val.n;			break;
 
-                if ( mArrayType != 's'  )
-                {
-                    DASSTHROW( false, ("Cannot mix strings with numerical values in arrays") );
-                }
-            }
-            else
-            if ( isFloatStr( mCurToken.c_str() ) )
-            {
-                // initialize this array to float
-                if ( mArrayType == 0 )
-                    mArrayType = 'f';
+            case BinValue::FLOAT_ARRAY:
+                DASSTHROW( arrType != RI::Param::STR_ARR, ("Cannot mix strings with numerical values in arrays") );
 
-                if ( mArrayType != 'f' )
-                {
-                    changeToFloatArray();
-                }
-            }
-            else
-            {
-                // initialize this array to int
-                if ( mArrayType == 0 )
-                    mArrayType = 'i';
-            }
+                toFltArr( out_params, arrType );
 
-            // TODO: check types
-            if ( mArrayType == 'f' )
-            {
-                float val = (float)atof( mCurToken.c_str() );
-                mFloatArray.push_back( val );
+                readBinaryFloats( out_params, val.n );
+                continue;
+
+            case BinValue::REQUEST:
+                DASSTHROW( false, ("Unexpected request inside an array") );
             }
-            else
-            if ( mArrayType == 'i' )
+        }
+        else
+        {
+            const char	*pWord = readWord();
+
+            // stray '[' or the like
+            if ( pWord == mpCur )
             {
-                int val = atoi( mCurToken.c_str() );
-                mIntArray.push_back( val );
+                ++mpCur;
+                continue;
             }
-            else
-            if ( mArrayType == 's' )
+
+            numType = parseNumber( pWord, mpCur, intVal, fltVal );
+        }
+
+        if ( pStr )
+        {
+            DASSTHROW( arrType == RI::Param::UNKNOWN || arrType == RI::Param::STR_ARR,
+                        ("Cannot mix strings with numerical values in arrays") );
+
+            if ( arrType == RI::Param::UNKNOWN )
             {
-                mStringArray.push_back( mCurToken );
+                arrType = RI::Param::STR_ARR;
+                out_params.AddArr( arrType );
             }
-            
-            mCurToken = "";
+
+            out_params.AppendStr( pStr, len );
+            continue;
         }
 
-        if ( isEndOfArray )
+        DASSTHROW( arrType != RI::Param::STR_ARR, ("Cannot mix strings with numerical values in arrays") );
+
+        if ( numType == NUM_FLOAT )
         {
-            setDataType();
-            return true;
+            toFltArr( out_params, arrType );
+
+            out_params.AppendFlt( fltVal );
+        }
+        else
+        {
+            // not a number at all counts as a 0
+            if ( arrType == RI::Param::FLT_ARR )
+                out_params.AppendFlt( (float)intVal );
+            else
+            {
+                if ( arrType == RI::Param::UNKNOWN )
+                {
+                    arrType = RI::Param::INT_ARR;
+                    out_params.AddArr( arrType );
+                }
+
+                out_params.AppendInt( intVal );
+            }
         }
     }
-    else
-    {
-        mCurToken += ch;
-    }
-    
-    return false;
+
+    if ( arrType == RI::Param::INT_ARR )	return DT_INT_ARRAY;
+    if ( arrType == RI::Param::STR_ARR )	return DT_STRING_ARRAY;
+
+    // empty arrays are taken as of floats
+    toFltArr( out_params, arrType );
+
+    return DT_FLOAT_ARRAY;
 }
 
 //===============================================================
-void Tokenizer::setDataType()
+/// The array being read, as floats from now on
+void Tokenizer::toFltArr( RI::ParamList &out_params, u_int &io_arrType )
 {
-    if ( mState == UNKNOWN )
-        mDataType = DT_NONE;
+    if ( io_arrType == RI::Param::FLT_ARR )
+        return;
+
+    if ( io_arrType == RI::Param::INT_ARR )
+        out_params.ChangeIntArrToFltArr();
     else
-    if ( mState == NORMAL )
+        out_params.AddArr( RI::Param::FLT_ARR );
+
+    io_arrType = RI::Param::FLT_ARR;
+}
+
+
+
+//===============================================================
+Tokenizer::DataType Tokenizer::NextToken( RI::ParamList &out_params )
+{
+    skipWhiteAndComments();
+    skipBinaryDefinitions();
+
+    mTokenLineNumber = mLineNumber;
+
+    if ( mpCur >= mpEnd )
+        return DT_EOF;
+
+    char	ch = *mpCur;
+
+    if ( isBinaryCode( ch ) )
+        return readBinaryToken( out_params );
+
+    if ( ch == '"' )
     {
-        if ( isIntStr( mCurToken.c_str() ) )
-        {
-            mDataInt = atoi( mCurToken.c_str() );
-            mDataType = DT_INT;
-        }
-        else
-        if ( isFloatStr( mCurToken.c_str() ) )
-        {
-            mDataFloat = (float)atof( mCurToken.c_str() );
-            mDataType = DT_FLOAT;
-        }
-        else
-        if ( isAlphanumStr( mCurToken.c_str() ) )
-        {
-            mDataAlphanum = mCurToken;
-            mDataType = DT_ALPHANUMERIC;
-        }
-        else
-            mDataType = DT_NONE;		
+        const char	*pStr;
+        size_t		len;
+        readString( pStr, len );
+
+        out_params.AddStr( pStr, len );
+        return DT_STRING;
     }
-    else
-    if ( mState == ARRAY )
+
+    if ( ch == '[' )
     {
-        if ( mArrayType == 'f' )
-            mDataType = DT_FLOAT_ARRAY;
-        else
-        if ( mArrayType == 'i' )
-            mDataType = DT_INT_ARRAY;
-        else
-        if ( mArrayType == 's' )
-            mDataType = DT_STRING_ARRAY;
+        ++mpCur;
+        return readArray( out_params );
     }
-    else
-    if ( mState == STRING )
-        mDataType = DT_STRING;
-        
-    mCurToken = "";
-}
 
-//===============================================================
-void Tokenizer::changeToFloatArray()
-{
-    mArrayType = 'f';
-    DASSERT( mFloatArray.size() == 0 );
-    
-    mFloatArray.resize( mIntArray.size() );
-
-    for (size_t i=0; i < mIntArray.size(); ++i)
-        mFloatArray[i] = (float)mIntArray[i];
-}	
+    const char	*pWord = readWord();
+
+    // a stray ']'
+    if ( pWord == mpCur )
+    {
+        ++mpCur;
+        out_params.AddUnknown();
+        return DT_NONE;
+    }
+
+    int		intVal;
+    float	fltVal;
+
+    switch ( parseNumber( pWord, mpCur, intVal, fltVal ) )
+    {
+    case NUM_INT:
+        out_params.Add( intVal );
+        return DT_INT;
+
+    case NUM_FLOAT:
+        out_params.Add( fltVal );
+        return DT_FLOAT;
+
+    default:
+        break;
+    }
+
+    if ( isAlphanumStr( pWord ) )
+    {
+        mpAlphanum	= pWord;
+        mAlphanumLen	= (size_t)(mpCur - pWord);
+        mAlphanumCmdID	= RI::FindCommand( pWord, mAlphanumLen );
+        return DT_ALPHANUMERIC;
+    }
+
+    out_params.AddUnknown();
+    return DT_NONE;
+}
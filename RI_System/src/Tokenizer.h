@@ -3,7 +3,7 @@
 ///
 /// Created by Davide Pasca - 2008/111/19
 /// See the file "license.txt" that comes with this project for
-/// copyright info. 
+/// copyright info.
 //==================================================================
 
 #ifndef TOKENIZER_H
@@ -11,35 +11,40 @@
 
 #include "DSystem/include/DTypes.h"
 #include "DSystem/include/DContainers.h"
-#include <string>
+#include "RI_Param.h"
+#include "RI_Commands.h"
+#include "DSystem/include/DIO_Stream.h"
 
+//===============================================================
+/// Tokenizer
+/// Works over the whole data of a RIB file at once (usually mapped
+/// in memory), or over a window that slides along a stream.
+/// Values are parsed straight into the parameters list, the names
+/// of the commands are interned to a RI::CmdID as they are read
+/// (the text stays available as a view into the data).
+/// Binary RIB tokens are recognized by their first byte (0200 and
+/// above) and may be freely mixed with ASCII ones
 //===============================================================
 class Tokenizer
 {
-    enum StateEnum
-    {
-        UNKNOWN,
-        NORMAL,
-        STRING,
-        ARRAY,
-    };
-    
-    StateEnum		mState;
-    bool			mStateInComment;
-    bool			mStateCommentStarted;
+    const char		*mpCur;
+    const char		*mpEnd;
     int				mLineNumber;
+    int				mTokenLineNumber;
+
+    // streaming only
+    DIO::InputStream	*mpStream;
+    bool				mIsStreamEnd;
+    DVec<char>			mWindow;
 
-    int				mDataInt;
-    float			mDataFloat;
-    DStr			mDataString;
-    DStr			mDataAlphanum;
-    DVec<float>		mFloatArray;
-    DVec<int>		mIntArray;
-    DVec<DStr>		mStringArray;
-    char			mArrayType;
-    bool			mIsArrayOfQuotedStrings;
-    bool			mIsInArrayItemQuotedString;
-    DStr			mCurToken;
+    const char		*mpAlphanum;
+    size_t			mAlphanumLen;
+    RI::CmdID		mAlphanumCmdID;
+
+    // binary RIB: requests and strings defined along the way
+    DVec<DStr>		mBinReqNames;
+    DVec<RI::CmdID>	mBinReqCmdIDs;
+    DVec<DStr>		mBinStrings;
 
 public:
     enum DataType
@@ -52,58 +57,92 @@ public:
         DT_INT_ARRAY,
         DT_FLOAT_ARRAY,
         DT_STRING_ARRAY,
+        DT_EOF,
     };
-    
-    static const char *GetDataTypeName( DataType dtype );
 
-private:
-    DataType			mDataType;
+    static const char *GetDataTypeName( DataType dtype );
 
 public:
-    Tokenizer()
+    Tokenizer( const char *pData, size_t dataSize ) :
+        mpCur(pData),
+        mpEnd(pData + dataSize),
+        mLineNumber(1),
+        mTokenLineNumber(1),
+        mpStream(NULL),
+        mIsStreamEnd(true),
+        mpAlphanum(NULL),
+        mAlphanumLen(0),
+        mAlphanumCmdID(RI::CMDID_UNKNOWN)
     {
-        ResetState();
-        mLineNumber = 1;
     }
-    
+
+    // the data is pulled from the stream as the tokens are read
+    Tokenizer( DIO::InputStream &stream );
+
     //===============================================================
-    bool AddChar( char ch );
+    // anything but an alphanumeric is appended to out_params
+    DataType NextToken( RI::ParamList &out_params );
 
     //===============================================================
-    DataType	GetDataType() const
-    {
-        return mDataType;
-    }
-    
     int GetCurLineNumber() const
     {
         return mLineNumber;
     }
-    
-    //===============================================================
-    void ResetState()
+
+    // line where the last token began
+    int GetTokenLineNumber() const
     {
-        mState = UNKNOWN;
-        mStateInComment = false;
-        mStateCommentStarted = false;
-        mCurToken = "";
-        mArrayType = 0;
-        mIsArrayOfQuotedStrings = false;
-        mIsInArrayItemQuotedString = false;
+        return mTokenLineNumber;
     }
 
-    const char			*GetDataAphaNum()		const { DASSERT( mDataType == DT_ALPHANUMERIC ); return mDataAlphanum.c_str();	}
-    int					GetDataInt()			const { DASSERT( mDataType == DT_INT ); return mDataInt;	}
-    float				GetDataFloat()			const { DASSERT( mDataType == DT_FLOAT ); return mDataFloat;	}
-    const char			*GetDataString()		const { DASSERT( mDataType == DT_STRING ); return mDataString.c_str();	}
-    const DVec<int>		&GetDataIntArray()		const { DASSERT( mDataType == DT_INT_ARRAY ); return mIntArray; }
-    const DVec<float>	&GetDataFloatArray()	const { DASSERT( mDataType == DT_FLOAT_ARRAY ); return mFloatArray; }
-    const DVec<DStr>	&GetDataStringArray()	const { DASSERT( mDataType == DT_STRING_ARRAY ); return mStringArray; }
+    const char	*GetDataAphaNum()		const { return mpAlphanum;		}
+    size_t		GetDataAphaNumLen()		const { return mAlphanumLen;	}
+    RI::CmdID	GetDataAphaNumCmdID()	const { return mAlphanumCmdID;	}
 
 private:
-    void	setDataType();
-    void	changeToFloatArray();
-    bool	inputHandleArray( char ch );
+    //===============================================================
+    struct BinValue
+    {
+        enum Type
+        {
+            INT,
+            FLOAT,
+            STRING,
+            FLOAT_ARRAY,
+            REQUEST,
+        };
+
+        Type		type;
+        int			intVal;
+        float		fltVal;
+        const char	*pStr;		// STRING and REQUEST
+        size_t		n;			// length of the string or of the array
+                                // (the floats are read by readBinaryFloats())
+        RI::CmdID	cmdID;		// REQUEST
+    };
+
+    static bool isBinaryCode( char ch )
+    {
+        return (U8)ch >= 0200;
+    }
+
+    static const size_t	STREAM_WINDOW_SIZE = 1024 * 1024;
+
+    bool		refill( size_t minAvail=1 );
+    void		skipWhiteAndComments();
+    const char	*readWord();
+    void		readString( const char *&out_pStr, size_t &out_len );
+    DataType	readArray( RI::ParamList &out_params );
+    static void	toFltArr( RI::ParamList &out_params, u_int &io_arrType );
+
+    // in Tokenizer_Binary.cpp
+    const U8	*binTake( size_t n );
+    void		skipBinaryDefinitions();
+    void		readBinaryString( const char *&out_pStr, size_t &out_len );
+    void		readBinaryValue( BinValue &out_val );
+    DataType	readBinaryToken( RI::ParamList &out_params );
+
+    void		readBinaryFloats( RI::ParamList &out_params, size_t n );
 };
 
-#endif
\ No newline at end of file
+#endif
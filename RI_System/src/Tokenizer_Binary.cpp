@@ -0,0 +1,320 @@
+//==================================================================
+/// Tokenizer_Binary.cpp
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info.
+//==================================================================
+
+#include "stdafx.h"
+#include <bit>
+#include "Tokenizer.h"
+
+//==================================================================
+/// Binary RIB encoding (RI Spec 3.2, appendix C.2). Codes are octal,
+/// values are big-endian
+///
+/// 0200 + (d<<2) + w	w+1 bytes integer, d of them after the point
+/// 0220 + w			string of w bytes
+/// 0240 + l			string, length in l+1 bytes
+/// 0244				32 bit float
+/// 0245				64 bit float
+/// 0246				encoded request, 1 byte code
+/// 0310 + l			array of 32 bit floats, length in l+1 bytes
+/// 0314				define request, 1 byte code + string
+/// 0315 + w			define string, w+1 bytes code + string
+/// 0317 + w			defined string, w+1 bytes code
+//==================================================================
+
+//===============================================================
+static inline U32 readBE( const U8 *p, size_t n )
+{
+    U32	val = 0;
+
+    for (size_t i=0; i < n; ++i)
+        val = (val << 8) | p[i];
+
+    return val;
+}
+
+//===============================================================
+static inline U32 swapBytes32( U32 v )
+{
+    return	(v >> 24) |
+            ((v >> 8) & 0x0000ff00) |
+            ((v << 8) & 0x00ff0000) |
+            (v << 24);
+}
+
+//===============================================================
+const U8 *Tokenizer::binTake( size_t n )
+{
+    if ( n > (size_t)(mpEnd - mpCur) )
+        refill( n );
+
+    DASSTHROW( n <= (size_t)(mpEnd - mpCur), ("Truncated binary RIB data") );
+
+    const U8	*p = (const U8 *)mpCur;
+    mpCur += n;
+
+    return p;
+}
+
+//===============================================================
+/// Bulk copy, then fix the byte order in place. When streaming, a
+/// piece at a time as the window allows
+void Tokenizer::readBinaryFloats( RI::ParamList &out_params, size_t n )
+{
+    while ( n )
+    {
+        size_t	availN = (size_t)(mpEnd - mpCur) / sizeof(float);
+
+        if NOT( availN )
+        {
+            DASSTHROW( refill( sizeof(float) ), ("Truncated binary RIB data") );
+            continue;
+        }
+
+        size_t	cnt = DMIN( availN, n );
+
+        float	*pDes = out_params.AppendFlts( cnt );
+        memcpy( pDes, mpCur, cnt * sizeof(float) );
+
+        if constexpr ( std::endian::native == std::endian::little )
+        {
+            U32	*pWords = (U32 *)(void *)pDes;
+
+            for (size_t i=0; i < cnt; ++i)
+                pWords[i] = swapBytes32( pWords[i] );
+        }
+
+        mpCur	+= cnt * sizeof(float);
+        n		-= cnt;
+    }
+}
+
+//===============================================================
+/// A string token, as in the definitions. May also be in ASCII
+void Tokenizer::readBinaryString( const char *&out_pStr, size_t &out_len )
+{
+    skipWhiteAndComments();
+
+    DASSTHROW( mpCur < mpEnd, ("Truncated binary RIB data") );
+
+    if ( *mpCur == '"' )
+    {
+        readString( out_pStr, out_len );
+        return;
+    }
+
+    BinValue	val;
+    readBinaryValue( val );
+
+    DASSTHROW( val.type == BinValue::STRING, ("Expecting a string in binary RIB definition") );
+
+    out_pStr	= val.pStr;
+    out_len		= val.n;
+}
+
+//===============================================================
+/// Definitions produce no token, they only fill the tables
+void Tokenizer::skipBinaryDefinitions()
+{
+    while ( mpCur < mpEnd )
+    {
+        U8	code = (U8)*mpCur;
+
+        if ( code == 0314 )
+        {
+            ++mpCur;
+            U8	reqCode = *binTake( 1 );
+
+            const char	*pStr;
+            size_t		len;
+            readBinaryString( pStr, len );
+
+            if NOT( mBinReqNames.size() )
+            {
+                mBinReqNames.resize( 256 );
+                mBinReqCmdIDs.resize( 256 );
+                for (size_t i=0; i < 256; ++i)
+                    mBinReqCmdIDs[i] = RI::CMDID_UNKNOWN;
+            }
+
+            mBinReqNames[ reqCode ].assign( pStr, len );
+            mBinReqCmdIDs[ reqCode ] = RI::FindCommand( pStr, len );
+        }
+        else
+        if ( code == 0315 || code == 0316 )
+        {
+            ++mpCur;
+            size_t		codeLen = code - 0315 + 1;
+            U32			strCode = readBE( binTake( codeLen ), codeLen );
+
+            const char	*pStr;
+            size_t		len;
+            readBinaryString( pStr, len );
+
+            // copy first, the string may come from the table itself
+            DStr	str( pStr, len );
+
+            if ( strCode >= mBinStrings.size() )
+                mBinStrings.resize( strCode + 1 );
+
+            mBinStrings[ strCode ].swap( str );
+        }
+        else
+            return;
+
+        skipWhiteAndComments();
+    }
+}
+
+//===============================================================
+void Tokenizer::readBinaryValue( BinValue &out_val )
+{
+    U8	code = *binTake( 1 );
+
+    // integers and fixed point
+    if ( code <= 0217 )
+    {
+        size_t	n = (code & 3) + 1;
+        size_t	d = (code >> 2) & 3;
+
+        U32	raw = readBE( binTake( n ), n );
+
+        // sign extend
+        int	val = (int)(raw << (32 - n*8)) >> (32 - n*8);
+
+        if ( d == 0 )
+        {
+            out_val.type	= BinValue::INT;
+            out_val.intVal	= val;
+        }
+        else
+        {
+            out_val.type	= BinValue::FLOAT;
+            out_val.fltVal	= (float)val / (float)(1 << (d*8));
+        }
+        return;
+    }
+
+    // strings
+    if ( code <= 0243 )
+    {
+        size_t	len;
+
+        if ( code <= 0237 )
+            len = code - 0220;
+        else
+        {
+            size_t	n = code - 0240 + 1;
+            len = readBE( binTake( n ), n );
+        }
+
+        out_val.type	= BinValue::STRING;
+        out_val.pStr	= (const char *)binTake( len );
+        out_val.n		= len;
+        return;
+    }
+
+    switch ( code )
+    {
+    case 0244:
+        {
+            U32		raw = readBE( binTake( 4 ), 4 );
+            out_val.type	= BinValue::FLOAT;
+            out_val.fltVal	= std::bit_cast<float>( raw );
+        }
+        return;
+
+    case 0245:
+        {
+            const U8	*p = binTake( 8 );
+            U64		raw = ((U64)readBE( p, 4 ) << 32) | readBE( p + 4, 4 );
+            out_val.type	= BinValue::FLOAT;
+            out_val.fltVal	= (float)std::bit_cast<double>( raw );
+        }
+        return;
+
+    case 0246:
+        {
+            U8	reqCode = *binTake( 1 );
+
+            DASSTHROW(
+                mBinReqNames.size() && mBinReqNames[ reqCode ].size(),
+                "Undefined binary RIB request %i", reqCode );
+
+            out_val.type	= BinValue::REQUEST;
+            out_val.pStr	= mBinReqNames[ reqCode ].c_str();
+            out_val.n		= mBinReqNames[ reqCode ].size();
+            out_val.cmdID	= mBinReqCmdIDs[ reqCode ];
+        }
+        return;
+
+    case 0310:
+    case 0311:
+    case 0312:
+    case 0313:
+        {
+            size_t	n = code - 0310 + 1;
+
+            out_val.type	= BinValue::FLOAT_ARRAY;
+            out_val.n		= readBE( binTake( n ), n );
+        }
+        return;
+
+    case 0317:
+    case 0320:
+        {
+            size_t	n = code - 0317 + 1;
+            U32		strCode = readBE( binTake( n ), n );
+
+            DASSTHROW( strCode < mBinStrings.size(), "Undefined binary RIB string %u", strCode );
+
+            out_val.type	= BinValue::STRING;
+            out_val.pStr	= mBinStrings[ strCode ].c_str();
+            out_val.n		= mBinStrings[ strCode ].size();
+        }
+        return;
+
+    default:
+        DASSTHROW( false, "Unsupported binary RIB code 0%o", code );
+    }
+}
+
+//===============================================================
+Tokenizer::DataType Tokenizer::readBinaryToken( RI::ParamList &out_params )
+{
+    BinValue	val;
+    readBinaryValue( val );
+
+    switch ( val.type )
+    {
+    case BinValue::INT:
+        out_params.Add( val.intVal );
+        return DT_INT;
+
+    case BinValue::FLOAT:
+        out_params.Add( val.fltVal );
+        return DT_FLOAT;
+
+    case BinValue::STRING:
+        out_params.AddStr( val.pStr, val.n );
+        return DT_STRING;
+
+    case BinValue::FLOAT_ARRAY:
+        out_params.AddArr( RI::Param::FLT_ARR );
+        readBinaryFloats( out_params, val.n );
+        return DT_FLOAT_ARRAY;
+
+    case BinValue::REQUEST:
+        mpAlphanum		= val.pStr;
+        mAlphanumLen	= val.n;
+        mAlphanumCmdID	= val.cmdID;
+        return DT_ALPHANUMERIC;
+    }
+
+    DASSERT( 0 );
+    return DT_NONE;
+}
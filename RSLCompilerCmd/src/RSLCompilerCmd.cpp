@@ -8,10 +8,18 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <filesystem>
+#include "DSystem/include/DUtils.h"
 #include "DSystem/include/DUtils_Files.h"
+#include "DSystem/include/DThreads.h"
 #include "RibToolsBase/include/RibToolsBase.h"
 #include "RSLCompilerLib/include/RSLCompiler.h"
 #include "RSLCompilerLib/include/RSLC_Prepro.h"
+#include "RI_System/include/RI_RRASM_Parser.h"
+#include "RI_System/include/RI_SVM_ShaderObj.h"
 
 #define APPNAME		"RSLCompilerCmd"
 #define APPVERSION	"0.5"
@@ -22,11 +30,17 @@ struct CmdParams
     const char				*pInFileName;
     const char				*pOutFileName;
     bool					optPrepro;
+    const char				*pBatchName;
+    const char				*pOutDir;
+    size_t					jobsN;
 
     CmdParams() :
         pInFileName		(NULL),
         pOutFileName	(NULL),
-        optPrepro		(false)
+        optPrepro		(false),
+        pBatchName		(NULL),
+        pOutDir			(NULL),
+        jobsN			(0)
     {
     }
 };
@@ -36,12 +50,18 @@ static void printUsage( int argc, char **argv )
 {
     printf( "\n==== " APPNAME " v" APPVERSION " -- (" __DATE__ " - " __TIME__ ") ====\n" );
 
-    printf( "\n%s <Input .sl File> <Output .rrasm File>\n", argv[0] );
+    printf( "\n%s <Input .sl File> <Output .rrobj or .rrasm File>\n", argv[0] );
     printf( "\n%s -prepro <Input .sl File>\n", argv[0] );
+    printf( "\n%s -batch <Directory or List File> [-outdir <Directory>] [-j <N>]\n", argv[0] );
 
     printf( "\nOptions:\n" );
     printf( "    -help | --help | -h     -- Show this help\n" );
     printf( "    -prepro                 -- Apply the C-preprocessor and give to stdout\n" );
+    printf( "    -batch <dir | list>     -- Compile to .rrobj all the .sl files in a directory,\n" );
+    printf( "                               or those listed in a text file (one per line)\n" );
+    printf( "    -outdir <dir>           -- Output directory for -batch (default: next to the sources)\n" );
+    printf( "    -j <N>                  -- Number of shaders compiled in parallel by -batch\n" );
+    printf( "                               (default: number of CPU cores)\n" );
 }
 
 //==================================================================
@@ -54,6 +74,36 @@ static bool getCmdParams( int argc, char **argv, CmdParams &out_cmdPars )
             out_cmdPars.optPrepro = true;
         }
         else
+        if ( 0 == strcasecmp( "-batch", argv[i] ) ||
+             0 == strcasecmp( "-outdir", argv[i] ) ||
+             0 == strcasecmp( "-j", argv[i] ) )
+        {
+            if ( (i+1) >= argc )
+            {
+                printf( "Missing value for %s.\n", argv[i] );
+                return false;
+            }
+
+            if ( 0 == strcasecmp( "-batch", argv[i] ) )
+                out_cmdPars.pBatchName = argv[ i + 1 ];
+            else
+            if ( 0 == strcasecmp( "-outdir", argv[i] ) )
+                out_cmdPars.pOutDir = argv[ i + 1 ];
+            else
+            {
+                int	jobsN = atoi( argv[ i + 1 ] );
+                if ( jobsN <= 0 )
+                {
+                    printf( "Invalid value for %s.\n", argv[i] );
+                    return false;
+                }
+
+                out_cmdPars.jobsN = (size_t)jobsN;
+            }
+
+            ++i;
+        }
+        else
         if (0 == strcasecmp( "-help", argv[i] ) ||
             0 == strcasecmp( "--help", argv[i] ) ||
             0 == strcasecmp( "-h", argv[i] ) )
@@ -79,6 +129,9 @@ static bool getCmdParams( int argc, char **argv, CmdParams &out_cmdPars )
         }
     }
 
+    if ( out_cmdPars.pBatchName )
+        return out_cmdPars.pInFileName == NULL && !out_cmdPars.optPrepro;
+
     if ( out_cmdPars.pInFileName == NULL ||
          (out_cmdPars.pOutFileName == NULL && !out_cmdPars.optPrepro) )
         return false;
@@ -129,6 +182,233 @@ static void handlePreproOnly( const char *pSLFName, const char *pBuiltinPathFNam
     }
 }
 
+//==================================================================
+static void saveShaderObj( RSLCompiler &compiler, const char *pSLFName, const char *pObjFName )
+{
+    DVec<U8>	asmData;
+    compiler.GetASM( asmData, pSLFName );
+
+    DUT::MemFile	asmFile;
+    asmFile.InitExclusiveOwenership( asmData );
+
+    // shader name is the file name without path and extension
+    DStr	shaderName( pSLFName );
+
+    size_t	slashPos = shaderName.find_last_of( "/\\" );
+    if ( slashPos != DStr::npos )
+        shaderName = shaderName.substr( slashPos + 1 );
+
+    size_t	dotPos = shaderName.find_last_of( '.' );
+    if ( dotPos != DStr::npos )
+        shaderName.resize( dotPos );
+
+    // parse the rrasm in memory as the renderer would, then
+    // save the resulting shader in the binary form
+    RI::SVM::Shader		shader( shaderName.c_str() );
+    RI::RRASM::Parser	parser( asmFile, &shader, shaderName.c_str() );
+
+    RI::SVM::SaveShaderObj(
+                shader,
+                pObjFName,
+                RI::SVM::MakeShaderObjKey( compiler.CalcSourceHash() ) );
+}
+
+//==================================================================
+static void compileFile(
+                const char *pSLFName,
+                const char *pOutFName,
+                const char *pBuiltinPathFName,
+                bool dbgOutputTree )
+{
+    DVec<U8>	inData;
+    if NOT( DUT::GrabFile( pSLFName, inData ) )
+        DEX_RUNTIME_ERROR( "Failed opening %s", pSLFName );
+
+    DIO::FileManagerDisk	fmanager;
+
+    RSLCompiler::Params	params;
+    params.mDbgOutputTree = dbgOutputTree;
+    params.mpFileManager = &fmanager;
+
+    RSLCompiler	compiler(
+                    pSLFName,
+                    (const char *)&inData[0],
+                    inData.size(),
+                    pBuiltinPathFName,
+                    params );
+
+    if ( 0 == strcasecmp( DUT::GetFileNameExt( pOutFName ), "rrobj" ) )
+        saveShaderObj( compiler, pSLFName, pOutFName );
+    else
+        compiler.SaveASM( pOutFName, pSLFName );
+}
+
+//==================================================================
+/// Batch compilation
+//==================================================================
+static bool collectBatchFiles(
+                const char *pBatchName,
+                const char *pBuiltinPathFName,
+                DVec<DStr> &out_files )
+{
+    namespace fs = std::filesystem;
+
+    std::error_code	ec;
+    if ( fs::is_directory( pBatchName, ec ) )
+    {
+        // the builtins file is also a .sl, but not a shader
+        DStr	builtinName = fs::path( pBuiltinPathFName ).filename().string();
+
+        for (const auto &entry : fs::directory_iterator( pBatchName, ec ))
+        {
+            if ( entry.is_regular_file( ec ) &&
+                 entry.path().filename().string() != builtinName &&
+                 0 == strcasecmp( DUT::GetFileNameExt( entry.path().string().c_str() ), "sl" ) )
+            {
+                out_files.push_back( entry.path().string() );
+            }
+        }
+
+        // directory order is arbitrary
+        std::sort( out_files.begin(), out_files.end() );
+
+        return true;
+    }
+
+    FILE	*pFile = fopen( pBatchName, "rt" );
+    if NOT( pFile )
+        return false;
+
+    // list files: one shader per line, paths relative to the list file
+    DStr	baseDir = DUT::GetDirNameFromFPathName( pBatchName );
+
+    char	lineBuff[4096];
+    while ( fgets( lineBuff, sizeof(lineBuff), pFile ) )
+    {
+        DStr	line( lineBuff );
+
+        size_t	beg = line.find_first_not_of( " \t\r\n" );
+        if ( beg == DStr::npos || line[beg] == '#' )
+            continue;
+
+        size_t	end = line.find_last_not_of( " \t\r\n" );
+        line = line.substr( beg, end - beg + 1 );
+
+        if ( baseDir.length() && fs::path( line ).is_relative() )
+            line = baseDir + "/" + line;
+
+        out_files.push_back( line );
+    }
+
+    fclose( pFile );
+
+    return true;
+}
+
+//==================================================================
+static DStr makeBatchOutFName( const DStr &slFName, const char *pOutDir )
+{
+    DStr	outFName = slFName;
+
+    size_t	dotPos = outFName.find_last_of( '.' );
+    size_t	slashPos = outFName.find_last_of( "/\\" );
+    if ( dotPos != DStr::npos && (slashPos == DStr::npos || dotPos > slashPos) )
+        outFName.resize( dotPos );
+
+    outFName += ".rrobj";
+
+    if ( pOutDir )
+    {
+        if ( slashPos != DStr::npos )
+            outFName = outFName.substr( slashPos + 1 );
+
+        outFName = DStr( pOutDir ) + "/" + outFName;
+    }
+
+    return outFName;
+}
+
+//==================================================================
+static int handleBatch( const CmdParams &cmdPars, const char *pBuiltinPathFName )
+{
+    DVec<DStr>	files;
+    if NOT( collectBatchFiles( cmdPars.pBatchName, pBuiltinPathFName, files ) )
+    {
+        printf( "ERROR: Failed opening %s\n", cmdPars.pBatchName );
+        return -1;
+    }
+
+    if ( cmdPars.pOutDir )
+    {
+        std::error_code	ec;
+        std::filesystem::create_directories( cmdPars.pOutDir, ec );
+    }
+
+    size_t	jobsN = cmdPars.jobsN;
+    if ( jobsN == 0 )
+        jobsN = std::max( 1u, std::thread::hardware_concurrency() );
+
+    jobsN = std::min( jobsN, std::max( files.size(), (size_t)1 ) );
+
+    printf( "Compiling %u shaders with %u jobs...\n", (u_int)files.size(), (u_int)jobsN );
+
+    std::atomic<size_t>	nextIdx( 0 );
+    std::atomic<size_t>	failedN( 0 );
+    std::mutex			outMutex;
+
+    I64	startTicks = DUT::GetTimeTicks();
+
+    // every worker keeps pulling the next file, until there are none left
+    auto worker = [&]()
+    {
+        for (size_t i; (i = nextIdx++) < files.size();)
+        {
+            const DStr	&slFName = files[i];
+            DStr		outFName = makeBatchOutFName( slFName, cmdPars.pOutDir );
+            DStr		errMsg;
+
+            I64	t0 = DUT::GetTimeTicks();
+
+            try {
+                compileFile( slFName.c_str(), outFName.c_str(), pBuiltinPathFName, false );
+            }
+            catch ( RSLC::Exception &e ) {	errMsg = e.GetMessage();	}
+            catch ( const std::exception &e ) {	errMsg = e.what();	}
+            catch ( ... ) {					errMsg = "Unknown error";	}
+
+            double	ms = DUT::TimeTicksToMS( DUT::GetTimeTicks() - t0 );
+
+            std::lock_guard<std::mutex>	lock( outMutex );
+
+            if ( errMsg.length() )
+            {
+                failedN += 1;
+                printf( "FAILED %8.2lf ms  %s\n%s\n", ms, slFName.c_str(), errMsg.c_str() );
+            }
+            else
+                printf( "OK     %8.2lf ms  %s -> %s\n", ms, slFName.c_str(), outFName.c_str() );
+
+            fflush( stdout );
+        }
+    };
+
+    {
+        DTH::ParallelTasks	tasks( jobsN );
+
+        for (size_t i=0; i < jobsN; ++i)
+            tasks.AddTask( worker );
+    }
+
+    double	totMS = DUT::TimeTicksToMS( DUT::GetTimeTicks() - startTicks );
+
+    printf( "Done ! %u compiled, %u failed, %.2lf ms total\n",
+                (u_int)(files.size() - failedN),
+                (u_int)failedN.load(),
+                totMS );
+
+    return failedN ? -1 : 0;
+}
+
 //==================================================================
 int main( int argc, char *argv[] )
 {
@@ -166,41 +446,27 @@ int main( int argc, char *argv[] )
         return 0;
     }
 
+    if ( params.pBatchName )
+        return handleBatch( params, builtinPathFName );
+
     const char	*pSLFName = params.pInFileName;
     const char	*pRRFName = params.pOutFileName;
 
-    printf( "Opening %s in input...\n", pSLFName );
-
-    DVec<U8>	inData;
-    if NOT( DUT::GrabFile( pSLFName, inData ) )
-    {
-        printf( "ERROR: Failed opening %s\n", pSLFName );
-        return -1;
-    }
+    printf( "Compiling %s into %s...\n", pSLFName, pRRFName );
 
     try
     {
-        DIO::FileManagerDisk	fmanager;
-
-        RSLCompiler::Params	params;
-        params.mDbgOutputTree = true;
-        params.mpFileManager = &fmanager;
-
-        RSLCompiler	compiler(
-                        pSLFName,
-                        (const char *)&inData[0],
-                        inData.size(),
-                        builtinPathFName,
-                        params );
-
-        printf( "Generating %s...\n", pRRFName );
-
-        compiler.SaveASM( pRRFName, pSLFName );
+        compileFile( pSLFName, pRRFName, builtinPathFName, true );
     }
     catch ( RSLC::Exception &e )
     {
         printf( "%s\n", e.GetMessage().c_str() );
     }
+    catch ( const std::exception &e )
+    {
+        printf( "ERROR: %s\n", e.what() );
+        return -1;
+    }
     catch ( ... )
     {
         printf( "ERROR while compiling !\n" );
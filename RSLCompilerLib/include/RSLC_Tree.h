@@ -9,6 +9,7 @@
 #ifndef RSLC_TREE_H
 #define RSLC_TREE_H
 
+#include <atomic>
 #include "DSystem/include/DContainers.h"
 #include "RSLC_Token.h"
 #include "RSLC_Variables.h"
@@ -39,7 +40,7 @@ public:
 class TokNode
 {
 #ifdef _DEBUG
-    static size_t	sUIDCnt;
+    static std::atomic<size_t>	sUIDCnt;
 
     size_t			mUIDCnt;
 #endif
@@ -12,6 +12,7 @@
 #include "RSLC_Exceptions.h"
 #include "RSLC_Token.h"
 #include "RSLC_Tree.h"
+#include "RSLC_FatChars.h"
 #include "DSystem/include/DIO_FileManager.h"
 
 //==================================================================
@@ -19,8 +20,11 @@
 //==================================================================
 class RSLCompiler
 {
+    RSLC::FatBase		mFatBase;
+    DVec<RSLC::Fat8>	mProcessedSource;
     DVec<RSLC::Token>	mTokens;
     RSLC::TokNode		*mpRoot;
+    bool				mDbgOutputTree;
 
     static const char	*mpsVersionString;
 
@@ -29,10 +33,12 @@ public:
     {
     public:
         bool					mDbgOutputTree;
+        bool					mPreproOnly;	// Compile() to be called later
         DIO::FileManagerBase	*mpFileManager;
 
         Params() :
             mDbgOutputTree(false),
+            mPreproOnly(false),
             mpFileManager(NULL)
         {
         }
@@ -47,7 +53,15 @@ public:
 
     ~RSLCompiler();
 
+    U64 CalcSourceHash() const;
+
+    void Compile();
+
     void SaveASM( const char *pFName, const char *pRefSourceName );
+    void GetASM( DVec<U8> &out_data, const char *pRefSourceName );
+
+private:
+    void writeASM( FILE *pFile, const char *pFName, const char *pRefSourceName );
 };
 
 #endif
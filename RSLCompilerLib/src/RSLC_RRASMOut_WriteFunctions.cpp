@@ -129,11 +129,8 @@ static const char *asmOpCodeFromOpToken( const Token *pTok )
 //==================================================================
 static DStr resolveIntrinsics( const char *pIntrName )
 {
-    static size_t		sBaseLen;
-    static const char	*spBaseStr = "_asm_";
-
-    if ( sBaseLen == 0 )
-        sBaseLen = strlen( "_asm_" );
+    static const char	spBaseStr[] = "_asm_";
+    static const size_t	sBaseLen = sizeof(spBaseStr) - 1;
 
     if ( pIntrName == strstr( pIntrName, spBaseStr ) )
     {
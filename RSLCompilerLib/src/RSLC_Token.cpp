@@ -133,9 +133,6 @@ void Token::UpdateStrFromValue()
     }
 }
 
-//==================================================================
-static size_t _sTokenDefsIdxInvSortLen[TOKEN_N];
-
 //==================================================================
 static bool findSkipWhites( const Fat8Vec &str, size_t &i )
 {
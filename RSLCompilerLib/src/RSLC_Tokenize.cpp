@@ -47,28 +47,37 @@ static int tokNamesCmpFunc( const void *a, const void *b )
 }
 
 //==================================================================
-static size_t _sTokenDefsIdxInvSortLen[TOKEN_N];
-
+/// Token definitions indices, sorted by decreasing string length,
+/// so that the longest match is always found first.
+/// Built once (thread-safe static init), shared by all compilers.
 //==================================================================
-static void initSortedTable()
+struct SortedTokenDefs
 {
-    if ( _sTokenDefsIdxInvSortLen[0] != 0 )
-        return;
-
-    SortItem	sortItems[ TOKEN_N ];
+    size_t	mIdx[TOKEN_N];
 
-    for (size_t i=0; i < TOKEN_N; ++i)
+    SortedTokenDefs()
     {
-        sortItems[i].strLen = _TokenDefs[i].pStr ? strlen( _TokenDefs[i].pStr ) : 0;
-        sortItems[i].idx	= i;
-    }
+        SortItem	sortItems[ TOKEN_N ];
 
-    qsort( sortItems, TOKEN_N, sizeof(SortItem), tokNamesCmpFunc );
+        for (size_t i=0; i < TOKEN_N; ++i)
+        {
+            sortItems[i].strLen = _TokenDefs[i].pStr ? strlen( _TokenDefs[i].pStr ) : 0;
+            sortItems[i].idx	= i;
+        }
 
-    for (size_t i=0; i < TOKEN_N; ++i)
-    {
-        _sTokenDefsIdxInvSortLen[i] = sortItems[i].idx;
+        qsort( sortItems, TOKEN_N, sizeof(SortItem), tokNamesCmpFunc );
+
+        for (size_t i=0; i < TOKEN_N; ++i)
+            mIdx[i] = sortItems[i].idx;
     }
+};
+
+//==================================================================
+static const size_t *getTokenDefsIdxInvSortLen()
+{
+    static const SortedTokenDefs	sSorted;
+
+    return sSorted.mIdx;
 }
 
 //==================================================================
@@ -79,8 +88,6 @@ Tokenize::Tokenize( const Fat8Vec &str, DVec<Token> &tokens, FatBase &fatBase )
     mTokens(tokens),
     mFatBase(fatBase)
 {
-    // do it here.. static stuff ! ..non MT-safe 8)
-    initSortedTable();
 }
 
 //==================================================================
@@ -97,9 +104,11 @@ void Tokenize::newToken( const Fat8 &fatCh )
 //==================================================================
 bool Tokenize::matchTokenDef( size_t &i, bool wasPrecededByWS )
 {
+    const size_t	*pSortedIdx = getTokenDefsIdxInvSortLen();
+
     for (size_t j=0; j < TOKEN_N; ++j)
     {
-        const TokenDef &tokDef = _TokenDefs[ _sTokenDefsIdxInvSortLen[ j ] ];
+        const TokenDef &tokDef = _TokenDefs[ pSortedIdx[ j ] ];
 
         if NOT( tokDef.pStr )
             continue;
@@ -16,7 +16,7 @@ namespace RSLC
 
 //==================================================================
 #ifdef _DEBUG
-size_t	TokNode::sUIDCnt;
+std::atomic<size_t>	TokNode::sUIDCnt;
 #endif
 
 //==================================================================
@@ -36,25 +36,50 @@ RSLCompiler::RSLCompiler(
         const char *pSource,
         size_t sourceSize,
         const char *pBaseInclude,
-        const Params &params )
+        const Params &params ) :
+    mpRoot(NULL),
+    mDbgOutputTree(params.mDbgOutputTree)
 {
-    FatBase		fatBase;
     DVec<Fat8>	source;
-    fatBase.AppendNewFile( source, pSLFName, (const U8 *)pSource, sourceSize );
-    DVec<Fat8>	processedSource;
+    mFatBase.AppendNewFile( source, pSLFName, (const U8 *)pSource, sourceSize );
 
     DStr	curShaderDir = DUT::GetDirNameFromFPathName( pSLFName );
 
     PREPRO::Prepro
                 prepro(
                     *params.mpFileManager,
-                    fatBase,
+                    mFatBase,
                     source,
                     pBaseInclude,
                     curShaderDir.c_str(),
-                    processedSource );
+                    mProcessedSource );
 
-    Tokenizer( mTokens, fatBase, processedSource );
+    if NOT( params.mPreproOnly )
+        Compile();
+}
+
+//==================================================================
+/// Hash of what actually gets compiled (the builtins and any included
+/// file are part of the preprocessed source) and of the compiler version
+U64 RSLCompiler::CalcSourceHash() const
+{
+    U64	hash = 14695981039346656037ULL;
+
+    for (size_t i=0; i < mProcessedSource.size(); ++i)
+        hash = (hash ^ mProcessedSource[i].Ch) * 1099511628211ULL;
+
+    for (const char *pCh = mpsVersionString; *pCh; ++pCh)
+        hash = (hash ^ (U8)*pCh) * 1099511628211ULL;
+
+    return hash;
+}
+
+//==================================================================
+void RSLCompiler::Compile()
+{
+    DASSERT( mpRoot == NULL );
+
+    Tokenizer( mTokens, mFatBase, mProcessedSource );
 
 #if 0	// useful to debug the tokenizer
     for (size_t i=0; i < mTokens.size(); ++i)
@@ -117,7 +142,7 @@ RSLCompiler::RSLCompiler(
     CloseFuncOps( mpRoot );
 
     // produce some debug info in the output file
-    if ( params.mDbgOutputTree )
+    if ( mDbgOutputTree )
         TraverseTree( mpRoot, 0 );
 }
 
@@ -128,17 +153,8 @@ RSLCompiler::~RSLCompiler()
 }
 
 //==================================================================
-void RSLCompiler::SaveASM( const char *pFName, const char *pRefSourceName )
+void RSLCompiler::writeASM( FILE *pFile, const char *pFName, const char *pRefSourceName )
 {
-    // return;
-
-    FILE	*pFile;
-
-    if ( fopen_s( &pFile, pFName, "wb" ) )
-    {
-        DASSTHROW( 0, ("Failed to save %s", pFName) );
-    }
-
     char dateStr[256];
     char timeStr[256];
     numstrdate( dateStr);
@@ -158,6 +174,50 @@ void RSLCompiler::SaveASM( const char *pFName, const char *pRefSourceName )
     fprintf_s( pFile, "\n.code\n" );
 
     RRASMOut::WriteFunctions( pFile, mpRoot );
+}
+
+//==================================================================
+void RSLCompiler::SaveASM( const char *pFName, const char *pRefSourceName )
+{
+    // return;
+
+    FILE	*pFile;
+
+    if ( fopen_s( &pFile, pFName, "wb" ) )
+    {
+        DASSTHROW( 0, ("Failed to save %s", pFName) );
+    }
+
+    writeASM( pFile, pFName, pRefSourceName );
+
+    fclose( pFile );
+}
+
+//==================================================================
+void RSLCompiler::GetASM( DVec<U8> &out_data, const char *pRefSourceName )
+{
+    // the RRASM writers work on a FILE, so go through an anonymous
+    // temporary file rather than touching the disk with a named one
+    FILE	*pFile = tmpfile();
+
+    if NOT( pFile )
+    {
+        DASSTHROW( 0, ("Failed to create a temporary file for %s", pRefSourceName) );
+    }
+
+    writeASM( pFile, "<memory>", pRefSourceName );
+
+    long	size = ftell( pFile );
+    rewind( pFile );
+
+    out_data.resize( size > 0 ? (size_t)size : 0 );
+
+    if ( out_data.size() &&
+         out_data.size() != fread( &out_data[0], 1, out_data.size(), pFile ) )
+    {
+        fclose( pFile );
+        DASSTHROW( 0, ("Failed to read back the ASM for %s", pRefSourceName) );
+    }
 
     fclose( pFile );
 }
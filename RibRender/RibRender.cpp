@@ -22,6 +22,7 @@ static void printUsage( int argc, char **argv )
     printf( "    -server <address>:<port>        -- Specify an IP and port number for a render server\n" );
     printf( "    -forcedlongdim <size in pixels> -- Force the largest dimension's rendering size in pixels\n" );
     printf( "    -colorgrids                     -- Show grids in false colors (for debugging)\n" );
+    printf( "    -shadercache <dir>              -- Directory for the compiled shaders (can be shared)\n" );
 
     printf( "\nExamples:\n" );
     printf( "    %s TestScenes/Airplane.rib\n", argv[0] );
@@ -77,6 +78,17 @@ static bool getCmdParams( int argc, char **argv, CmdParams &out_cmdPars )
         {
             out_cmdPars.doColorGrids = true;
         }
+        else
+        if ( 0 == strcasecmp( "-shadercache", argv[i] ) )
+        {
+            if ( (i+1) >= argc )
+            {
+                printf( "Missing value for %s.\n", argv[i] );
+                return false;
+            }
+
+            out_cmdPars.shaderCacheDir = argv[ ++i ];
+        }
     }
 
     return true;
@@ -102,6 +114,8 @@ static void handleDisplays( void *pUserData, const RRL::DisplayList &pDisplays )
         {
             DispDriverFile	file( disp.mName.c_str(), disp.mImage );
         }
+
+        // zfile displays are written by the library
     }
 }
 
@@ -156,6 +170,7 @@ static int clientMain( int argc, char **argv )
     params.mTrans.mState.mpFileManager		= &fileManagerDisk;
     params.mTrans.mState.mBaseDir			= cmdPars.baseDir;
     params.mTrans.mState.mDefaultShadersDir	= defaultShadersDir;
+    params.mTrans.mState.mShaderCacheDir	= cmdPars.shaderCacheDir;
     params.mTrans.mForcedLongDim			= cmdPars.forcedlongdim;
     params.mpFileName						= cmdPars.pInFileName;
     params.mpOnFrameEndCB					= handleDisplays;
@@ -35,6 +35,7 @@ struct CmdParams
     bool					doColorGrids;
 
     DStr					baseDir;
+    DStr					shaderCacheDir;
 
     CmdParams() :
         pInFileName		(NULL),
@@ -0,0 +1,84 @@
+//==================================================================
+/// RRL_ArchiveCache.h
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info.
+//==================================================================
+
+#ifndef RRL_ARCHIVECACHE_H
+#define RRL_ARCHIVECACHE_H
+
+#include <list>
+#include <memory>
+#include "DSystem/include/DContainers.h"
+#include "RRL_CmdBuffer.h"
+
+//==================================================================
+namespace RRL
+{
+
+//==================================================================
+/// ArchiveCache
+/// Parsed archives, by their resolved path. An entry is good for as
+/// long as the file keeps the same size and modification time.
+/// The least recently used entries go first when over the memory
+/// budget. Used by one thread at a time
+//==================================================================
+class ArchiveCache
+{
+public:
+    typedef std::shared_ptr<CmdBuffer>	BuffPtr;
+
+    struct Stats
+    {
+        size_t	mHitsN		= 0;
+        size_t	mMissesN	= 0;
+        size_t	mEvictedN	= 0;
+    };
+
+    static const size_t	DEF_MAX_MEM_SIZE = (size_t)512 * 1024 * 1024;
+
+private:
+    struct Entry
+    {
+        DStr	mPathFName;
+        U64		mFileSize;
+        U64		mFileTime;
+        size_t	mMemSize;
+        BuffPtr	moBuff;
+    };
+
+    typedef std::list<Entry>	EntryList;
+
+    EntryList									mEntries;	// most recently used first
+    std::unordered_map<DStr,EntryList::iterator>	mEntriesMap;
+
+    size_t	mMemSize;
+    size_t	mMaxMemSize;
+    Stats	mStats;
+
+public:
+    ArchiveCache( size_t maxMemSize=DEF_MAX_MEM_SIZE );
+
+    BuffPtr Find( DIO::FileManagerBase &fileManager, const char *pPathFName );
+
+    void Add( DIO::FileManagerBase &fileManager, const char *pPathFName, const BuffPtr &oBuff );
+
+    void Clear();
+
+    size_t GetEntriesN() const	{	return mEntries.size();	}
+    size_t GetMemSize() const	{	return mMemSize;		}
+    size_t GetMaxMemSize() const{	return mMaxMemSize;		}
+
+    const Stats &GetStats() const	{	return mStats;		}
+    void ResetStats()				{	mStats = Stats();	}
+
+private:
+    void removeEntry( EntryList::iterator it );
+};
+
+//==================================================================
+}
+
+#endif
@@ -0,0 +1,82 @@
+//==================================================================
+/// RRL_CmdBuffer.h
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info.
+//==================================================================
+
+#ifndef RRL_CMDBUFFER_H
+#define RRL_CMDBUFFER_H
+
+#include <exception>
+#include "DSystem/include/DContainers.h"
+#include "DSystem/include/DIO_FileManager.h"
+#include "DSystem/include/DIO_InflateStream.h"
+#include "RI_System/include/RI_Parser.h"
+
+//==================================================================
+namespace RRL
+{
+
+//==================================================================
+/// ArchiveParser
+/// A parser over a RIB file, inflated in the background when
+/// the file is compressed
+//==================================================================
+class ArchiveParser
+{
+    DUT::MemFile		mFile;
+    DIO::InflateStream	*mpStream;
+    RI::Parser			*mpParser;
+
+public:
+    ArchiveParser( DIO::FileManagerBase &fileManager, const char *pFileName );
+    ~ArchiveParser();
+
+    RI::Parser &GetParser()	{	return *mpParser;	}
+};
+
+//==================================================================
+/// CmdBuffer
+/// Commands parsed ahead of time, to be replayed into the
+/// translator later, possibly from another thread
+//==================================================================
+class CmdBuffer
+{
+public:
+    struct Cmd
+    {
+        RI::CmdID		mCmdID;
+        int				mLine;
+        int				mUnknownNameIdx;	// in mUnknownNames, or -1
+        RI::ParamList	mParams;
+    };
+
+    DVec<Cmd>			mCmds;
+    DVec<DStr>			mUnknownNames;
+    std::exception_ptr	mpError;	// where parsing failed, after the last command
+
+    // only primitives, in blocks. Can be kept as an object, see ParseFile()
+    bool				mIsOnlyGeometry = false;
+
+public:
+    // false at the end of the data, or at an error
+    bool Parse( RI::Parser &parser, size_t maxCmdsN=(size_t)-1 );
+
+    // the whole file. Errors, also in opening it, go in mpError
+    void ParseFile( DIO::FileManagerBase &fileManager, const char *pFileName );
+
+    const char *GetCommandName( const Cmd &cmd ) const;
+
+    // first command that changes the options, the declarations or the
+    // lights, or NULL. Not for the delayed archives, read while rendering
+    const Cmd *FindGlobalChange() const;
+
+    size_t GetMemSize() const;
+};
+
+//==================================================================
+}
+
+#endif
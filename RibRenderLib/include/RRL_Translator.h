@@ -9,9 +9,11 @@
 #ifndef RRL_TRANSLATOR_H
 #define RRL_TRANSLATOR_H
 
+#include <map>
 #include "DSystem/include/DContainers.h"
 #include "RI_System/include/RI_Base.h"
 #include "RI_System/include/RI_State.h"
+#include "RI_System/include/RI_Commands.h"
 
 //==================================================================
 namespace RRL
@@ -43,6 +45,8 @@ private:
     Params		mParams;
     DStr		mReadArchivePathFName;
 
+    std::map<DStr,RI::ObjectHandle>	mObjectHandles;	// RIB object ids
+
 public:
     Translator( const Params &params );
 
@@ -54,7 +58,7 @@ public:
     };
 
     RetCmd AddCommand(
-                const DStr		&cmdName,
+                RI::CmdID		cmdID,
                 RI::ParamList	&cmdParams,
                 const char		*pFileName,
                 int				cmdLine );
@@ -64,25 +68,30 @@ public:
         printf( "Error %s !!\n", ErrorToString( errCode ) );
     }
 
+    void UnknownCommand( const char *pCmdName );
+
     RI::State &GetState()	{	return mState;	}
 
     const char *GetReadArchivePathFName() const { return mReadArchivePathFName.c_str(); }
 
 private:
-    void unknownCommand( const char *pCmdName );
     void exN( size_t n, const RI::ParamList &cmdParams );
     void geN( size_t n, const RI::ParamList &cmdParams );
 
     void addFormatCmd( RI::ParamList &p );
 
+    static DStr objectName( const RI::Param &param );
+    void addObjectInstanceCmd( const RI::Param &param );
+    void addProceduralCmd( RI::ParamList &p );
+
     bool addCommand_prims(
-        const DStr		&nm,
+        RI::CmdID		cmdID,
         RI::ParamList	&p,
         const char		*pFileName,
         int				cmdLine );
 
-    bool addCommand_options( const DStr &nm, RI::ParamList &p );
-    bool addCommand_transforms( const DStr &nm, RI::ParamList &p );
+    bool addCommand_options( RI::CmdID cmdID, RI::ParamList &p );
+    bool addCommand_transforms( RI::CmdID cmdID, RI::ParamList &p );
 
     static RtToken matchToken( const char *pStr, RtToken pAllowedTokens[] );
 };
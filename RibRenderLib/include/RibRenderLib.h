@@ -11,6 +11,7 @@
 
 #include "DSystem/include/DTypes.h"
 #include "DSystem/include/DNetwork.h"
+#include "DSystem/include/DThreads.h"
 
 #include "RI_System/include/RI_Render.h"
 #include "RI_System/include/RI_Net_Protocol.h"
@@ -19,6 +20,8 @@
 #include "RI_System/include/RI_Exceptions.h"
 
 #include "RRL_Translator.h"
+#include "RRL_CmdBuffer.h"
+#include "RRL_ArchiveCache.h"
 #include "RRL_Net.h"
 
 #include "DispDrivers/include/DispDriverFile.h"
@@ -28,12 +31,12 @@
 namespace RRL
 {
 
-typedef DVec<RI::Options::Display *>	DisplayList;
+typedef DVec<RI::Options::DisplayPtr>	DisplayList;
 
 //==================================================================
 /// Render
 //==================================================================
-class Render
+class Render : public RI::DelayedArchiveLoaderBase
 {
 public:
     typedef void (*OnFrameEndCBType)( void *pCBData, const DisplayList &pDisplays );
@@ -46,24 +49,92 @@ public:
         Translator::Params	mTrans;
         OnFrameEndCBType	mpOnFrameEndCB;
         void				*mpOnFrameEndCBData;
+        ArchiveCache		*mpArchiveCache;	// to share across renders, optional
 
         Params() :
             mpFileName(NULL),
             mVerbose(false),
             mpOnFrameEndCB(NULL),
-            mpOnFrameEndCBData(NULL)
+            mpOnFrameEndCBData(NULL),
+            mpArchiveCache(NULL)
         {
         }
     };
 
+private:
+    typedef ArchiveCache::BuffPtr	BuffPtr;
+
+    // an archive found in the cache or being parsed in the background
+    struct Prefetch
+    {
+        size_t						mCmdIdx;	// of the ReadArchive in the parent
+        DStr						mPathFName;
+        std::shared_future<BuffPtr>	mFuture;
+        bool						mIsCached;	// found in the cache, not parsed
+    };
+
+    DTH::TaskQueue	mParseTasks;
+    size_t			mPrefetchMaxN;
+    ArchiveCache	mOwnArchiveCache;
+    ArchiveCache	*mpArchiveCache;
+
+    // for the delayed archives, read while rendering
+    const Params	*mpParams;
+    Translator		*mpTranslator;
+
+    // archives of only geometry, kept as objects from the second
+    // world block that reads them
+    struct RetainedArchive
+    {
+        BuffPtr				moBuff;
+        size_t				mFirstWorldIdx;
+        RI::ObjectHandle	mObjectHandle;	// NULL until kept
+    };
+
+    std::unordered_map<DStr,RetainedArchive>	mRetained;	// by path
+    size_t										mWorldIdx;
+    size_t										mRetainedHitsN;
+
 public:
     Render( Params &params );
 
+    void LoadDelayedArchive(
+                const char				*pPathFName,
+                const RI::Attributes	&attr,
+                const RI::Transform		&xform );
+
 private:
     void readArchive(
             const char *pFileName,
             const Params &params,
             Translator &translator );
+
+    BuffPtr getArchive(
+            const char *pPathFName,
+            std::deque<Prefetch> &io_prefetches,
+            size_t cmdIdx,
+            const Params &params );
+
+    void replayCmds(
+            CmdBuffer &buff,
+            const char *pFileName,
+            const Params &params,
+            Translator &translator );
+
+    bool instanceRetained(
+            const char *pPathFName,
+            const BuffPtr &oBuff,
+            const Params &params,
+            Translator &translator );
+
+    void prefetchArchives(
+            const CmdBuffer &buff,
+            size_t &io_scanIdx,
+            std::deque<Prefetch> &io_prefetches,
+            const Params &params,
+            Translator &translator );
+
+    void printCacheStats();
 };
 
 //==================================================================
@@ -0,0 +1,129 @@
+//==================================================================
+/// RRL_ArchiveCache.cpp
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info.
+//==================================================================
+
+#include "stdafx.h"
+#include "RRL_ArchiveCache.h"
+
+//==================================================================
+namespace RRL
+{
+
+//==================================================================
+ArchiveCache::ArchiveCache( size_t maxMemSize ) :
+    mMemSize(0),
+    mMaxMemSize(maxMemSize)
+{
+}
+
+//==================================================================
+ArchiveCache::BuffPtr ArchiveCache::Find(
+                            DIO::FileManagerBase &fileManager,
+                            const char *pPathFName )
+{
+    auto itMap = mEntriesMap.find( pPathFName );
+
+    if ( itMap == mEntriesMap.end() )
+    {
+        mStats.mMissesN += 1;
+        return BuffPtr();
+    }
+
+    EntryList::iterator	it = itMap->second;
+
+    U64	fileSize;
+    U64	fileTime;
+
+    // changed or gone since it was parsed
+    if NOT( fileManager.GetFileStamp( pPathFName, fileSize, fileTime ) &&
+            fileSize == it->mFileSize &&
+            fileTime == it->mFileTime )
+    {
+        removeEntry( it );
+        mStats.mMissesN += 1;
+        return BuffPtr();
+    }
+
+    // move to the front, as the most recently used
+    mEntries.splice( mEntries.begin(), mEntries, it );
+
+    mStats.mHitsN += 1;
+
+    return it->moBuff;
+}
+
+//==================================================================
+void ArchiveCache::Add(
+                    DIO::FileManagerBase &fileManager,
+                    const char *pPathFName,
+                    const BuffPtr &oBuff )
+{
+    U64	fileSize;
+    U64	fileTime;
+
+    // can't tell when it changes, so it's not kept
+    if NOT( fileManager.GetFileStamp( pPathFName, fileSize, fileTime ) )
+        return;
+
+    auto itMap = mEntriesMap.find( pPathFName );
+    if ( itMap != mEntriesMap.end() )
+    {
+        // shared by more references parsed together, used again
+        if ( itMap->second->moBuff == oBuff )
+        {
+            mEntries.splice( mEntries.begin(), mEntries, itMap->second );
+            mStats.mHitsN += 1;
+            return;
+        }
+
+        removeEntry( itMap->second );
+    }
+
+    size_t	memSize = oBuff->GetMemSize();
+
+    if ( memSize > mMaxMemSize )
+        return;
+
+    while ( mEntries.size() && (mMemSize + memSize) > mMaxMemSize )
+    {
+        removeEntry( std::prev( mEntries.end() ) );
+        mStats.mEvictedN += 1;
+    }
+
+    mEntries.push_front( Entry() );
+    Entry	&e = mEntries.front();
+
+    e.mPathFName	= pPathFName;
+    e.mFileSize		= fileSize;
+    e.mFileTime		= fileTime;
+    e.mMemSize		= memSize;
+    e.moBuff		= oBuff;
+
+    mEntriesMap[ e.mPathFName ] = mEntries.begin();
+
+    mMemSize += memSize;
+}
+
+//==================================================================
+void ArchiveCache::Clear()
+{
+    mEntries.clear();
+    mEntriesMap.clear();
+    mMemSize = 0;
+}
+
+//==================================================================
+void ArchiveCache::removeEntry( EntryList::iterator it )
+{
+    mMemSize -= it->mMemSize;
+
+    mEntriesMap.erase( it->mPathFName );
+    mEntries.erase( it );
+}
+
+//==================================================================
+}
@@ -0,0 +1,227 @@
+//==================================================================
+/// RRL_CmdBuffer.cpp
+///
+/// Created by Davide Pasca - 2026/10/19
+/// See the file "license.txt" that comes with this project for
+/// copyright info.
+//==================================================================
+
+#include "stdafx.h"
+#include "RRL_CmdBuffer.h"
+
+//==================================================================
+namespace RRL
+{
+
+//==================================================================
+/// ArchiveParser
+//==================================================================
+ArchiveParser::ArchiveParser( DIO::FileManagerBase &fileManager, const char *pFileName ) :
+    mpStream(NULL),
+    mpParser(NULL)
+{
+    fileManager.GrabFile( pFileName, mFile );
+
+    // compressed files are inflated in the background, as they are parsed
+    if ( DIO::InflateStream::IsGZip( mFile.GetData(), mFile.GetDataSize() ) )
+    {
+        mpStream = DNEW DIO::InflateStream( mFile.GetData(), mFile.GetDataSize() );
+        mpParser = DNEW RI::Parser( *mpStream );
+    }
+    else
+    {
+        mpParser = DNEW RI::Parser( (const char *)mFile.GetData(), mFile.GetDataSize() );
+    }
+}
+
+//==================================================================
+ArchiveParser::~ArchiveParser()
+{
+    // the parser first, it reads from the stream
+    DDELETE( mpParser );
+    DDELETE( mpStream );
+}
+
+//==================================================================
+/// CmdBuffer
+//==================================================================
+bool CmdBuffer::Parse( RI::Parser &parser, size_t maxCmdsN )
+{
+    for (size_t i=0; i < maxCmdsN; ++i)
+    {
+        Cmd	&cmd = Dgrow( mCmds );
+
+        try {
+            if NOT( parser.NextCommand( cmd.mCmdID, cmd.mParams, cmd.mLine ) )
+            {
+                mCmds.pop_back();
+                return false;
+            }
+        }
+        catch ( ... )
+        {
+            // the commands so far are good, the error comes after them
+            mCmds.pop_back();
+            mpError = std::current_exception();
+            return false;
+        }
+
+        cmd.mUnknownNameIdx = -1;
+
+        if ( cmd.mCmdID == RI::CMDID_UNKNOWN )
+        {
+            cmd.mUnknownNameIdx = (int)mUnknownNames.size();
+            mUnknownNames.push_back( parser.GetCommandName() );
+        }
+    }
+
+    return true;
+}
+
+//==================================================================
+/// Nothing but primitives, moved by relative transformations inside
+/// balanced blocks. Reading it leaves the state as it was, and what it
+/// makes only depends on the attributes and transformation at the
+/// ReadArchive
+static bool isOnlyGeometry( const DVec<CmdBuffer::Cmd> &cmds )
+{
+    DVec<RI::CmdID>	blocks;
+
+    for (size_t i=0; i < cmds.size(); ++i)
+    {
+        switch ( cmds[i].mCmdID )
+        {
+        case RI::CMDID_version:
+        case RI::CMDID_Cone:
+        case RI::CMDID_Cylinder:
+        case RI::CMDID_Sphere:
+        case RI::CMDID_Hyperboloid:
+        case RI::CMDID_Paraboloid:
+        case RI::CMDID_Torus:
+        case RI::CMDID_Patch:
+        case RI::CMDID_PatchMesh:
+        case RI::CMDID_NuPatch:
+        case RI::CMDID_Polygon:
+        case RI::CMDID_PointsPolygons:
+        case RI::CMDID_PointsGeneralPolygons:
+            break;
+
+        case RI::CMDID_AttributeBegin:
+        case RI::CMDID_TransformBegin:
+            blocks.push_back( cmds[i].mCmdID );
+            break;
+
+        case RI::CMDID_AttributeEnd:
+            if ( blocks.empty() || blocks.back() != RI::CMDID_AttributeBegin )
+                return false;
+            blocks.pop_back();
+            break;
+
+        case RI::CMDID_TransformEnd:
+            if ( blocks.empty() || blocks.back() != RI::CMDID_TransformBegin )
+                return false;
+            blocks.pop_back();
+            break;
+
+        // outside of a block, it would carry on after the archive
+        case RI::CMDID_ConcatTransform:
+        case RI::CMDID_Scale:
+        case RI::CMDID_Rotate:
+        case RI::CMDID_Translate:
+            if ( blocks.empty() )
+                return false;
+            break;
+
+        default:
+            return false;
+        }
+    }
+
+    return blocks.empty();
+}
+
+//==================================================================
+void CmdBuffer::ParseFile( DIO::FileManagerBase &fileManager, const char *pFileName )
+{
+    try {
+        ArchiveParser	archParser( fileManager, pFileName );
+
+        Parse( archParser.GetParser() );
+    }
+    catch ( ... )
+    {
+        mpError = std::current_exception();
+    }
+
+    mIsOnlyGeometry = NOT( mpError ) && isOnlyGeometry( mCmds );
+}
+
+//==================================================================
+const char *CmdBuffer::GetCommandName( const Cmd &cmd ) const
+{
+    if ( cmd.mUnknownNameIdx >= 0 )
+        return mUnknownNames[ cmd.mUnknownNameIdx ].c_str();
+
+    return RI::GetCommandName( cmd.mCmdID );
+}
+
+//==================================================================
+const CmdBuffer::Cmd *CmdBuffer::FindGlobalChange() const
+{
+    for (size_t i=0; i < mCmds.size(); ++i)
+    {
+        switch ( mCmds[i].mCmdID )
+        {
+        case RI::CMDID_FrameBegin:
+        case RI::CMDID_FrameEnd:
+        case RI::CMDID_WorldBegin:
+        case RI::CMDID_WorldEnd:
+        case RI::CMDID_Declare:
+        case RI::CMDID_Option:
+        case RI::CMDID_LightSource:
+        case RI::CMDID_AreaLightSource:
+        case RI::CMDID_Format:
+        case RI::CMDID_FrameAspectRatio:
+        case RI::CMDID_ScreenWindow:
+        case RI::CMDID_CropWindow:
+        case RI::CMDID_Projection:
+        case RI::CMDID_Clipping:
+        case RI::CMDID_DepthOfField:
+        case RI::CMDID_Shutter:
+        case RI::CMDID_Display:
+        case RI::CMDID_PixelSamples:
+            return &mCmds[i];
+
+        default:
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+//==================================================================
+size_t CmdBuffer::GetMemSize() const
+{
+    size_t	sz = sizeof(*this) + mCmds.capacity() * sizeof(Cmd);
+
+    for (size_t i=0; i < mCmds.size(); ++i)
+    {
+        const RI::ParamList	&params = mCmds[i].mParams;
+
+        sz += params.capacity() * sizeof(RI::Param) + params.GetValuesMemSize();
+
+        for (size_t j=0; j < params.size(); ++j)
+            sz += params[j].GetHeapMemSize();
+    }
+
+    sz += mUnknownNames.capacity() * sizeof(DStr);
+
+    for (size_t i=0; i < mUnknownNames.size(); ++i)
+        sz += mUnknownNames[i].capacity();
+
+    return sz;
+}
+
+//==================================================================
+}
@@ -23,7 +23,7 @@ Translator::Translator( const Params &params ) :
 }
 
 //==================================================================
-void Translator::unknownCommand( const char *pCmdName )
+void Translator::UnknownCommand( const char *pCmdName )
 {
     //printf( "Unknown command %s !\n", pCmdName );
     throw std::runtime_error(
@@ -57,27 +57,34 @@ void Translator::geN( size_t n, const RI::ParamList &cmdParams )
     }
 }
 
+//==================================================================
+/// NOTE: RIB bounds are in the order xmin xmax ymin ymax zmin zmax
+static void mkBound( RI::Bound &out_Bound, const RI::Param &param )
+{
+    const float *pSrc = param.PFlt(6);
+
+    out_Bound.SetMin( pSrc[0], pSrc[2], pSrc[4] );
+    out_Bound.SetMax( pSrc[1], pSrc[3], pSrc[5] );
+}
+
 //==================================================================
 static void mkBound( RI::Bound &out_Bound, RI::ParamList &cmdParams )
 {
     if ( cmdParams.size() == 1 )
     {
-        const float *pSrc = cmdParams[0].PFlt(6);
-
-        out_Bound.SetMin( pSrc + 0 );
-        out_Bound.SetMax( pSrc + 3 );
+        mkBound( out_Bound, cmdParams[0] );
     }
     else
     if ( cmdParams.size() == 6 )
     {
         out_Bound.SetMin(
-                    cmdParams[0].u.floatVal,
-                    cmdParams[1].u.floatVal,
-                    cmdParams[2].u.floatVal );
+                    cmdParams[0].Flt(),
+                    cmdParams[2].Flt(),
+                    cmdParams[4].Flt() );
         out_Bound.SetMax(
-                    cmdParams[3].u.floatVal,
-                    cmdParams[4].u.floatVal,
-                    cmdParams[5].u.floatVal );
+                    cmdParams[1].Flt(),
+                    cmdParams[3].Flt(),
+                    cmdParams[5].Flt() );
     }
     else
         DASSTHROW( false, ("Wrong param count") );
@@ -136,15 +143,66 @@ void Translator::addFormatCmd( RI::ParamList &p )
         mState.Format( p[0], p[1], p[2] );
 }
 
+//==================================================================
+/// objects are identified by a number or, more recently, a string
+DStr Translator::objectName( const RI::Param &param )
+{
+    if ( param.IsString() )
+        return param.PChar();
+    else
+        return DUT::SSPrintFS( "%i", (int)param );
+}
+
+//==================================================================
+void Translator::addObjectInstanceCmd( const RI::Param &param )
+{
+    DStr	name = objectName( param );
+
+    auto it = mObjectHandles.find( name );
+
+    if ( it == mObjectHandles.end() )
+    {
+        mState.ErrHandler( RI::E_BADHANDLE, "Undefined object '%s'", name.c_str() );
+        return;
+    }
+
+    mState.ObjectInstance( it->second );
+}
+
+//==================================================================
+/// Procedural "DelayedReadArchive" [ "file" ] [ xmin xmax ymin ymax zmin zmax ]
+void Translator::addProceduralCmd( RI::ParamList &p )
+{
+    const char	*pName = p[0];
+
+    if ( strcmp( pName, "DelayedReadArchive" ) )
+    {
+        mState.ErrHandler( RI::E_BADARGUMENT, "Unsupported procedural '%s'", pName );
+        return;
+    }
+
+    RI::Bound	bound;
+    mkBound( bound, p[2] );
+
+    DStr	pathFName = mState.FindResFile( p[1], RI::Options::SEARCHPATH_ARCHIVE );
+
+    if NOT( pathFName.length() )
+    {
+        mState.ErrHandler( RI::E_BADARGUMENT, "Could not find the archive '%s'", p[1].PChar() );
+        return;
+    }
+
+    mState.DelayedReadArchive( pathFName.c_str(), bound );
+}
+
 //==================================================================
 Translator::RetCmd
     Translator::AddCommand(
-                const DStr		&cmdName,
+                RI::CmdID		cmdID,
                 RI::ParamList	&cmdParams,
                 const char		*pFileName,
                 int				cmdLine )
 {
-    const DStr	&nm = cmdName;
     RI::ParamList	&p = cmdParams;
 
     static RtToken tlSolidBegin[]		= { RI_PRIMITIVE, RI_INTERSECTION, RI_UNION, RI_DIFFERENCE, 0 };
@@ -152,37 +210,41 @@ Translator::RetCmd
     static RtToken tlOrientation[]		= { RI_OUTSIDE, RI_INSIDE, RI_LH, RI_RH, 0 };
     static RtToken tlBasis[]			= { RI_BEZIERBASIS, RI_BSPLINEBASIS, RI_POWERBASIS, RI_CATMULLROMBASIS, RI_HERMITEBASIS, 0 };
 
-    if ( nm == "Begin" )			{ exN( 1, p ); mState.Begin( p[0] );		}	else
-    if ( nm == "End" )				{ exN( 0, p ); mState.End();				}	else
-    if ( nm == "FrameBegin" )		{ exN( 1, p ); mState.FrameBegin( p[0] );	}	else
-    if ( nm == "FrameEnd" )			{ exN( 0, p ); mState.FrameEnd();			}	else
-    if ( nm == "WorldBegin" )		{ exN( 0, p ); mState.WorldBegin();			}	else
-    if ( nm == "WorldEnd" )			{ exN( 0, p ); mState.WorldEnd();	return CMD_WORLDEND; }	else
-    if ( nm == "AttributeBegin" )	{ exN( 0, p ); mState.AttributeBegin();		}	else
-    if ( nm == "AttributeEnd" )		{ exN( 0, p ); mState.AttributeEnd();		}	else
-    if ( nm == "Attribute" )		{ geN( 1, p );								}	else	// simply ignore custom attributes for now
-    if ( nm == "TransformBegin" )	{ exN( 0, p ); mState.TransformBegin();		}	else
-    if ( nm == "TransformEnd" )		{ exN( 0, p ); mState.TransformEnd();		}	else
-    if ( nm == "SolidBegin" )		{ exN( 1, p ); mState.SolidBegin( matchToken( p[0], tlSolidBegin ) );	}	else
-    if ( nm == "SolidEnd" )			{ exN( 0, p ); mState.SolidEnd();			}	else
-    if ( nm == "ObjectBegin" )		{ exN( 0, p ); mState.ObjectBegin();		}	else
-    if ( nm == "ObjectEnd" )		{ exN( 0, p ); mState.ObjectEnd();			}	else
-    if ( nm == "MotionBegin" )		{ exN( 2, p ); mState.MotionBegin( p[0], p[0].PFlt() ); } else
-    if ( nm == "MotionEnd" )		{ exN( 0, p ); mState.MotionEnd();			}	else
+    switch ( cmdID )
+    {
+    case RI::CMDID_Begin:			{ exN( 1, p ); mState.Begin( p[0] );		}	break;
+    case RI::CMDID_End:				{ exN( 0, p ); mState.End();				}	break;
+    case RI::CMDID_FrameBegin:		{ exN( 1, p ); mState.FrameBegin( p[0] );	}	break;
+    case RI::CMDID_FrameEnd:		{ exN( 0, p ); mState.FrameEnd();			}	break;
+    case RI::CMDID_WorldBegin:		{ exN( 0, p ); mState.WorldBegin();			}	break;
+    case RI::CMDID_WorldEnd:		{ exN( 0, p ); mState.WorldEnd();	return CMD_WORLDEND; }
+    case RI::CMDID_AttributeBegin:	{ exN( 0, p ); mState.AttributeBegin();		}	break;
+    case RI::CMDID_AttributeEnd:	{ exN( 0, p ); mState.AttributeEnd();		}	break;
+    case RI::CMDID_Attribute:		{ geN( 1, p );								}	break;	// simply ignore custom attributes for now
+    case RI::CMDID_TransformBegin:	{ exN( 0, p ); mState.TransformBegin();		}	break;
+    case RI::CMDID_TransformEnd:	{ exN( 0, p ); mState.TransformEnd();		}	break;
+    case RI::CMDID_SolidBegin:		{ exN( 1, p ); mState.SolidBegin( matchToken( p[0], tlSolidBegin ) );	}	break;
+    case RI::CMDID_SolidEnd:		{ exN( 0, p ); mState.SolidEnd();			}	break;
+    case RI::CMDID_ObjectBegin:		{ exN( 1, p ); mObjectHandles[ objectName( p[0] ) ] = mState.ObjectBegin();	}	break;
+    case RI::CMDID_ObjectEnd:		{ exN( 0, p ); mState.ObjectEnd();			}	break;
+    case RI::CMDID_ObjectInstance:	{ exN( 1, p ); addObjectInstanceCmd( p[0] );	}	break;
+    case RI::CMDID_MotionBegin:		{ exN( 1, p ); mState.MotionBegin( (int)p[0].FltArrSize(), p[0].PFlt() ); }	break;
+    case RI::CMDID_MotionEnd:		{ exN( 0, p ); mState.MotionEnd();			}	break;
     // attributes
-    if ( nm == "Bound" )			{ RI::Bound b; mkBound( b, p ); mState.DoBound( b );	}	else
-    if ( nm == "Detail" )			{ RI::Bound b; mkBound( b, p ); mState.Detail( b ); }	else
-    if ( nm == "DetailRange" )		{ exN( 4, p ); mState.DetailRange(p[0],p[1],p[2],p[3]);	}	else
-    if ( nm == "GeometricApproximation" )
+    case RI::CMDID_Bound:			{ RI::Bound b; mkBound( b, p ); mState.DoBound( b );	}	break;
+    case RI::CMDID_Detail:			{ RI::Bound b; mkBound( b, p ); mState.Detail( b ); }	break;
+    case RI::CMDID_DetailRange:		{ exN( 4, p ); mState.DetailRange(p[0],p[1],p[2],p[3]);	}	break;
+    case RI::CMDID_GeometricApproximation:
                                     {
                                         //exN( 2, p ); 
                                         ////mState.GeometricApproximation( matchToken( p[0], tlGeometricApproximation ), p[1] );
                                         //mState.GeometricApproximation( p[0], p[1] );
                                     
-                                    }	else
-    if ( nm == "Orientation" )		{ exN( 1, p ); mState.Orientation( matchToken( p[0], tlOrientation ) );	}	else
-    if ( nm == "Sides" )			{ exN( 1, p ); mState.Sides( p[0] );		}	else
-    if ( nm == "Basis" )			{
+                                    }	break;
+    case RI::CMDID_Orientation:		{ exN( 1, p ); mState.Orientation( matchToken( p[0], tlOrientation ) );	}	break;
+    case RI::CMDID_Sides:			{ exN( 1, p ); mState.Sides( p[0] );		}	break;
+    case RI::CMDID_ShadingRate:		{ exN( 1, p ); mState.ShadingRate( p[0] );	}	break;
+    case RI::CMDID_Basis:			{
         exN( 4, p );
 
         RtToken		pUName = NULL;
@@ -206,66 +268,82 @@ Translator::RetCmd
             );
 
     }
-    else
-    if ( nm == "AreaLightSource" )
+    break;
+
+    case RI::CMDID_AreaLightSource:
     {
         geN( 1, p );	// at least one param (the shader name)
         mState.AreaLightSource( p );
     }
-    else
-    if ( nm == "LightSource" )
+    break;
+
+    case RI::CMDID_LightSource:
     {
         geN( 1, p );	// at least one param (the shader name)
         mState.LightSource( p );
     }
-    else
-    if ( nm == "Declare" )
+    break;
+
+    case RI::CMDID_Declare:
     {
         exN( 2, p );
         mState.Declare( p );
     }
-    else
-    if ( nm == "Surface" )
+    break;
+
+    case RI::CMDID_Surface:
     {
         geN( 1, p );
         mState.Surface( p );
     }
-    else
-    if ( nm == "Displacement" )
+    break;
+
+    case RI::CMDID_Displacement:
     {
         geN( 1, p );
         mState.Displacement( p );
     }
-    else
-    if ( nm == "ReadArchive" )
+    break;
+
+    case RI::CMDID_ReadArchive:
     {
         exN( 1, p );
         mReadArchivePathFName = mState.FindResFile( p[0], RI::Options::SEARCHPATH_ARCHIVE );
         return CMD_READARCHIVE;
     }
-    else
-    if ( nm == "version" )
+
+    case RI::CMDID_Procedural:
+    {
+        exN( 3, p );
+        addProceduralCmd( p );
+    }
+    break;
+
+    case RI::CMDID_version:
     {
         // ignore this for now, really
         exN( 1, p );
         return CMD_GENERIC;
     }
-    else
+
+    default:
     {
         // primitives
-        if ( addCommand_prims( nm, p, pFileName, cmdLine ) )
+        if ( addCommand_prims( cmdID, p, pFileName, cmdLine ) )
             return CMD_GENERIC;
 
         // transformations
-        if ( addCommand_transforms( nm, p ) )
+        if ( addCommand_transforms( cmdID, p ) )
             return CMD_GENERIC;
 
         // options
-        if ( addCommand_options( nm, p ) )
+        if ( addCommand_options( cmdID, p ) )
             return CMD_GENERIC;
 
         // unknown
-        unknownCommand( nm.c_str() );
+        UnknownCommand( RI::GetCommandName( cmdID ) );
+    }
+    break;
     }
 
     return CMD_GENERIC;
@@ -104,13 +104,18 @@ static RI::Options::SearchPathh findSearchPathType( const char *pPathType )
 
 //==================================================================
 bool Translator::addCommand_options(
-                            const DStr		&nm,
+                            RI::CmdID		cmdID,
                             RI::ParamList	&p )
 {
-    if ( nm == "Option" )
+    switch ( cmdID )
+    {
+    case RI::CMDID_Option:
     {
         geN( 2, p );
 
+        if NOT( mState.VerifyOutsideProcedural( "Option" ) )
+            return true;
+
         const char *pOpionName = p[0].PChar();
 
         if ( 0 == strcmp( pOpionName, "searchpath" ) )
@@ -135,20 +140,17 @@ bool Translator::addCommand_options(
             processSearchPath( spathList, strings );
         }
     }
-    else
-    if ( nm == "Format" )
-    {
-        addFormatCmd( p );
-    }
-    else
-    if ( nm == "FrameAspectRatio" )	{ exN( 1, p ); mState.FrameAspectRatio( p[0] );	}	else
-    if ( nm == "ScreenWindow" )		{ exN( 4, p ); mState.ScreenWindow(		p[0], p[1], p[2], p[3] );	}	else
-    if ( nm == "CropWindow" )		{ exN( 4, p ); mState.CropWindow(		p[0], p[1], p[2], p[3] );	}	else
-    if ( nm == "Projection" )		{ geN( 1, p ); mState.Projection(	p );	}	else
-    if ( nm == "Clipping" )			{ exN( 2, p ); mState.Clipping(		p[0], p[1] );	}	else
-    if ( nm == "DepthOfField" )		{ exN( 3, p ); mState.DepthOfField(	p[0], p[1], p[2] );	}	else
-    if ( nm == "Shutter" )			{ exN( 2, p ); mState.Shutter(		p[0], p[1] );	}	else
-    if ( nm == "Color"	)			
+    break;
+
+    case RI::CMDID_Format:			{ addFormatCmd( p );	}	break;
+    case RI::CMDID_FrameAspectRatio:{ exN( 1, p ); mState.FrameAspectRatio( p[0] );	}	break;
+    case RI::CMDID_ScreenWindow:	{ exN( 4, p ); mState.ScreenWindow(		p[0], p[1], p[2], p[3] );	}	break;
+    case RI::CMDID_CropWindow:		{ exN( 4, p ); mState.CropWindow(		p[0], p[1], p[2], p[3] );	}	break;
+    case RI::CMDID_Projection:		{ geN( 1, p ); mState.Projection(	p );	}	break;
+    case RI::CMDID_Clipping:		{ exN( 2, p ); mState.Clipping(		p[0], p[1] );	}	break;
+    case RI::CMDID_DepthOfField:	{ exN( 3, p ); mState.DepthOfField(	p[0], p[1], p[2] );	}	break;
+    case RI::CMDID_Shutter:			{ exN( 2, p ); mState.Shutter(		p[0], p[1] );	}	break;
+    case RI::CMDID_Color:
     {
         geN( 1, p );
         if ( p.size() == 1 )
@@ -161,12 +163,15 @@ bool Translator::addCommand_options(
             DASSTHROW( false, ("Wrong param count") );
         }
     }
-    else
-    if ( nm == "Opacity" )			{ exN( 1, p ); mState.Opacity(		p[0].PFlt(3) );	}	else
-    if ( nm == "Display" )			{ geN( 3, p ); mState.Display(		p[0], p[1], p[2], p );	} else
-    if ( nm == "PixelSamples" )		{ exN( 2, p ); mState.PixelSamples( p[0], p[1] );	}
-    else
+    break;
+
+    case RI::CMDID_Opacity:			{ exN( 1, p ); mState.Opacity(		p[0].PFlt(3) );	}	break;
+    case RI::CMDID_Display:			{ geN( 3, p ); mState.Display(		p[0], p[1], p[2], p );	}	break;
+    case RI::CMDID_PixelSamples:	{ exN( 2, p ); mState.PixelSamples( p[0], p[1] );	}	break;
+
+    default:
         return false;
+    }
 
     return true;
 }
@@ -15,25 +15,27 @@ namespace RRL
 
 //==================================================================
 bool Translator::addCommand_prims(
-        const DStr		&nm,
+        RI::CmdID		cmdID,
         RI::ParamList	&p,
         const char		*pFileName,
         int				cmdLine )
 {
     static RtToken tlPatch0[]			= { RI_BILINEAR, RI_BICUBIC, 0 };
 
-    if ( nm == "Cone" )				{ exN( 3, p ); mState.Cone(			p[0], p[1], p[2] ); }	else
-    if ( nm == "Cylinder" )			{ exN( 4, p ); mState.Cylinder(		p[0], p[1], p[2], p[3] ); }	else
-    if ( nm == "Sphere" )			{ exN( 4, p ); mState.Sphere(		p[0], p[1], p[2], p[3] ); }	else
-    if ( nm == "Hyperboloid" )		{ exN( 7, p ); mState.Hyperboloid(	Float3( p[0], p[1], p[2] ),
+    switch ( cmdID )
+    {
+    case RI::CMDID_Cone:			{ exN( 3, p ); mState.Cone(			p[0], p[1], p[2] ); }	break;
+    case RI::CMDID_Cylinder:		{ exN( 4, p ); mState.Cylinder(		p[0], p[1], p[2], p[3] ); }	break;
+    case RI::CMDID_Sphere:			{ exN( 4, p ); mState.Sphere(		p[0], p[1], p[2], p[3] ); }	break;
+    case RI::CMDID_Hyperboloid:		{ exN( 7, p ); mState.Hyperboloid(	Float3( p[0], p[1], p[2] ),
                                                                         Float3( p[3], p[4], p[5] ),
-                                                                        p[6] ); }	else
-    if ( nm == "Paraboloid" )		{ exN( 4, p ); mState.Paraboloid(	p[0], p[1], p[2], p[3] ); }	else
-    if ( nm == "Torus" )			{ exN( 5, p ); mState.Torus(		p[0], p[1], p[2], p[3], p[4] ); }	else
-    if ( nm == "Patch" )			{ geN( 3, p ); mState.Patch(		matchToken( p[0], tlPatch0 ), p ); }	else
-    if ( nm == "PatchMesh" )		{ geN( 5, p ); mState.PatchMesh(	matchToken( p[0], tlPatch0 ), p ); }	else
+                                                                        p[6] ); }	break;
+    case RI::CMDID_Paraboloid:		{ exN( 4, p ); mState.Paraboloid(	p[0], p[1], p[2], p[3] ); }	break;
+    case RI::CMDID_Torus:			{ exN( 5, p ); mState.Torus(		p[0], p[1], p[2], p[3], p[4] ); }	break;
+    case RI::CMDID_Patch:			{ geN( 3, p ); mState.Patch(		matchToken( p[0], tlPatch0 ), p ); }	break;
+    case RI::CMDID_PatchMesh:		{ geN( 5, p ); mState.PatchMesh(	matchToken( p[0], tlPatch0 ), p ); }	break;
 
-    if ( nm == "NuPatch" )			{
+    case RI::CMDID_NuPatch:			{
                                         geN( 11, p );
                                         int		nu		= (int)p[0];
                                         int		uorder	= (int)p[1];
@@ -60,13 +62,15 @@ bool Translator::addCommand_prims(
                                                 p
                                             );
 
-                                    }	else
+                                    }	break;
 
-    if ( nm == "Polygon" )				{ geN( 2, p ); mState.Polygon( p ); }	else
-    if ( nm == "PointsPolygons" )		{ geN( 4, p ); mState.PointsPolygons( p ); } else
-    if ( nm == "PointsGeneralPolygons" ){ geN( 5, p ); mState.PointsGeneralPolygons( p ); }
-    else
+    case RI::CMDID_Polygon:					{ geN( 2, p ); mState.Polygon( p ); }	break;
+    case RI::CMDID_PointsPolygons:			{ geN( 4, p ); mState.PointsPolygons( p ); }	break;
+    case RI::CMDID_PointsGeneralPolygons:	{ geN( 5, p ); mState.PointsGeneralPolygons( p ); }	break;
+
+    default:
         return false;
+    }
 
 #if defined(DEBUG) || defined(_DEBUG)
     mState.mParams.mpFramework->Dbg_MarkLastPrim( pFileName, cmdLine );
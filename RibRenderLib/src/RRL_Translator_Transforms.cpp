@@ -15,17 +15,22 @@ namespace RRL
 
 //==================================================================
 bool Translator::addCommand_transforms(
-                            const DStr		&nm,
+                            RI::CmdID		cmdID,
                             RI::ParamList	&p )
 {
-    if ( 0==strcasecmp( nm.c_str(), "Identity" ))		{ exN( 0, p ); mState.Identity();							}	else
-    if ( 0==strcasecmp( nm.c_str(), "ConcatTransform" )){ exN( 1, p ); mState.ConcatTransform(	p[0].PFlt(16) );	}	else
-    if ( 0==strcasecmp( nm.c_str(), "Transform" ))		{ exN( 1, p ); mState.TransformCmd(	p[0].PFlt(16) );	}	else
-    if ( 0==strcasecmp( nm.c_str(), "Scale" ))			{ exN( 3, p ); mState.Scale(		p[0], p[1], p[2] );	}	else
-    if ( 0==strcasecmp( nm.c_str(), "Rotate" ))			{ exN( 4, p ); mState.Rotate(		p[0], p[1], p[2], p[3] ); }	else
-    if ( 0==strcasecmp( nm.c_str(), "Translate" ))		{ exN( 3, p ); mState.Translate(	p[0], p[1], p[2] );	}
-    else
+    // NOTE: the names of transformations are matched regardless of case (see RI::FindCommand)
+    switch ( cmdID )
+    {
+    case RI::CMDID_Identity:		{ exN( 0, p ); mState.Identity();							}	break;
+    case RI::CMDID_ConcatTransform:	{ exN( 1, p ); mState.ConcatTransform(	p[0].PFlt(16) );	}	break;
+    case RI::CMDID_Transform:		{ exN( 1, p ); mState.TransformCmd(	p[0].PFlt(16) );	}	break;
+    case RI::CMDID_Scale:			{ exN( 3, p ); mState.Scale(		p[0], p[1], p[2] );	}	break;
+    case RI::CMDID_Rotate:			{ exN( 4, p ); mState.Rotate(		p[0], p[1], p[2], p[3] ); }	break;
+    case RI::CMDID_Translate:		{ exN( 3, p ); mState.Translate(	p[0], p[1], p[2] );	}	break;
+
+    default:
         return false;
+    }
 
     return true;
 }
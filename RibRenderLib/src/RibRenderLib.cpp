@@ -10,23 +10,94 @@
 #include "RibRenderLib.h"
 #include "DSystem/include/DNetwork_Connecter.h"
 #include "RI_System/include/RI_Parser.h"
+#include "DImage/include/DImage_TIFF.h"
 
 //==================================================================
 namespace RRL
 {
 
+//==================================================================
+/// Commands parsed at a time from the file being read on the main
+/// thread, so that the ReadArchive in them can be parsed ahead
+static const size_t	STREAM_BATCH_CMDS_N = 1024;
+
 //==================================================================
 /// Render
 //==================================================================
-Render::Render( Params &params )
+Render::Render( Params &params ) :
+    mPrefetchMaxN( DMAX( (size_t)2, (size_t)std::thread::hardware_concurrency() * 2 ) ),
+    mpArchiveCache( params.mpArchiveCache ? params.mpArchiveCache : &mOwnArchiveCache ),
+    mpParams(&params),
+    mpTranslator(NULL),
+    mWorldIdx(0),
+    mRetainedHitsN(0)
 {
     Translator		translator( params.mTrans );
 
-    translator.GetState().Begin( "dummy" );
+    RI::Framework	&framework = *params.mTrans.mState.mpFramework;
+
+    mpTranslator = &translator;
+    framework.SetDelayedArchiveLoader( this );
+
+    try {
+        translator.GetState().Begin( "dummy" );
+
+        readArchive( params.mpFileName, params, translator );
 
-    readArchive( params.mpFileName, params, translator );
+        translator.GetState().End();
+    }
+    catch ( ... )
+    {
+        framework.SetDelayedArchiveLoader( NULL );
+        throw;
+    }
+
+    framework.SetDelayedArchiveLoader( NULL );
+}
+
+//==================================================================
+/// Called by the framework from a bucket being rendered, while the
+/// main thread waits at WorldEnd. Errors are reported, not thrown
+void Render::LoadDelayedArchive(
+                    const char				*pPathFName,
+                    const RI::Attributes	&attr,
+                    const RI::Transform		&xform )
+{
+    RI::State	&state = mpTranslator->GetState();
+
+    state.DelayedBegin( attr, xform );
+
+    try {
+        std::deque<Prefetch>	prefetches;
+
+        BuffPtr	oBuff = getArchive( pPathFName, prefetches, 0, *mpParams );
+
+        // other buckets are being rendered with the symbols and options
+        // as they are. Nothing of the archive is read, if it would change them
+        if ( const CmdBuffer::Cmd *pCmd = oBuff->FindGlobalChange() )
+        {
+            printf( "SCENE ERR> MSG: %s is not allowed in a delayed archive\n", oBuff->GetCommandName( *pCmd ) );
+            printf( "SCENE ERR> AT : %s : %i - (DelayedReadArchive)\n\n", pPathFName, pCmd->mLine );
+        }
+        else
+            replayCmds( *oBuff, pPathFName, *mpParams, *mpTranslator );
+    }
+    catch ( RI::Exception &e )
+    {
+        printf( "SCENE ERR> MSG: %s\n", e.GetMessage_().c_str() );
+        printf( "SCENE ERR> AT : %s - (DelayedReadArchive)\n\n", pPathFName );
+    }
+    catch ( std::exception &e )
+    {
+        printf( "SCENE ERR> MSG: %s\n", e.what() );
+        printf( "SCENE ERR> AT : %s - (DelayedReadArchive)\n\n", pPathFName );
+    }
 
-    translator.GetState().End();
+    if NOT( state.DelayedEnd() )
+    {
+        printf( "SCENE ERR> MSG: Unbalanced blocks in the delayed archive\n" );
+        printf( "SCENE ERR> AT : %s - (DelayedReadArchive)\n\n", pPathFName );
+    }
 }
 
 //==================================================================
@@ -35,92 +106,343 @@ void Render::readArchive(
                     const Params &params,
                     Translator &translator )
 {
-    RI::Parser		parser;
+    ArchiveParser	archParser( *params.mTrans.mState.mpFileManager, pFileName );
 
-    DUT::MemFile	file;
+    bool	hasMore = true;
+
+    while ( hasMore )
+    {
+        CmdBuffer	buff;
 
-    params.mTrans.mState.mpFileManager->GrabFile( pFileName, file );
+        hasMore = buff.Parse( archParser.GetParser(), STREAM_BATCH_CMDS_N );
 
-    for (size_t i=0; i <= file.GetDataSize(); ++i)
+        replayCmds( buff, pFileName, params, translator );
+    }
+}
+
+//==================================================================
+/// Starts the parsing of the archives coming up next in the buffer.
+/// The path is resolved with the state as it is now, which is checked
+/// again when the ReadArchive is actually reached
+void Render::prefetchArchives(
+                    const CmdBuffer &buff,
+                    size_t &io_scanIdx,
+                    std::deque<Prefetch> &io_prefetches,
+                    const Params &params,
+                    Translator &translator )
+{
+    for (; io_scanIdx < buff.mCmds.size(); ++io_scanIdx)
     {
-        if ( i == file.GetDataSize() )
-            parser.AddChar( 0 );
-        else
-            parser.AddChar( (char)file.GetData()[i] );
+        if ( io_prefetches.size() >= mPrefetchMaxN )
+            return;
+
+        const CmdBuffer::Cmd	&cmd = buff.mCmds[ io_scanIdx ];
 
-        while ( parser.HasNewCommand() )
+        if ( cmd.mCmdID != RI::CMDID_ReadArchive ||
+             cmd.mParams.size() != 1 ||
+             NOT( cmd.mParams[0].IsString() ) )
+            continue;
+
+        DStr	pathFName =
+                    translator.GetState().FindResFile(
+                                    cmd.mParams[0].PChar(),
+                                    RI::Options::SEARCHPATH_ARCHIVE );
+
+        if NOT( pathFName.length() )
+            continue;
+
+        io_prefetches.push_back( Prefetch() );
+        Prefetch	&pre = io_prefetches.back();
+
+        pre.mCmdIdx		= io_scanIdx;
+        pre.mPathFName	= pathFName;
+        pre.mIsCached	= false;
+
+        // already being parsed for an earlier reference ?
+        for (size_t i=0; i < io_prefetches.size()-1; ++i)
         {
-            DStr			cmdName;
-            RI::ParamList	cmdParams;
-            int				cmdLine;
+            if ( io_prefetches[i].mPathFName == pathFName && !io_prefetches[i].mIsCached )
+            {
+                pre.mFuture = io_prefetches[i].mFuture;
+                break;
+            }
+        }
 
-            parser.FlushNewCommand( &cmdName, &cmdParams, &cmdLine );
+        if ( pre.mFuture.valid() )
+            continue;
 
-            if ( params.mVerbose )
+        DIO::FileManagerBase	*pFileManager = params.mTrans.mState.mpFileManager;
+
+        if ( BuffPtr oBuff = mpArchiveCache->Find( *pFileManager, pathFName.c_str() ) )
+        {
+            std::promise<BuffPtr>	cached;
+            cached.set_value( oBuff );
+            pre.mFuture		= cached.get_future().share();
+            pre.mIsCached	= true;
+            continue;
+        }
+
+        pre.mFuture = mParseTasks.AddJob<BuffPtr>(
+            [=]()
             {
-                printf( "CMD %s ", cmdName.c_str() );
+                BuffPtr	oBuff( DNEW CmdBuffer() );
+                oBuff->ParseFile( *pFileManager, pathFName.c_str() );
+                return oBuff;
+            } ).share();
+    }
+}
 
-                if ( cmdParams.size() )
-                    printf( "(" SIZE_T_FMT " params)", cmdParams.size() );
+//==================================================================
+/// The archive prefetched for this command, if it's the same file,
+/// or from the cache, or parsed now
+Render::BuffPtr Render::getArchive(
+                    const char *pPathFName,
+                    std::deque<Prefetch> &io_prefetches,
+                    size_t cmdIdx,
+                    const Params &params )
+{
+    DIO::FileManagerBase	&fileManager = *params.mTrans.mState.mpFileManager;
 
-                puts( "" );
-            }
+    BuffPtr	oBuff;
+
+    if ( io_prefetches.size() &&
+         io_prefetches.front().mCmdIdx == cmdIdx &&
+         io_prefetches.front().mPathFName == pPathFName )
+    {
+        bool	isCached = io_prefetches.front().mIsCached;
 
-            try {
-                // add a command
-                Translator::RetCmd	retCmd =
-                                translator.AddCommand(
-                                                cmdName,
-                                                cmdParams,
-                                                pFileName,
-                                                cmdLine );
+        oBuff = io_prefetches.front().mFuture.get();
+        io_prefetches.pop_front();
+
+        // counted and moved up when it was found
+        if ( isCached )
+            return oBuff;
+    }
+    else
+    {
+        oBuff = mpArchiveCache->Find( fileManager, pPathFName );
+
+        if ( oBuff )
+            return oBuff;
+
+        oBuff = BuffPtr( DNEW CmdBuffer() );
+        oBuff->ParseFile( fileManager, pPathFName );
+    }
+
+    mpArchiveCache->Add( fileManager, pPathFName, oBuff );
+
+    return oBuff;
+}
+
+//==================================================================
+/// An archive of only geometry, read again by a later world block,
+/// goes in as an instance of an object made from it, once. The object
+/// keeps its primitives simplified and split, for the frames to come.
+/// False if the archive needs to be read as usual
+bool Render::instanceRetained(
+                    const char *pPathFName,
+                    const BuffPtr &oBuff,
+                    const Params &params,
+                    Translator &translator )
+{
+    RI::State	&state = translator.GetState();
+
+    if NOT( oBuff->mIsOnlyGeometry && state.CanInstanceArchive() )
+        return false;
+
+    RetainedArchive	&ret = mRetained[ pPathFName ];
+
+    // first seen, or changed since
+    if ( ret.moBuff != oBuff )
+    {
+        ret.moBuff			= oBuff;
+        ret.mFirstWorldIdx	= mWorldIdx;
+        ret.mObjectHandle	= NULL;
+    }
 
-                switch ( retCmd )
+    // read only by this world so far
+    if ( ret.mFirstWorldIdx == mWorldIdx )
+        return false;
+
+    if ( ret.mObjectHandle && NOT( state.IsObjectShapeCurrent( ret.mObjectHandle ) ) )
+        ret.mObjectHandle = NULL;
+
+    if ( ret.mObjectHandle )
+    {
+        mRetainedHitsN += 1;
+    }
+    else
+    {
+        ret.mObjectHandle = state.ObjectBegin();
+
+        replayCmds( *oBuff, pPathFName, params, translator );
+
+        state.ObjectEnd();
+    }
+
+    state.ObjectInstance( ret.mObjectHandle );
+
+    return true;
+}
+
+//==================================================================
+/// With the render stats, at the end of every frame. The counts
+/// start over at every frame
+void Render::printCacheStats()
+{
+    const ArchiveCache::Stats	&stats = mpArchiveCache->GetStats();
+
+    if ( stats.mHitsN || stats.mMissesN )
+    {
+        printf( "Archive cache: " SIZE_T_FMT " hits, " SIZE_T_FMT " misses, " SIZE_T_FMT " evicted, "
+                SIZE_T_FMT " archives in %.1f MB (max %.1f MB)\n",
+                    stats.mHitsN,
+                    stats.mMissesN,
+                    stats.mEvictedN,
+                    mpArchiveCache->GetEntriesN(),
+                    mpArchiveCache->GetMemSize() / (1024.0 * 1024.0),
+                    mpArchiveCache->GetMaxMemSize() / (1024.0 * 1024.0) );
+    }
+
+    mpArchiveCache->ResetStats();
+
+    if ( mRetained.size() )
+    {
+        printf( "Retained archives: " SIZE_T_FMT " reused, " SIZE_T_FMT " archives\n",
+                    mRetainedHitsN,
+                    mRetained.size() );
+    }
+
+    mRetainedHitsN = 0;
+}
+
+//==================================================================
+/// Depth maps may be read back as shadow maps by the next world
+/// blocks, so they are written here, whatever the front-end. The
+/// other displays are left to the frame end callback
+static void writeZFileDisplays( const DisplayList &dispList )
+{
+    for (size_t i=0; i < dispList.size(); ++i)
+    {
+        const RI::Options::Display	&disp = *dispList[i];
+
+        if NOT( disp.IsZFile() )
+            continue;
+
+        DIMG::TIFFDepthInfo	info;
+        memcpy( info.mMtxWorldCamera, &disp.mMtxWorldCamera.mij(0,0), sizeof(info.mMtxWorldCamera) );
+        memcpy( info.mMtxWorldScreen, &disp.mMtxWorldProj.mij(0,0), sizeof(info.mMtxWorldScreen) );
+
+        DIMG::SaveTIFFDepth( disp.mImage, info, disp.mName.c_str(), 32 );
+    }
+}
+
+//==================================================================
+void Render::replayCmds(
+                    CmdBuffer &buff,
+                    const char *pFileName,
+                    const Params &params,
+                    Translator &translator )
+{
+    std::deque<Prefetch>	prefetches;
+    size_t					scanIdx = 0;
+
+    for (size_t i=0; i < buff.mCmds.size(); ++i)
+    {
+        CmdBuffer::Cmd	&cmd = buff.mCmds[i];
+
+        const char	*pCmdName = buff.GetCommandName( cmd );
+
+        if ( params.mVerbose )
+        {
+            printf( "CMD %s ", pCmdName );
+
+            if ( cmd.mParams.size() )
+                printf( "(" SIZE_T_FMT " params)", cmd.mParams.size() );
+
+            puts( "" );
+        }
+
+        // ReadArchive that failed before being reached
+        while ( prefetches.size() && prefetches.front().mCmdIdx < i )
+            prefetches.pop_front();
+
+        prefetchArchives( buff, scanIdx, prefetches, params, translator );
+
+        try {
+            if ( cmd.mCmdID == RI::CMDID_UNKNOWN )
+                translator.UnknownCommand( pCmdName );
+
+            // add a command
+            Translator::RetCmd	retCmd =
+                            translator.AddCommand(
+                                            cmd.mCmdID,
+                                            cmd.mParams,
+                                            pFileName,
+                                            cmd.mLine );
+
+            switch ( retCmd )
+            {
+            case Translator::CMD_WORLDEND:
                 {
-                case Translator::CMD_WORLDEND:
-                    {
-                        RI::Options	&options = translator.GetState().GetCurOptions();
-
-                        // if the world definition has ended, then we should have some displays
-                        const DisplayList &dispList = options.GetDisplays();
-                        
-                        // see if we have a callback to process the displays
-                        if ( params.mpOnFrameEndCB )
-                            params.mpOnFrameEndCB( params.mpOnFrameEndCBData, dispList );
-
-                        // free the displays
-                        options.FreeDisplays();
-                    }
-                    break;
-
-                case Translator::CMD_READARCHIVE:
-                    {
-                    std::string tmpFName = translator.GetReadArchivePathFName();
-                    readArchive(
+                    RI::Options	&options = translator.GetState().GetCurOptions();
+
+                    // if the world definition has ended, then we should have some displays
+                    const DisplayList &dispList = options.GetDisplays();
+                    
+                    writeZFileDisplays( dispList );
+
+                    // see if we have a callback to process the displays
+                    if ( params.mpOnFrameEndCB )
+                        params.mpOnFrameEndCB( params.mpOnFrameEndCBData, dispList );
+
+                    // free the displays
+                    options.FreeDisplays();
+
+                    printCacheStats();
+
+                    mWorldIdx += 1;
+                }
+                break;
+
+            case Translator::CMD_READARCHIVE:
+                {
+                std::string tmpFName = translator.GetReadArchivePathFName();
+
+                BuffPtr	oSubBuff = getArchive( tmpFName.c_str(), prefetches, i, params );
+
+                if NOT( instanceRetained( tmpFName.c_str(), oSubBuff, params, translator ) )
+                {
+                    replayCmds(
+                            *oSubBuff,
                             tmpFName.c_str(),
                             params,
                             translator );
-                    }
-                    break;
-
-                default:
-                case Translator::CMD_GENERIC:
-                    break;
                 }
+                }
+                break;
 
+            default:
+            case Translator::CMD_GENERIC:
+                break;
             }
-            catch ( RI::Exception &e )
-            {
-                printf( "SCENE ERR> MSG: %s\n", e.GetMessage_().c_str() );
-                printf( "SCENE ERR> AT : %s : %i - (cmd: '%s')\n\n", pFileName, cmdLine, cmdName.c_str() );
-            }
-            catch ( std::runtime_error &e )
-            {
-                printf( "SCENE ERR> MSG: %s\n", e.what() );
-                printf( "SCENE ERR> AT : %s : %i - (cmd: '%s')\n\n", pFileName, cmdLine, cmdName.c_str() );
-            }
+
+        }
+        catch ( RI::Exception &e )
+        {
+            printf( "SCENE ERR> MSG: %s\n", e.GetMessage_().c_str() );
+            printf( "SCENE ERR> AT : %s : %i - (cmd: '%s')\n\n", pFileName, cmd.mLine, pCmdName );
+        }
+        catch ( std::runtime_error &e )
+        {
+            printf( "SCENE ERR> MSG: %s\n", e.what() );
+            printf( "SCENE ERR> AT : %s : %i - (cmd: '%s')\n\n", pFileName, cmd.mLine, pCmdName );
         }
     }
+
+    // a parsing error, after the last good command
+    if ( buff.mpError )
+        std::rethrow_exception( buff.mpError );
 }
 
 //==================================================================
@@ -9,7 +9,7 @@
 #include "RibRenderServer.h"
 
 //==================================================================
-static int serverTask( SOCKET clientSock )
+static int serverTask( SOCKET clientSock, const DStr &shaderCacheDir )
 {
     printf( "Rendering for %zi... yeah, right !!\n", clientSock );
 
@@ -58,6 +58,7 @@ static int serverTask( SOCKET clientSock )
     params.mTrans.mState.mpFileManager		= &fileManagerNet;
     params.mTrans.mState.mBaseDir			= netRendJob.BaseDir;
     params.mTrans.mState.mDefaultShadersDir	= netRendJob.DefaultResourcesDir;
+    params.mTrans.mState.mShaderCacheDir	= shaderCacheDir;
     params.mTrans.mForcedLongDim			= netRendJob.ForcedLongDim;
     params.mTrans.mForcedWd					= netRendJob.ForcedWd;
     params.mTrans.mForcedHe					= netRendJob.ForcedHe;
@@ -98,7 +99,8 @@ static int serverTask( SOCKET clientSock )
 //==================================================================
 static int serverMain( int argc, char **argv )
 {
-    int	port = 32323;
+    int		port = 32323;
+    DStr	shaderCacheDir;
 
     for (int i=1; i < argc; ++i)
     {
@@ -117,6 +119,19 @@ static int serverMain( int argc, char **argv )
                 return -1;
             }
 
+            i += 1;
+        }
+        else
+        if ( 0 == strcasecmp( "-shadercache", argv[i] ) )
+        {
+            if ( (i+1) >= argc )
+            {
+                printf( "Missing shader cache directory.\n" );
+                return -1;
+            }
+
+            shaderCacheDir = argv[i+1];
+
             i += 1;
         }
     }
@@ -141,7 +156,7 @@ static int serverMain( int argc, char **argv )
             listener.Stop();
 
             printf( "Accepted socket %zi\n", acceptedSock );
-            serverTask( acceptedSock );
+            serverTask( acceptedSock, shaderCacheDir );
 
             closesocket( acceptedSock );
 
@@ -172,6 +187,7 @@ static void printUsage( int argc, char **argv )
     printf( "\nOptions:\n" );
     printf( "    -help | --help | -h  -- Show this help\n" );
     printf( "    -port <port>         -- Wait for connection at port <port>\n" );
+    printf( "    -shadercache <dir>   -- Directory for the compiled shaders (can be shared)\n" );
 
     printf( "\nExamples:\n" );
     printf( "    %s\n", argv[0] );
@@ -246,6 +246,7 @@ bool RibRendToy::RenderFile( bool renderLastUsed, int forcedWd/*=-1*/, int force
 
     params.mpOnFrameEndCB		= renderFile_HandleDisplays_s;
     params.mpOnFrameEndCBData	= this;
+    params.mpArchiveCache		= &mArchiveCache;
 
     try
     {
@@ -35,6 +35,9 @@ public:
 
     DispDriverFBuffOGL	*mpDispDriverFBuff;
 
+    // parsed archives, kept from one render to the next
+    RRL::ArchiveCache	mArchiveCache;
+
     // used for tricky menu/invalidated zone problem
     int					mPostRedisplayCnt;
 